@@ -0,0 +1,159 @@
+#include "tetris/Grid.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Compares scanning a board stored the old way (a vector per row, walked
+// column by column) against the flat row-major Grid.
+//
+//   tetris_bench [iterations]
+namespace
+{
+Texture blockTexture;
+
+// The Grid layout before it was flattened, kept here as the baseline
+class NestedGrid
+{
+public:
+    NestedGrid(size_t rows, size_t cols)
+        : mRows { rows }
+        , mCols { cols }
+        , mGrid(rows, std::vector<Block>(cols))
+    {
+    }
+
+    template <typename Func>
+    void forEachBlock(Func&& func)
+    {
+        for (size_t xIndex = 0; xIndex < mCols; ++xIndex)
+        {
+            for (size_t yIndex = 0; yIndex < mRows; ++yIndex)
+            {
+                func(mGrid[yIndex][xIndex], xIndex, yIndex);
+            }
+        }
+    }
+
+    template <typename Func>
+    bool anyBlocks(Func&& func)
+    {
+        for (size_t xIndex = 0; xIndex < mCols; ++xIndex)
+        {
+            for (size_t yIndex = 0; yIndex < mRows; ++yIndex)
+            {
+                if (func(mGrid[yIndex][xIndex], xIndex, yIndex))
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void createBlock(int xIndex, int yIndex, Texture* texture)
+    {
+        mGrid[static_cast<size_t>(yIndex)][static_cast<size_t>(xIndex)] = Block { xIndex * BLOCK_SIZE, yIndex * BLOCK_SIZE, texture };
+    }
+
+private:
+    size_t mRows;
+    size_t mCols;
+    std::vector<std::vector<Block>> mGrid;
+};
+
+// Half full, in a pattern that defeats branch prediction a little
+template <typename Board>
+void fill(Board& board, size_t rows, size_t cols)
+{
+    for (size_t row = 0; row < rows; ++row)
+    {
+        for (size_t col = 0; col < cols; ++col)
+        {
+            if ((row * 7 + col * 3) % 5 < 2 || (row + col) % 3 == 0)
+            {
+                board.createBlock(static_cast<int>(col), static_cast<int>(row), &blockTexture);
+            }
+        }
+    }
+}
+
+// What Grid::render does, minus the SDL call: visit every Block and
+// collect the position of each one that exists
+template <typename Board>
+long long renderScan(Board& board)
+{
+    long long checksum = 0;
+    board.forEachBlock(
+        [&checksum](Block& block, size_t, size_t)
+        {
+            if (block.exists())
+            {
+                checksum += block.getPosX() + block.getPosY();
+            }
+        });
+    return checksum;
+}
+
+// A per-block collision test that never hits, so the whole board is scanned
+template <typename Board>
+long long collisionScan(Board& board)
+{
+    return board.anyBlocks(
+        [](Block& block, size_t, size_t)
+        {
+            return block.exists() && block.getPosY() < 0;
+        }) ? 1 : 0;
+}
+
+template <typename Func>
+double nanosecondsPerCall(int iterations, Func&& func, long long& sink)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        sink += func();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+template <typename Board>
+void run(const char* label, Board& board, NestedGrid& baseline, int iterations, long long& sink)
+{
+    double baselineRender = nanosecondsPerCall(iterations, [&baseline]() { return renderScan(baseline); }, sink);
+    double render = nanosecondsPerCall(iterations, [&board]() { return renderScan(board); }, sink);
+    double baselineCollision = nanosecondsPerCall(iterations, [&baseline]() { return collisionScan(baseline); }, sink);
+    double collision = nanosecondsPerCall(iterations, [&board]() { return collisionScan(board); }, sink);
+    printf("%-24s render %10.0f ns -> %10.0f ns (%5.2fx)   collision %10.0f ns -> %10.0f ns (%5.2fx)\n",
+        label,
+        baselineRender,
+        render,
+        baselineRender / render,
+        baselineCollision,
+        collision,
+        baselineCollision / collision);
+}
+}
+
+int main(int argc, char* args[])
+{
+    int iterations = (argc > 1) ? std::atoi(args[1]) : 2000;
+    long long sink = 0;
+
+    NestedGrid nestedStandard { N_ROWS, N_COLS };
+    Grid standard { 0, 0, N_ROWS, N_COLS };
+    fill(nestedStandard, N_ROWS, N_COLS);
+    fill(standard, N_ROWS, N_COLS);
+    run("Grid 22x10", standard, nestedStandard, iterations * 100, sink);
+
+    constexpr size_t HUGE_ROWS = 4000;
+    NestedGrid nestedHuge { HUGE_ROWS, MAX_BOARD_COLS };
+    Grid huge { 0, 0, HUGE_ROWS, MAX_BOARD_COLS };
+    fill(nestedHuge, HUGE_ROWS, MAX_BOARD_COLS);
+    fill(huge, HUGE_ROWS, MAX_BOARD_COLS);
+    run("Grid 4000x64", huge, nestedHuge, iterations / 10 + 1, sink);
+
+    // Keep the scans from being optimized away
+    return (sink == 42) ? 1 : 0;
+}
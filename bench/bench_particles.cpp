@@ -0,0 +1,103 @@
+#include "engine/ParticleSystem.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Times a frame's worth of particle work: the update kernel on its own,
+// then update plus building the vertices for the single draw call. The
+// particle per struct layout the pool replaced is timed as the baseline.
+//
+//   tetris_particle_bench [particles] [frames]
+namespace
+{
+constexpr float FRAME_SECONDS = 1.0f / 60.0f;
+constexpr double FRAME_BUDGET_MS = 1000.0 / 60.0;
+
+// One struct per particle, updated field by field
+struct Particle
+{
+    float posX;
+    float posY;
+    float velX;
+    float velY;
+    float life;
+    float fade;
+    SDL_Color colour;
+};
+
+void updateBaseline(std::vector<Particle>& particles, float gravity, float seconds)
+{
+    size_t index = 0;
+    while (index < particles.size())
+    {
+        Particle& particle = particles[index];
+        particle.velY += gravity * seconds;
+        particle.posX += particle.velX * seconds;
+        particle.posY += particle.velY * seconds;
+        particle.life -= seconds;
+        if (particle.life > 0)
+        {
+            ++index;
+            continue;
+        }
+        particle = particles.back();
+        particles.pop_back();
+    }
+}
+
+template <typename Func>
+double millisecondsPerFrame(int frames, Func&& func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        func();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / frames;
+}
+}
+
+int main(int argc, char* args[])
+{
+    size_t count = (argc > 1) ? std::strtoul(args[1], nullptr, 10) : 100000;
+    int frames = (argc > 2) ? std::atoi(args[2]) : 600;
+
+    // Long lives, so the pool stays full for the whole run
+    std::minstd_rand random {};
+    std::uniform_real_distribution<float> spread { -200.0f, 200.0f };
+    ParticleSystem particles { count };
+    particles.setGravity(900.0f);
+    std::vector<Particle> baseline;
+    baseline.reserve(count);
+    for (size_t index = 0; index < count; ++index)
+    {
+        float x = 400.0f + spread(random);
+        float y = 400.0f + spread(random);
+        float velX = spread(random);
+        float velY = spread(random);
+        SDL_Color colour { 0xFF, 0xFF, 0xFF, 0xFF };
+        particles.emit(x, y, velX, velY, 3600.0f, colour);
+        baseline.push_back(Particle { x, y, velX, velY, 3600.0f, 1.0f / 3600.0f, colour });
+    }
+
+    double baselineUpdate = millisecondsPerFrame(frames, [&baseline]() { updateBaseline(baseline, 900.0f, FRAME_SECONDS); });
+    double update = millisecondsPerFrame(frames, [&particles]() { particles.update(FRAME_SECONDS); });
+
+    // No renderer, so this is the vertex building without the GPU
+    double frame = millisecondsPerFrame(frames,
+        [&particles]()
+        {
+            particles.update(FRAME_SECONDS);
+            particles.render(nullptr, 4.0f);
+        });
+
+    printf("%zu particles, %d frames\n", particles.size(), frames);
+    printf("update          %8.3f ms -> %8.3f ms (%5.2fx)\n", baselineUpdate, update, baselineUpdate / update);
+    printf("update + render %8.3f ms, %5.1f%% of a 60 fps frame\n", frame, 100.0 * frame / FRAME_BUDGET_MS);
+
+    // Keep the updates from being optimized away
+    return (particles.getPosX(0) == 42.0f && baseline[0].posY == 42.0f) ? 1 : 0;
+}
@@ -0,0 +1,69 @@
+#include "tetris/Tetris.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Frames per second of the whole frame, update() and render(), drawn
+// headless with the software renderer. Runs on machines with no display or
+// GPU, so the numbers are for spotting regressions, not the frame rate a
+// player sees.
+//
+//   tetris_render_bench [frames]
+namespace
+{
+// The bottom rows filled in a mix of colours, with a few holes
+GameState withFilledRows(GameState state, size_t filledRows)
+{
+    size_t rows = state.board.rows;
+    for (size_t row = rows - filledRows; row < rows; ++row)
+    {
+        for (size_t col = 0; col < state.board.cols; ++col)
+        {
+            bool hole = (row * 7 + col * 3) % 11 == 0;
+            state.board.cells[row][col] = hole ? 0 : static_cast<uint8_t>(1 + (row + col) % 8);
+        }
+    }
+    return state;
+}
+}
+
+int main(int argc, char* args[])
+{
+    int frames = (argc > 1) ? std::atoi(args[1]) : 2000;
+
+    TetrisGameEngine tetris {};
+    if (!tetris.startHeadless())
+    {
+        return 1;
+    }
+
+    GameState initial = tetris.snapshot();
+    struct
+    {
+        const char* label;
+        GameState state;
+    } boards[] {
+        { "empty board", withFilledRows(initial, 0) },
+        { "half full board", withFilledRows(initial, N_ROWS / 2) },
+        { "full board", withFilledRows(initial, N_ROWS - 2) },
+    };
+
+    for (const auto& board : boards)
+    {
+        tetris.restore(board.state);
+        tetris.drawHeadlessFrame(); // the information bar text is rasterized once
+
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            tetris.drawHeadlessFrame();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%-16s %9.0f frames/s  %7.3f ms/frame  frame %016llx\n",
+            board.label,
+            frames / elapsed.count(),
+            1000.0 * elapsed.count() / frames,
+            static_cast<unsigned long long>(Framebuffer::hash(tetris.getFrame())));
+    }
+    return 0;
+}
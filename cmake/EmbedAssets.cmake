@@ -0,0 +1,52 @@
+# Packs asset files into one byte array in a generated C++ source, so the
+# game can load them from memory instead of from ASSETS_DIR.
+#
+# Run as a script at build time:
+#   cmake -DOUTPUT=<file.cpp> -DASSETS=<file|file|...> -P EmbedAssets.cmake
+
+string(REPLACE "|" ";" ASSETS "${ASSETS}")
+# CMake regexes have no {n}, so spell out one line of 16 bytes
+set(line "")
+foreach(index RANGE 15)
+  string(APPEND line "0x..,")
+endforeach()
+
+set(blob "")
+set(entries "")
+set(offset 0)
+foreach(asset ${ASSETS})
+  get_filename_component(name ${asset} NAME)
+  file(READ ${asset} hex HEX)
+  string(LENGTH "${hex}" hexLength)
+  math(EXPR size "${hexLength} / 2")
+
+  # 16 bytes per line
+  string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+  string(REGEX REPLACE "(${line})" "\\1\n    " bytes "${bytes}")
+  string(APPEND blob "    // ${name}\n    ${bytes}\n")
+  string(APPEND entries "    { \"${name}\", ${offset}, ${size} },\n")
+  math(EXPR offset "${offset} + ${size}")
+endforeach()
+
+file(WRITE ${OUTPUT}.tmp
+"// Generated by cmake/EmbedAssets.cmake, do not edit
+#include \"engine/AssetPack.h\"
+
+namespace
+{
+const unsigned char ASSET_BLOB[${offset} + 1] = {
+${blob}    0x00
+};
+}
+
+const unsigned char* const EMBEDDED_ASSET_BLOB = ASSET_BLOB;
+
+const EmbeddedAsset EMBEDDED_ASSETS[] = {
+${entries}};
+
+const size_t EMBEDDED_ASSET_COUNT = sizeof(EMBEDDED_ASSETS) / sizeof(EMBEDDED_ASSETS[0]);
+")
+
+# Only touch the output if it changed, to avoid needless rebuilds
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different ${OUTPUT}.tmp ${OUTPUT})
+file(REMOVE ${OUTPUT}.tmp)
@@ -0,0 +1,24 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+struct AllocationCounts
+{
+    uint64_t allocations { 0 };
+    uint64_t deallocations { 0 };
+    uint64_t bytes { 0 }; // requested, not including allocator overhead
+};
+
+// Counts calls to the global operator new and delete, per thread. Only
+// works in binaries that link src/engine/AllocationCounter.cpp, which
+// replaces the global operators: the game when built with
+// TETRIS_COUNT_ALLOCATIONS=ON, and the tests
+class AllocationCounter
+{
+public:
+    // Running totals for the calling thread
+    static AllocationCounts thisThread();
+};
+
+#endif
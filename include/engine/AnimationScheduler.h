@@ -0,0 +1,86 @@
+#ifndef ANIMATIONSCHEDULER_H
+#define ANIMATIONSCHEDULER_H
+
+#include <SDL.h>
+#include <array>
+#include <cstddef>
+#include <utility>
+
+// Runs presentational effects that span many frames, next to the game
+// rather than inside it. An Effect is a resumable task:
+//
+//   bool advance(Uint32 nowMs) - carry on from where the last call left
+//                                off, return false once finished
+//
+// Effects are kept by value in a fixed number of slots, so starting one
+// never allocates. Nothing here is game state: a headless run simply has
+// no scheduler, and a dropped or skipped effect changes nothing but pixels
+template <typename Effect, size_t Capacity>
+class AnimationScheduler
+{
+public:
+    AnimationScheduler()
+        : mEffects {}
+        , mCount { 0 }
+    {
+    }
+
+    // Returns false, and skips the effect, if every slot is busy
+    bool start(const Effect& effect)
+    {
+        if (mCount == Capacity)
+        {
+            return false;
+        }
+        mEffects[mCount++] = effect;
+        return true;
+    }
+
+    // Resume every running effect once, dropping the ones that finish
+    void advance(Uint32 nowMs)
+    {
+        size_t index = 0;
+        while (index < mCount)
+        {
+            if (mEffects[index].advance(nowMs))
+            {
+                ++index;
+            }
+            else
+            {
+                mEffects[index] = std::move(mEffects[--mCount]);
+            }
+        }
+    }
+
+    // Visit the running effects, e.g. to draw them
+    template <typename Func>
+    void forEach(Func&& func) const
+    {
+        for (size_t index = 0; index < mCount; ++index)
+        {
+            func(mEffects[index]);
+        }
+    }
+
+    void clear()
+    {
+        mCount = 0;
+    }
+
+    bool empty() const
+    {
+        return mCount == 0;
+    }
+
+    size_t size() const
+    {
+        return mCount;
+    }
+
+private:
+    std::array<Effect, Capacity> mEffects;
+    size_t mCount;
+};
+
+#endif
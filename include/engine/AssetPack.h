@@ -0,0 +1,28 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <cstddef>
+#include <string_view>
+
+// A file from assets/, compiled into the binary by cmake/EmbedAssets.cmake
+struct EmbeddedAsset
+{
+    const char* name;
+    size_t offset; // into EMBEDDED_ASSET_BLOB
+    size_t size;
+};
+
+// Defined in the generated AssetPack source
+extern const unsigned char* const EMBEDDED_ASSET_BLOB;
+extern const EmbeddedAsset EMBEDDED_ASSETS[];
+extern const size_t EMBEDDED_ASSET_COUNT;
+
+// Looks up embedded assets by file name
+class AssetPack
+{
+public:
+    // Returns false if the file was not embedded
+    static bool find(std::string_view name, const void*& data, size_t& size);
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef ASSETWATCHER_H
+#define ASSETWATCHER_H
+
+#include <string>
+#include <vector>
+
+// Reports files in a directory that have been written or replaced, using
+// inotify. Only implemented on Linux, open() fails everywhere else
+class AssetWatcher
+{
+public:
+    AssetWatcher();
+    ~AssetWatcher();
+
+    AssetWatcher(const AssetWatcher&) = delete;
+    AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+    bool open(const std::string& directory);
+
+    void close();
+
+    // Appends the names of files changed since the last call. Never blocks
+    void poll(std::vector<std::string>& changed);
+
+private:
+    int mFd;
+    int mWatch;
+};
+
+#endif
@@ -1,13 +1,30 @@
 #ifndef BASEENGINE_H
 #define BASEENGINE_H
 
+#include "engine/AssetWatcher.h"
+#include "engine/CpuMeter.h"
+#include "engine/FrameArena.h"
+#include "engine/FrameCapture.h"
+#include "engine/Framebuffer.h"
+#include "engine/LatencyTracker.h"
 #include "engine/Texture.h"
+#include "engine/ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <memory>
+#include <vector>
 
 inline constexpr SDL_Color BACKGROUND_COLOUR { 250, 250, 250, 255 };
 inline constexpr SDL_Color TEXT_COLOUR { 0, 0, 0, 255 };
 inline constexpr int BOTTOM_BAR_HEIGHT { 24 };
+inline constexpr size_t INFO_TEXT_SIZE = 128;
 inline constexpr int FONT_SIZE = 18;
+inline constexpr int LOADING_BAR_HEIGHT { 24 };
+inline constexpr int LOADING_FRAME_MS = 16; // longest the loading screen waits between redraws
+inline constexpr Uint32 ALLOCATION_WARMUP_FRAMES = 120; // frames before the heap should go quiet
+inline constexpr int IDLE_WAIT_MS = 100; // longest an idle frame sleeps waiting for events
+inline constexpr Uint32 DEFAULT_RECORD_SECONDS = 10; // --record without a length
 constexpr std::string_view FONT_ARIAL { "Arial.ttf" };
 
 // Custom deleters for SDL resources
@@ -51,42 +68,148 @@ public:
     // Entry point. Run the game
     int run(int argc, char* args[]);
 
+    // Instead of run(): no window, SDL's dummy video driver and a software
+    // renderer drawing into getFrame(). Loads media and creates the game,
+    // but starts no simulation thread and no loop, each drawHeadlessFrame()
+    // is one update() and render(). For framebuffer tests and benchmarks
+    // on machines without a display or GPU
+    bool startHeadless();
+
+    // Moves the headless clock on by the given milliseconds, then draws.
+    // Effects are timed by getTicks(), so headless frames are reproducible
+    bool drawHeadlessFrame(Uint32 = 0);
+
+    // The last frame drawn headless, see Framebuffer for comparing it
+    const SDL_Surface* getFrame() const;
+
 protected:
     const int mScreenHeight;
     const int mScreenWidth;
 
-    // Starts up SDL and creates window
+    // Starts up SDL and creates window, or the frame surface when headless
     bool init();
 
-    // Concrete class implement these
+    // Concrete class implement these. update() returns whether anything
+    // changed that needs drawing - when idle, frames are only drawn if so
     virtual bool loadMedia() = 0;
     virtual bool create() = 0;
     virtual bool update() = 0;
     virtual bool render() = 0;
 
-    // Loads the textures at the file path
+    // While idle the main loop sleeps until an event arrives (or for at
+    // most IDLE_WAIT_MS) instead of spinning. Defaults to !mPlaying
+    virtual bool isIdle();
+
+    // Called at a fixed rate on a separate simulation thread, if
+    // mSimulationTickMs is set. update() and render() stay on the main thread
+    virtual bool simulate();
+
+    // Loads the textures at the file path. Textures are decoded on a thread
+    // pool and only usable once finishLoading() has uploaded them
     bool loadTexture(const std::string_view);
     bool loadFont(const std::string_view);
 
+    // Uploads the decoded textures, drawing a progress bar until all are done
+    bool finishLoading();
+    void renderLoadingScreen(size_t, size_t);
+
+    long long millisecondsSinceStart();
+
+    // With --hot-reload, re-decode assets that changed on disk in the
+    // background and swap them in at the start of a frame. Textures are
+    // reloaded in place, so every Texture* handed out stays valid.
+    // Returns whether anything was swapped in
+    bool reloadChangedAssets();
+
+    // Called after a font reload, so text textures can switch to the new mFont
+    virtual void fontReloaded();
+
+
+    // SDL_GetTicks(), or the time drawHeadlessFrame() has been told about
+    Uint32 getTicks() const;
+
+    // Clears the screen and draws the information box and render() over it.
+    // Returns whether the frame was read back for a screenshot or recording
+    bool drawFrame();
+
+    // F12 takes a screenshot, F11 saves a clip when run with --record.
+    // Concrete classes pass every event they poll through here
+    void handleCaptureKeys(const SDL_Event&);
 
     // Frees media and shuts down SDL
     void close();
 
+    // Body of the simulation thread
+    void simulationLoop();
+
     // SDL resources
     std::unique_ptr<SDL_Window, SDLWindowDeleter> mWindow;
     std::unique_ptr<SDL_Renderer, SDLRendererDeleter> mRenderer;
+    bool mHeadless;
+    SurfacePtr mFrame; // what the renderer draws into when headless
+    Uint32 mHeadlessTicks;
 
     // textures and fonts
     std::unordered_map<std::string_view, std::unique_ptr<Texture>> mTextures;
     std::unique_ptr<TTF_Font, SDLFontDeleter> mFont;
 
+    // Textures still being decoded on the loader threads
+    struct PendingTexture
+    {
+        Texture* texture;
+        std::string name;
+        std::future<SDL_Surface*> surface;
+    };
+    std::unique_ptr<ThreadPool> mLoader;
+    std::vector<PendingTexture> mPendingTextures;
+
+    // Hot reload
+    bool mHotReload;
+    AssetWatcher mWatcher;
+    std::vector<std::string> mChangedAssets;
+    std::vector<PendingTexture> mPendingReloads;
+    std::string_view mFontName;
+    std::vector<char> mFontData; // what mFont was opened from, if it came from disk on a reload
+    std::future<std::vector<char>> mPendingFont;
+
+    // Startup timing
+    std::chrono::steady_clock::time_point mStartTime;
+    bool mFirstFrameShown; // loading screen
+    bool mGameFrameShown;
+
     // Event handling
     SDL_Event mEvent;
 
     // States
-    bool mQuit; // exit the actual game window altogether
+    std::atomic<bool> mQuit; // exit the actual game window altogether
     bool mPlaying; // the playable part of the game is running or not
 
+    // Milliseconds between simulate() calls. 0 runs everything on the main thread
+    Uint32 mSimulationTickMs;
+
+    // Input-to-photon latency, measured when run with --latency. Concrete
+    // classes add the SDL timestamps of the input events whose effect the
+    // current frame shows, and they are recorded once it is presented
+    bool mMeasureLatency;
+    LatencyTracker mLatency;
+    std::vector<Uint32> mInputsOnScreen;
+
+    // Scratch memory for the current frame. Reset before every update(),
+    // so nothing allocated from it may be kept past render()
+    FrameArena mFrameArena;
+
+    // With TETRIS_COUNT_ALLOCATIONS, every frame after the warm up must make
+    // no general heap allocations on the main thread
+    bool mCheckFrameAllocations;
+
+    // Screenshots, and with --record [seconds] the last few seconds of play
+    FrameCapture mCapture;
+    Uint32 mRecordSeconds;
+
+    // Logs process CPU usage once a second, with --cpu-usage
+    bool mMeasureCpu;
+    CpuMeter mCpuMeter;
+
     // Counters
     Uint32 mElapsedTime;
     Uint32 mFrameCount;
@@ -0,0 +1,32 @@
+#ifndef BYTEORDER_H
+#define BYTEORDER_H
+
+#include <cstdint>
+
+// Little endian reads and writes for network packets and file formats
+
+inline void writeU16(uint8_t* buffer, uint16_t value)
+{
+    buffer[0] = static_cast<uint8_t>(value);
+    buffer[1] = static_cast<uint8_t>(value >> 8);
+}
+
+inline uint16_t readU16(const uint8_t* buffer)
+{
+    return static_cast<uint16_t>(buffer[0] | (buffer[1] << 8));
+}
+
+inline void writeU32(uint8_t* buffer, uint32_t value)
+{
+    buffer[0] = static_cast<uint8_t>(value);
+    buffer[1] = static_cast<uint8_t>(value >> 8);
+    buffer[2] = static_cast<uint8_t>(value >> 16);
+    buffer[3] = static_cast<uint8_t>(value >> 24);
+}
+
+inline uint32_t readU32(const uint8_t* buffer)
+{
+    return uint32_t { buffer[0] } | (uint32_t { buffer[1] } << 8) | (uint32_t { buffer[2] } << 16) | (uint32_t { buffer[3] } << 24);
+}
+
+#endif
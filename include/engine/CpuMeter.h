@@ -0,0 +1,22 @@
+#ifndef CPUMETER_H
+#define CPUMETER_H
+
+#include <chrono>
+#include <ctime>
+
+// Measures how much CPU time the whole process (every thread) used
+// between two calls, as a percentage of one core
+class CpuMeter
+{
+public:
+    CpuMeter();
+
+    // CPU usage since the previous call, or since construction
+    double sample();
+
+private:
+    std::clock_t mCpuTime;
+    std::chrono::steady_clock::time_point mWallTime;
+};
+
+#endif
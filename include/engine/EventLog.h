@@ -0,0 +1,123 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include "engine/SpscQueue.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A binary log of small typed events, for post-mortems of a session. Each
+// producer thread pushes into its own lock-free queue and a background
+// thread drains them to the file, so logging never blocks or allocates on
+// the producers. When a queue is full the event is dropped and counted.
+//
+// The file is a header (uint32 EVENT_LOG_MAGIC, uint16 EVENT_LOG_VERSION,
+// uint16 reserved, little endian) followed by one record per event:
+//   uint8 type, then varints: time delta in microseconds (zigzag, producers
+//   interleave so it can go backwards), tick, arg 0 (zigzag), arg 1 (zigzag)
+// Dropped events are reported in EVENT_LOG_DROPPED records: arg 0 is the
+// producer and arg 1 how many of its events were lost since the last one
+inline constexpr uint32_t EVENT_LOG_MAGIC = 0x544C5645; // "EVLT"
+inline constexpr uint16_t EVENT_LOG_VERSION = 1;
+inline constexpr size_t EVENT_LOG_HEADER_SIZE = 8;
+inline constexpr size_t EVENT_LOG_PRODUCERS = 2; // threads that may log at once
+inline constexpr size_t EVENT_LOG_QUEUE_SIZE = 4096; // events per producer
+inline constexpr uint8_t EVENT_LOG_DROPPED = 0xFF; // reserved for the log itself
+inline constexpr size_t EVENT_LOG_WRITE_BYTES = 16 * 1024; // buffered before each fwrite
+inline constexpr int EVENT_LOG_IDLE_MS = 5; // writer sleep when the queues are empty
+inline constexpr int EVENT_LOG_FLUSH_MS = 1000; // longest an event sits in stdio buffers
+
+struct LogEvent
+{
+    uint64_t timeUs; // since the log was opened
+    uint32_t tick;
+    int32_t args[2];
+    uint8_t type;
+};
+
+class EventLog
+{
+public:
+    EventLog();
+    ~EventLog();
+
+    EventLog(const EventLog&) = delete;
+    EventLog& operator=(const EventLog&) = delete;
+
+    // Creates the file and starts the writer thread. Call before any
+    // producer starts logging
+    bool open(const std::string&);
+
+    // Writes out everything still queued, then stops the writer and closes
+    // the file. Call after the producers stopped logging
+    void close();
+
+    bool isOpen() const;
+
+    // Producer side. Each thread logs with its own producer index, below
+    // EVENT_LOG_PRODUCERS. Returns false if the event was dropped
+    bool log(size_t, uint8_t, uint32_t, int32_t = 0, int32_t = 0);
+
+    // Events dropped so far, over all producers
+    uint64_t getDropped() const;
+
+    // Microseconds since the log was opened
+    uint64_t nowUs() const;
+
+private:
+    void writerLoop();
+
+    // Moves everything queued into mBuffer. Returns whether there was anything
+    bool drain();
+
+    void encode(const LogEvent&);
+
+    // Writes mBuffer to the file
+    void write();
+
+    struct Producer
+    {
+        SpscQueue<LogEvent, EVENT_LOG_QUEUE_SIZE> queue;
+        std::atomic<uint64_t> dropped { 0 };
+        uint64_t droppedWritten { 0 }; // writer thread only
+    };
+
+    std::array<Producer, EVENT_LOG_PRODUCERS> mProducers;
+    std::FILE* mFile;
+    std::thread mWriter;
+    std::atomic<bool> mStopping;
+    std::chrono::steady_clock::time_point mStart;
+
+    // Writer thread only
+    std::vector<uint8_t> mBuffer;
+    uint64_t mLastTimeUs;
+    bool mWriteFailed;
+};
+
+// Reads back a file written by EventLog
+class EventLogReader
+{
+public:
+    EventLogReader();
+
+    // Loads the whole file. Returns false if it is missing or not an event log
+    bool open(const std::string&);
+
+    // The next event, with timeUs made absolute again. Returns false at the
+    // end of the file, or at a truncated last record
+    bool next(LogEvent&);
+
+private:
+    bool readVarint(uint64_t&);
+
+    std::vector<uint8_t> mData;
+    size_t mOffset;
+    uint64_t mTimeUs;
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+inline constexpr size_t FRAME_ARENA_SIZE = 64 * 1024;
+
+// Bump-pointer allocator for data that only lives until the end of the
+// frame. Allocating is a pointer increment and reset() frees everything
+// at once, so frame-local temporaries never touch the general heap.
+// Destructors are not run, only use it for trivially destructible types
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t capacity = FRAME_ARENA_SIZE);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Returns nullptr if the arena is full
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* allocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "The arena never runs destructors");
+        T* array = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        for (size_t index = 0; array != nullptr && index < count; ++index)
+        {
+            new (&array[index]) T {};
+        }
+        return array;
+    }
+
+    template <typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "The arena never runs destructors");
+        void* memory = allocate(sizeof(T), alignof(T));
+        return (memory != nullptr) ? new (memory) T { std::forward<Args>(args)... } : nullptr;
+    }
+
+    // Frees everything allocated since the last reset
+    void reset();
+
+    size_t used() const;
+    size_t capacity() const;
+
+    // Most bytes used in any one frame, to size the arena
+    size_t highWaterMark() const;
+
+private:
+    std::unique_ptr<std::byte[]> mBuffer;
+    size_t mCapacity;
+    size_t mUsed;
+    size_t mHighWaterMark;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+
+#include "engine/Framebuffer.h"
+#include "engine/SpscQueue.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+inline constexpr size_t CAPTURE_BUFFERS = 4; // frames read back and waiting for the capture thread
+inline constexpr size_t CAPTURE_QUEUE_SIZE = 8;
+inline constexpr Uint32 RECORD_FPS = 30;
+inline constexpr Uint32 RECORD_MAX_REPEATS = RECORD_FPS; // a frame fills at most a second of a stalled clip
+
+// Screenshots and clips taken from the running game. The main thread only
+// reads the frame back into one of a few pooled surfaces. PNG compression,
+// video conversion and file writes all happen on a capture thread, so
+// capturing never stalls the frame.
+//
+// With recording on, frames are kept at RECORD_FPS in a ring buffer of the
+// last few seconds, already converted to I420, and a clip writes them out
+// as a Y4M video. The ring is only touched by the capture thread, which
+// takes jobs in order, so a clip holds exactly the frames recorded before it
+class FrameCapture
+{
+public:
+    FrameCapture();
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Frame size, and seconds to keep recording or 0 for screenshots only.
+    // Allocates every buffer up front and starts the capture thread.
+    // Files are written to the given directory
+    bool open(int, int, Uint32, const std::string& = ".");
+
+    // Finishes the queued captures and stops the thread
+    void close();
+
+    bool isOpen() const;
+
+    bool isRecording() const;
+
+    // Main thread. Taken from the next frame captured
+    void requestScreenshot();
+    void requestClip();
+
+    // Main thread. Whether capture() would do something now, so an idle
+    // engine knows to draw a frame for it
+    bool isPending(Uint32) const;
+
+    // Main thread, once a frame has been drawn and before it is presented.
+    // Reads the frame back if a screenshot is due or recording wants it.
+    // Returns whether it did
+    bool capture(SDL_Renderer*, Uint32);
+
+    // Recorded frames lost because every buffer was busy
+    size_t getDroppedFrames() const;
+
+    // Files written so far, for tests and the log
+    size_t getFilesWritten() const;
+
+    // Frames the capture thread has finished with, for tests
+    size_t getFramesProcessed() const;
+
+private:
+    struct Job
+    {
+        size_t buffer; // CAPTURE_BUFFERS for a clip, which needs none
+        bool screenshot;
+        Uint32 recordRepeats; // slots of the ring this frame fills
+    };
+
+    // Main thread
+    bool acquireBuffer(size_t&);
+    void submit(const Job&);
+
+    // Capture thread
+    void workerLoop();
+    void run(const Job&);
+    void saveScreenshot(const SDL_Surface*);
+    void record(const SDL_Surface*, Uint32);
+    void saveClip();
+    std::string nextFileName(const char*, const char*);
+
+    int mWidth;
+    int mHeight;
+    std::string mDirectory;
+    size_t mRecordFrames; // ring capacity, 0 when not recording
+
+    // A buffer is busy from the read back until the capture thread is done with it
+    std::array<SurfacePtr, CAPTURE_BUFFERS> mBuffers;
+    std::array<std::atomic<bool>, CAPTURE_BUFFERS> mBufferBusy;
+
+    // Main thread only
+    bool mScreenshotRequested;
+    bool mClipRequested;
+    Uint32 mNextRecordMs;
+    size_t mDroppedFrames;
+
+    // Main thread -> capture thread
+    SpscQueue<Job, CAPTURE_QUEUE_SIZE> mJobs;
+    std::thread mWorker;
+    std::mutex mWakeMutex;
+    std::condition_variable mWake;
+    std::atomic<bool> mStopping;
+
+    // Capture thread only
+    std::vector<std::vector<uint8_t>> mRing;
+    size_t mRingNext; // slot the next frame goes in
+    size_t mRingCount;
+    std::atomic<size_t> mFilesWritten;
+    std::atomic<size_t> mFramesProcessed;
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef FRAMEEXPORTER_H
+#define FRAMEEXPORTER_H
+
+#include "engine/Framebuffer.h"
+#include "engine/ThreadPool.h"
+#include <cstdio>
+#include <deque>
+#include <future>
+#include <string>
+#include <vector>
+
+inline constexpr size_t EXPORT_FRAMES_PER_THREAD = 4; // frames in flight per encoder thread
+
+enum class ExportFormat
+{
+    PNG, // one numbered file per frame in a directory
+    Y4M, // a single file of uncompressed 4:2:0 video
+};
+
+// Writes frames to disk, encoding them on a ThreadPool. The caller draws a
+// frame and hands it to push(), which copies it and returns while workers
+// convert or compress it. At most EXPORT_FRAMES_PER_THREAD frames per
+// worker are in flight: past that push() waits for the oldest, so a slow
+// disk holds back the renderer instead of filling memory. Frames are
+// always written in the order they were pushed
+class FrameExporter
+{
+public:
+    FrameExporter();
+    ~FrameExporter();
+
+    FrameExporter(const FrameExporter&) = delete;
+    FrameExporter& operator=(const FrameExporter&) = delete;
+
+    // Frame size, frame rate as a fraction and encoder threads (0 is one
+    // per hardware thread). PNG frames go in an existing directory
+    bool open(ExportFormat, const std::string&, int, int, int, int, size_t = 0);
+
+    // Queue a frame the size given to open()
+    bool push(const SDL_Surface*);
+
+    // Waits for the frames still in flight. Returns false if any failed.
+    // Called by the destructor if needed
+    bool close();
+
+    size_t getFramesWritten() const;
+
+    // A Y4M stream is this header, then every frame as FRAME\n and its I420 planes
+    static bool writeY4MHeader(std::FILE*, int, int, int, int);
+    static bool writeY4MFrame(std::FILE*, const std::vector<uint8_t>&);
+
+    // BT.601 studio range I420: the Y plane, then U and V at half size,
+    // rounded up for odd sizes
+    static void toI420(const SDL_Surface*, std::vector<uint8_t>&);
+
+private:
+    struct Encoded
+    {
+        bool ok;
+        std::vector<uint8_t> bytes; // written to the stream, empty for PNG
+    };
+
+    Encoded encode(const SDL_Surface*, size_t) const;
+
+    // Waits for the oldest frame and writes it
+    bool writeOldest();
+
+    ExportFormat mFormat;
+    std::string mPath;
+    int mWidth;
+    int mHeight;
+    std::FILE* mFile; // Y4M only
+    std::unique_ptr<ThreadPool> mEncoders;
+    std::deque<std::future<Encoded>> mInFlight;
+    size_t mMaxInFlight;
+    size_t mFramesPushed;
+    size_t mFramesWritten;
+    bool mFailed;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <SDL.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct SDLSurfaceDeleter
+{
+    void operator()(SDL_Surface* surface) const
+    {
+        SDL_FreeSurface(surface);
+    }
+};
+
+using SurfacePtr = std::unique_ptr<SDL_Surface, SDLSurfaceDeleter>;
+
+// Checking frames drawn by a headless engine (see BaseEngine::startHeadless)
+// against known good ones. Frames are 32 bit ARGB8888 surfaces
+namespace Framebuffer
+{
+// A blank frame of the given width and height
+SurfacePtr create(int, int);
+
+// A copy to keep, e.g. as a golden image held in memory
+SurfacePtr copy(const SDL_Surface*);
+
+// FNV-1a over the visible pixels, row by row, so pitch padding is ignored
+uint64_t hash(const SDL_Surface*);
+
+// How many pixels differ, or -1 if the frames aren't the same size
+long countDifferentPixels(const SDL_Surface*, const SDL_Surface*);
+
+// Golden images are BMPs, lossless and readable without SDL_image
+bool save(const SDL_Surface*, const std::string&);
+SurfacePtr load(const std::string&);
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include "engine/LatencyTracker.h"
+#include <array>
+#include <cstdint>
+
+// Values below this are counted exactly, above it each power of two is
+// split into LATENCY_HISTOGRAM_SUB_BUCKETS, so percentiles are within ~6%
+inline constexpr uint32_t LATENCY_HISTOGRAM_EXACT = 32;
+inline constexpr uint32_t LATENCY_HISTOGRAM_SUB_BUCKETS = 16;
+inline constexpr size_t LATENCY_HISTOGRAM_BUCKETS = LATENCY_HISTOGRAM_EXACT + (32 - 5) * LATENCY_HISTOGRAM_SUB_BUCKETS;
+
+// Counts every sample instead of keeping a window like LatencyTracker, so it
+// holds the tail of millions of samples in constant space and histograms
+// from several threads can be merged. The unit is up to the caller
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(uint32_t);
+
+    void merge(const LatencyHistogram&);
+
+    void clear();
+
+    // Percentiles over every sample since the last clear(). Values are the
+    // lower bound of their bucket, except max which is exact
+    LatencyPercentiles getPercentiles() const;
+
+    uint64_t getCount() const;
+
+private:
+    static size_t bucketOf(uint32_t);
+    static uint32_t bucketValue(size_t);
+
+    uint32_t percentile(uint64_t) const;
+
+    std::array<uint64_t, LATENCY_HISTOGRAM_BUCKETS> mBuckets;
+    uint64_t mCount;
+    uint32_t mMax;
+};
+
+#endif
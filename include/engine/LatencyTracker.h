@@ -0,0 +1,42 @@
+#ifndef LATENCYTRACKER_H
+#define LATENCYTRACKER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+inline constexpr size_t LATENCY_WINDOW = 512;
+
+struct LatencyPercentiles
+{
+    uint32_t p50 { 0 };
+    uint32_t p90 { 0 };
+    uint32_t p99 { 0 };
+    uint32_t max { 0 };
+    size_t samples { 0 };
+};
+
+// Rolling window of input-to-photon latencies in milliseconds. Only the
+// most recent LATENCY_WINDOW samples count towards the percentiles
+class LatencyTracker
+{
+public:
+    LatencyTracker();
+
+    void record(uint32_t);
+
+    // Percentiles over the current window
+    LatencyPercentiles getPercentiles() const;
+
+    // Every sample recorded since the start, including ones that left the window
+    uint64_t getTotalSamples() const;
+
+    // Prints the current percentiles on one line, prefixed with the label
+    void log(const char*) const;
+
+private:
+    std::array<uint32_t, LATENCY_WINDOW> mSamples;
+    uint64_t mTotalSamples;
+};
+
+#endif
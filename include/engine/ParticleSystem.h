@@ -0,0 +1,67 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include <SDL.h>
+#include <cstddef>
+#include <vector>
+
+// A fixed pool of short lived particles. Each field is its own array
+// (structure of arrays), so update() runs straight down contiguous floats,
+// four particles per SSE2 instruction where available. Everything is
+// allocated up front: emitting past the capacity drops the particle, and
+// nothing allocates once the pool exists. render() draws the whole pool
+// as coloured quads in a single SDL_RenderGeometry call
+class ParticleSystem
+{
+public:
+    explicit ParticleSystem(size_t);
+
+    // Position in pixels, velocity in pixels per second and life in
+    // seconds. Returns false if the pool is full
+    bool emit(float, float, float, float, float, SDL_Color);
+
+    // Advance every particle, then drop the ones whose life ran out
+    void update(float);
+
+    // Pixels per second squared, added to the downward velocity
+    void setGravity(float);
+
+    // Squares of the given size in pixels, fading out as their life runs out
+    void render(SDL_Renderer*, float);
+
+    void clear();
+
+    bool empty() const;
+
+    size_t size() const;
+
+    size_t capacity() const;
+
+    float getPosX(size_t) const;
+
+    float getPosY(size_t) const;
+
+private:
+    // The position, velocity and lifetime kernel
+    void integrate(float);
+
+    void removeDead();
+
+    size_t mCount;
+    float mGravity;
+
+    // One entry per particle, the first mCount are alive
+    std::vector<float> mPosX;
+    std::vector<float> mPosY;
+    std::vector<float> mVelX;
+    std::vector<float> mVelY;
+    std::vector<float> mLife; // seconds left
+    std::vector<float> mFade; // 1 / starting life, so alpha = life * fade
+    std::vector<SDL_Color> mColour;
+
+    // Built by render(), sized for the whole pool up front
+    std::vector<SDL_Vertex> mVertices;
+    std::vector<int> mIndices;
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Lock-free bounded queue for exactly one producer thread and one consumer
+// thread. push() fails instead of blocking when the queue is full
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscQueue()
+        : mHead { 0 }
+        , mTail { 0 }
+        , mBuffer {}
+    {
+    }
+
+    // Producer side
+    bool push(const T& value)
+    {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mHead.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+        mBuffer[tail & (Capacity - 1)] = value;
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& value)
+    {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mTail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        value = mBuffer[head & (Capacity - 1)];
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+    }
+
+private:
+    // Keep the two indices on separate cache lines so the threads don't fight over one
+    alignas(64) std::atomic<size_t> mHead; // next slot to read
+    alignas(64) std::atomic<size_t> mTail; // next slot to write
+    std::array<T, Capacity> mBuffer;
+};
+
+#endif
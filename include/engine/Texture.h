@@ -30,12 +30,26 @@ public:
     // Loads image at specified path
     bool loadFromFile(const std::string& path);
 
+    // Loads an image file that is already in memory. The name is only for error messages
+    bool loadFromMemory(const void* data, size_t size, const std::string& name);
+
+    // Decode an image into a colour keyed surface without touching the
+    // renderer, so these are safe to call from worker threads. NULL on failure
+    static SDL_Surface* decodeFile(const std::string& path);
+    static SDL_Surface* decodeMemory(const void* data, size_t size, const std::string& name);
+
+    // Uploads a decoded surface to the GPU. Takes ownership of the surface
+    bool loadFromSurface(SDL_Surface*, const std::string& name);
+
     // Creates image from font string
-    bool loadFromRenderedText(std::string textureText, SDL_Color textColor, SDL_Color backgroundColour);
+    bool loadFromRenderedText(const char* textureText, SDL_Color textColor, SDL_Color backgroundColour);
 
     // Deallocates texture
     void reset();
 
+    // Font used by loadFromRenderedText from now on
+    void setFont(TTF_Font*);
+
     // Renders texture at given point
     void render(int x, int y, SDL_Rect* clip = NULL, double angle = 0.0, SDL_Point* center = NULL, SDL_RendererFlip flip = SDL_FLIP_NONE);
 
@@ -0,0 +1,67 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer, single consumer triple buffer. The writer
+// fills its private buffer and publishes it, the reader picks up the most
+// recently published one. Neither side ever waits for the other, and the
+// reader never sees a half-written value. Intermediate values can be skipped
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : mBuffers {}
+        , mMiddle { 1 }
+        , mWriteIndex { 0 }
+        , mReadIndex { 2 }
+    {
+    }
+
+    // Writer side
+    T& getWriteBuffer()
+    {
+        return mBuffers[mWriteIndex];
+    }
+
+    void publish()
+    {
+        uint8_t previous = mMiddle.exchange(static_cast<uint8_t>(mWriteIndex | DIRTY), std::memory_order_acq_rel);
+        mWriteIndex = previous & INDEX_MASK;
+    }
+
+    // Reader side. Switches to the newest published buffer, returns false if nothing new was published
+    bool update()
+    {
+        if (!(mMiddle.load(std::memory_order_relaxed) & DIRTY))
+        {
+            return false;
+        }
+        uint8_t previous = mMiddle.exchange(mReadIndex, std::memory_order_acq_rel);
+        mReadIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T& getReadBuffer() const
+    {
+        return mBuffers[mReadIndex];
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY = 0x4;
+
+    std::array<T, 3> mBuffers;
+
+    // Index of the buffer in the middle, plus whether it holds unread data
+    std::atomic<uint8_t> mMiddle;
+
+    // Only touched by their own side
+    uint8_t mWriteIndex;
+    uint8_t mReadIndex;
+};
+
+#endif
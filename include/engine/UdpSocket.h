@@ -0,0 +1,76 @@
+#ifndef UDPSOCKET_H
+#define UDPSOCKET_H
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+using SocketHandle = SOCKET;
+#else
+#include <netinet/in.h>
+using SocketHandle = int;
+#endif
+
+// A non-blocking UDP socket talking to a single peer. Outgoing packets can
+// be delayed and dropped on purpose, to test netcode over loopback
+class UdpSocket
+{
+public:
+    UdpSocket();
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    // Bind to the given local port. Port 0 picks any free port
+    bool open(uint16_t port, const std::string& address = "127.0.0.1");
+
+    void close();
+
+    uint16_t getLocalPort();
+
+    bool setPeer(const std::string& address, uint16_t port);
+
+    bool send(const uint8_t*, size_t);
+
+    // Copies the next waiting packet into the buffer. Returns its size, or 0 if there is none
+    size_t receive(uint8_t*, size_t);
+
+    // Delay every outgoing packet by latency +/- jitter and drop a fraction of them
+    void setImpairment(uint32_t latencyMs, uint32_t jitterMs, double lossRate, uint32_t seed = 1);
+
+    // Time the impairment delays with a clock that only moves when
+    // advanceClock() is called, so tests don't race real time
+    void useManualClock();
+    void advanceClock(std::chrono::microseconds);
+
+private:
+    struct DelayedPacket
+    {
+        std::chrono::steady_clock::time_point sendTime;
+        std::vector<uint8_t> data;
+    };
+
+    bool sendNow(const uint8_t*, size_t);
+    void flushDelayed();
+    std::chrono::steady_clock::time_point now() const;
+
+    SocketHandle mSocket;
+    sockaddr_in mPeer;
+    bool mHasPeer;
+
+    // Impairment
+    uint32_t mLatencyMs;
+    uint32_t mJitterMs;
+    double mLossRate;
+    std::minstd_rand mRandom;
+    std::vector<DelayedPacket> mDelayed;
+    bool mManualClock;
+    std::chrono::steady_clock::time_point mManualTime;
+};
+
+#endif
@@ -3,31 +3,66 @@
 
 #include "engine/Texture.h"
 
-// The Blocks that will move around on the screen
+// The Blocks that will move around on the screen.
+// Everything but render is constexpr, so fixed size Grids can be
+// built and rotated at compile time
 class Block
 {
 public:
-    Block();
+    constexpr Block()
+        : mPosX(0)
+        , mPosY(0)
+        , mTexture(nullptr)
+    {
+    }
 
-    Block(int, int, Texture*);
+    constexpr Block(int x, int y, Texture* texture)
+        : mPosX(x)
+        , mPosY(y)
+        , mTexture(texture)
+    {
+    }
 
-    void move(int, int);
+    constexpr void move(int velX, int velY)
+    {
+        mPosX += velX;
+        mPosY += velY;
+    }
 
-    void moveTo(int, int);
+    constexpr void moveTo(int x, int y)
+    {
+        mPosX = x;
+        mPosY = y;
+    }
 
-    int getPosX();
+    constexpr int getPosX()
+    {
+        return mPosX;
+    }
 
-    int getPosY();
+    constexpr int getPosY()
+    {
+        return mPosY;
+    }
 
-    void render();
+    void render(int offsetX = 0, int offsetY = 0);
 
     // Having virtual blocks to fill unoccupied Grid squares is easier
     // than the handling required around std::optional<Block> in the Grid
-    bool exists();
+    constexpr bool exists()
+    {
+        return mTexture != nullptr;
+    }
 
-    Texture* getTexture();
+    constexpr Texture* getTexture()
+    {
+        return mTexture;
+    }
 
-    void setTexture(Texture*);
+    constexpr void setTexture(Texture* texture)
+    {
+        mTexture = texture;
+    }
 
 private:
     int mPosX, mPosY;
@@ -35,4 +70,4 @@ private:
     Texture* mTexture;
 };
 
-#endif // BLOCK_H
\ No newline at end of file
+#endif // BLOCK_H
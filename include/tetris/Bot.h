@@ -0,0 +1,30 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include "tetris/Simulation.h"
+#include <climits>
+#include <cstdint>
+
+// A simple deterministic player for headless games. For each new piece it
+// picks a random rotation and column, taps the piece over and drops it.
+// It never looks at the board, so it plays badly, but it fills boards in
+// a believable way for spectating and load tests
+class Bot
+{
+public:
+    explicit Bot(uint64_t);
+
+    // The input for the simulation's next tick
+    uint8_t nextInput(TetrisSimulation&);
+
+private:
+    uint32_t nextRandom(uint32_t);
+
+    uint64_t mState; // SplitMix64 generator state
+    uint32_t mTick;
+    int mLastPosY { INT_MAX }; // a piece higher than the last one is a new piece
+    int mRotationsLeft { 0 };
+    int mTargetCol { 0 };
+};
+
+#endif
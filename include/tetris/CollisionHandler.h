@@ -3,50 +3,89 @@
 
 #include "engine/Texture.h"
 #include "tetris/Grid.h"
+#include <array>
+
+// Told about every change the CollisionHandler makes to the pieces and the
+// board, e.g. to stream a game to spectators. Does nothing by default
+class CollisionListener
+{
+public:
+    virtual ~CollisionListener() = default;
+
+    // The simulation dealt a new piece
+    virtual void pieceSpawned()
+    {
+    }
+
+    // The piece moved sideways by this many blocks
+    virtual void pieceMoved(int)
+    {
+    }
+
+    // The piece rotated clockwise, and stayed rotated
+    virtual void pieceRotated()
+    {
+    }
+
+    // The piece was frozen into the board where it is now
+    virtual void pieceLocked()
+    {
+    }
+
+    // A run of completed rows was deleted, see Grid::moveRowsDown. A piece
+    // that completes rows with a gap between them deletes each run in turn,
+    // the top one first
+    virtual void rowsCleared(size_t, size_t)
+    {
+    }
+};
 
 // Handles the horizontal, rotational and vertical
 // collision scenarios, as well as freezing Tetronimos
 // when they stop moving, and deleting rows which the
-// players had completed
+// players had completed. Completed rows go straight
+// away, any effect is up to the renderer, see RowFlash
 class CollisionHandler
 {
 public:
-    CollisionHandler(Texture*, Texture*, uint32_t);
+    CollisionHandler();
 
-    bool handle(Grid&, Grid&, uint32_t);
+    bool handle(Grid&, Grid&);
 
     bool keepPlaying();
 
-private:
-    bool animateCompletedRows(Grid&);
+    const LineClear& getLastClear() const;
+
+    const HardDrop& getLastDrop() const;
 
+    void snapshot(GameState&) const;
+
+    void restore(const GameState&);
+
+    // Null to stop listening
+    void setListener(CollisionListener*);
+
+private:
     void handleHorizontal(Grid&, Grid&);
 
     void handleRotational(Grid&, Grid&);
 
     bool handleVertical(Grid&, Grid&);
 
+    void hardDrop(Grid&, Grid&);
+
     void freezeTetronimo(Grid&, Grid&);
 
     void handleCompletedRows(Grid&, Grid&);
 
     bool checkForCompletedRow(int, Grid&);
 
-    void setFlashingTexture(std::vector<size_t>, Grid&, Texture*);
-
     bool hasCollided(Grid&, Grid&);
 
+    CollisionListener* mListener { nullptr };
     bool mKeepPlaying { true };
-    std::vector<size_t> mCompletedRows;
-    Uint32 mPreviousTime;
-    Uint32 mCurrentTime;
-    Texture* mWhiteFlashTexture;
-    Texture* mBlackFlashTexture;
-
-    // State variables for when we animate a finished row by making it flash
-    bool mFinishedRowRoutine { false };
-    Uint32 mFlashRowTransitionTime;
-    int mNumberOfFlashesRemaining { N_ROW_FLASHES };
+    LineClear mLastClear {};
+    HardDrop mLastDrop {};
 };
 
 #endif
\ No newline at end of file
@@ -10,18 +10,38 @@ constexpr int BLOCK_SIZE = 40;
 constexpr int VERTICAL_VELOCITY = 1;
 constexpr int VERTICAL_FAST_VELOCITY = 3 * VERTICAL_VELOCITY;
 
-constexpr int INPUT_INTERVAL_MS = 50;
+constexpr Uint32 TICK_MS = 16; // fixed simulation step, roughly 60Hz
 constexpr int COMPLETED_ROW_FLASH_INTERVAL_MS = 100;
 constexpr int N_ROW_FLASHES = 4;
+constexpr uint32_t SCORE_PER_TETRONIMO = 4; // for every piece that lands
 
+// The default board. Other sizes can be picked at runtime with a BoardSize
 constexpr int N_ROWS = 22;
 constexpr int N_COLS = 10;
 constexpr int START_LINE = 2 * BLOCK_SIZE; // N_ROWS - 2 is playable
 constexpr int SCREEN_WIDTH { BLOCK_SIZE * N_COLS };
 constexpr int SCREEN_HEIGHT { (BLOCK_SIZE * N_ROWS) + 24 }; // TODO
-constexpr int TETRONIMO_START_X = 120;
 constexpr int TETRONIMO_START_Y = 0;
 
+// Each board row is also kept as a single bitboard word
+constexpr size_t MAX_BOARD_COLS = 64;
+constexpr size_t MIN_BOARD_COLS = 4; // room for the I piece
+constexpr size_t MIN_BOARD_ROWS = (START_LINE / BLOCK_SIZE) + 4;
+
+struct BoardSize
+{
+    size_t rows { N_ROWS };
+    size_t cols { N_COLS };
+};
+
+// Spawn pieces roughly in the middle of the board
+constexpr int tetronimoStartX(size_t cols)
+{
+    return static_cast<int>((cols - 3) / 2) * BLOCK_SIZE;
+}
+
+constexpr int TETRONIMO_START_X = tetronimoStartX(N_COLS);
+
 // Different textures for blocks
 constexpr std::string_view BLOCK_TEXTURE_RED { "red.bmp" };
 constexpr std::string_view BLOCK_TEXTURE_BLUE { "blue.bmp" };
@@ -0,0 +1,58 @@
+#ifndef GAMEEVENTLOG_H
+#define GAMEEVENTLOG_H
+
+#include "engine/EventLog.h"
+#include "tetris/CollisionHandler.h"
+#include "tetris/Simulation.h"
+#include "tetris/TexturePalette.h"
+
+// What a Tetris session writes to an EventLog, see --event-log. Positions
+// are in blocks, ticks are simulation ticks
+enum GameEventType : uint8_t
+{
+    GAME_EVENT_SPAWN = 0, // palette index, column
+    GAME_EVENT_MOVE = 1, // blocks moved, negative is left
+    GAME_EVENT_ROTATE = 2,
+    GAME_EVENT_LOCK = 3, // column, row
+    GAME_EVENT_LINE_CLEAR = 4, // rows cleared, bottom row
+    GAME_EVENT_GAME_OVER = 5, // score
+    GAME_EVENT_FRAME = 6, // microseconds since the last frame, fps. The tick is the one on screen
+};
+
+// Producer indices, one per thread that logs
+inline constexpr size_t GAME_EVENT_SIMULATION = 0;
+inline constexpr size_t GAME_EVENT_MAIN = 1;
+
+// Readable name of a GameEventType or EVENT_LOG_DROPPED
+const char* gameEventName(uint8_t);
+
+// Logs what the CollisionHandler does to a simulation, on the thread that
+// steps it. Listens while it exists, like SpectatorStreamEncoder, so the
+// two can't follow the same simulation
+class GameEventLogger : public CollisionListener
+{
+public:
+    GameEventLogger(EventLog&, TetrisSimulation&, std::unordered_map<std::string_view, std::unique_ptr<Texture>>&);
+
+    ~GameEventLogger() override;
+
+    GameEventLogger(const GameEventLogger&) = delete;
+    GameEventLogger& operator=(const GameEventLogger&) = delete;
+
+    void gameOver();
+
+private:
+    void pieceSpawned() override;
+    void pieceMoved(int) override;
+    void pieceRotated() override;
+    void pieceLocked() override;
+    void rowsCleared(size_t, size_t) override;
+
+    void log(uint8_t, int32_t = 0, int32_t = 0);
+
+    EventLog& mLog;
+    TetrisSimulation& mSimulation;
+    TexturePalette mPalette;
+};
+
+#endif
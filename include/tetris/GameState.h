@@ -0,0 +1,107 @@
+#ifndef GAMESTATE_H
+#define GAMESTATE_H
+
+#include "tetris/Constants.h"
+#include <cstdint>
+#include <type_traits>
+
+inline constexpr size_t MAX_TETRONIMO_SIZE = 4;
+inline constexpr size_t MAX_COMPLETED_ROWS = MAX_TETRONIMO_SIZE;
+
+// The largest board a GameState can hold. Bigger boards still play
+// headless, they just can't be snapshotted, rendered or rolled back
+inline constexpr size_t MAX_STATE_ROWS = 32;
+inline constexpr size_t MAX_STATE_COLS = 16;
+
+inline constexpr bool fitsInGameState(BoardSize board)
+{
+    return board.rows <= MAX_STATE_ROWS && board.cols <= MAX_STATE_COLS;
+}
+
+// Flat copy of a Grid. Blocks are stored as TexturePalette indices and
+// their screen positions are rebuilt from the Grid position on restore
+template <size_t Rows, size_t Cols>
+struct GridState
+{
+    int32_t posX;
+    int32_t posY;
+    int32_t velX;
+    int32_t velY;
+    uint16_t rows;
+    uint16_t cols;
+    bool rotate;
+    uint8_t cells[Rows][Cols];
+};
+
+// The most recent rows the CollisionHandler cleared, so a renderer can draw
+// an effect over where they were. clears counts every clear in the game, so
+// a change means a new one. A piece can complete rows with a gap between
+// them, so bit N of rowMask is set if row bottomRow - N was cleared. The
+// rows are all within one piece's height of bottomRow
+struct LineClear
+{
+    uint32_t clears;
+    uint16_t bottomRow;
+    uint8_t rows;
+    uint8_t rowMask;
+
+    // Add count rows ending at bottom, which were deleted with
+    // Grid::moveRowsDown, to the rows already cleared
+    void addRows(size_t bottom, size_t count)
+    {
+        if (rows == 0 || bottom > bottomRow)
+        {
+            rowMask = static_cast<uint8_t>((rows == 0) ? 0 : rowMask << (bottom - bottomRow));
+            bottomRow = static_cast<uint16_t>(bottom);
+        }
+        for (size_t row = bottom + 1 - count; row <= bottom; ++row)
+        {
+            rowMask = static_cast<uint8_t>(rowMask | (1u << (bottomRow - row)));
+        }
+        rows = static_cast<uint8_t>(rows + count);
+    }
+};
+
+static_assert(MAX_TETRONIMO_SIZE <= 8, "A LineClear's rows must fit in rowMask");
+
+// The most recent hard drop, for effects. drops counts every hard drop in
+// the game. The piece covers columns col to col + cols - 1 and fell rows
+// blocks, its lowest block landing on bottomRow
+struct HardDrop
+{
+    uint32_t drops;
+    uint8_t col;
+    uint8_t cols;
+    uint16_t bottomRow;
+    uint16_t rows;
+};
+
+// Everything needed to resume a game, in a form that can be copied with
+// memcpy. Used for undo, search, rollback and seeking through replays
+struct GameState
+{
+    GridState<MAX_STATE_ROWS, MAX_STATE_COLS> board;
+    GridState<MAX_TETRONIMO_SIZE, MAX_TETRONIMO_SIZE> tetronimo;
+
+    // CollisionHandler
+    LineClear lastClear;
+    HardDrop lastDrop;
+    bool keepPlaying;
+
+    // AutoShift
+    int8_t autoShiftDirection;
+    uint32_t autoShiftHeldTicks;
+
+    // TetronimoFactory
+    uint64_t generatorState;
+
+    // TetrisSimulation
+    uint32_t tick;
+    uint32_t score;
+    bool playing;
+};
+
+static_assert(std::is_trivially_copyable_v<GameState>);
+static_assert(sizeof(GameState) <= 1024, "GameState should stay cheap to copy");
+
+#endif
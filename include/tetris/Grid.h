@@ -3,29 +3,47 @@
 
 #include "tetris/Block.h"
 #include "tetris/Constants.h"
+#include "tetris/GameState.h"
+#include "tetris/TexturePalette.h"
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
 #include <sstream>
 #include <vector>
 
 // A class wrapping a 2D grid of Blocks.
 // The game board, as well as individual Tetronimos are
-// stored in a Grid. Provides rotating functionality
+// stored in a Grid. Provides rotating functionality.
+// Alongside the Blocks each row is kept as a bitboard word, bit N set
+// when column N holds a block, so collision and completed row checks
+// are a few word operations however big the board is
 class Grid
 {
 public:
     Grid(int, int, size_t, size_t);
 
+    // Turn this into an empty Grid of the given size and position, as if it
+    // was newly constructed. Keeps the storage, so it only allocates when
+    // the Grid grows beyond the largest size it has had
+    void reset(int, int, size_t, size_t);
+
     // Takes key presses and adjusts the Block's velocity
     void handleEvent(SDL_Event& e);
 
-    // Call a function on each block in the Grid
+    // Same as handleEvent, driven by a tick's InputFlags and the
+    // horizontal shift worked out by AutoShift instead
+    void applyInput(uint8_t, int);
+
+    // Call a function on each block in the Grid, in memory order
     template <typename Func>
     void forEachBlock(Func&& func)
     {
-        for (size_t xIndex = 0; xIndex < mCols; ++xIndex)
+        for (size_t yIndex = 0; yIndex < mRows; ++yIndex)
         {
-            for (size_t yIndex = 0; yIndex < mRows; ++yIndex)
+            Block* row = getRow(yIndex);
+            for (size_t xIndex = 0; xIndex < mCols; ++xIndex)
             {
-                func(mGrid[yIndex][xIndex], xIndex, yIndex);
+                func(row[xIndex], xIndex, yIndex);
             }
         }
     }
@@ -33,12 +51,13 @@ public:
     // Check if any blocks in the Grid satisfy a conditon
     template <typename Func>
     bool anyBlocks(Func&& func)
-    {   
-        for (size_t xIndex = 0; xIndex < mCols; ++xIndex)
+    {
+        for (size_t yIndex = 0; yIndex < mRows; ++yIndex)
         {
-            for (size_t yIndex = 0; yIndex < mRows; ++yIndex)
+            Block* row = getRow(yIndex);
+            for (size_t xIndex = 0; xIndex < mCols; ++xIndex)
             {
-                if (func(mGrid[yIndex][xIndex], xIndex, yIndex))
+                if (func(row[xIndex], xIndex, yIndex))
                 {
                     return true;
                 }
@@ -47,14 +66,40 @@ public:
         return false;
     }
 
+    // Every Block, row by row, for range based loops
+    Block* begin()
+    {
+        return mBlocks.data();
+    }
+
+    Block* end()
+    {
+        return mBlocks.data() + mRows * mCols;
+    }
+
+    // The mCols Blocks of one row, which are contiguous
+    Block* getRow(size_t yIndex)
+    {
+        return mBlocks.data() + yIndex * mCols;
+    }
+
     void move(int, int);
 
     void createBlock(int, int, Texture*);
 
     Block& getBlock(size_t, size_t);
+
+    // Occupied columns of a row, bit N for column N
+    uint64_t getRowMask(size_t);
+
+    bool isRowFull(size_t);
+
+    // The row mask of a full row in a Grid this wide
+    static uint64_t fullRowMask(size_t);
+
     void rotateClockwise();
     void rotateAntiClockwise();
-    void render();
+    void render(int offsetX = 0, int offsetY = 0);
 
     size_t getHeight();
 
@@ -70,10 +115,63 @@ public:
 
     bool shouldRotate();
 
+    // Set by applyInput for the tick the hard drop was pressed
+    bool shouldHardDrop();
+
     void updatePositions();
 
+    // Drop every row above the bottom row down by the given number of rows,
+    // discarding the rows they land on. Only touches rows at or above the bottom row
     void moveRowsDown(size_t, size_t);
 
+    // Copy the Grid to and from its flat representation. A Grid bigger
+    // than the state can't be snapshotted
+    template <size_t Rows, size_t Cols>
+    bool snapshot(GridState<Rows, Cols>& state, const TexturePalette& palette)
+    {
+        // Leave an empty Grid rather than write past the end of the state
+        if (mRows > Rows || mCols > Cols)
+        {
+            printf("A %zux%zu Grid doesn't fit in a %zux%zu GridState!\n", mCols, mRows, Cols, Rows);
+            state.rows = 0;
+            state.cols = 0;
+            return false;
+        }
+        state.posX = mPosX;
+        state.posY = mPosY;
+        state.velX = mVelX;
+        state.velY = mVelY;
+        state.rows = static_cast<uint16_t>(mRows);
+        state.cols = static_cast<uint16_t>(mCols);
+        state.rotate = mRotate;
+        forEachBlock(
+            [&state, &palette](Block& block, size_t xIndex, size_t yIndex)
+            {
+                state.cells[yIndex][xIndex] = palette.indexOf(block.getTexture());
+            });
+        return true;
+    }
+
+    template <size_t Rows, size_t Cols>
+    void restore(const GridState<Rows, Cols>& state, const TexturePalette& palette)
+    {
+        reset(state.posX, state.posY, state.rows, state.cols);
+        mVelX = state.velX;
+        mVelY = state.velY;
+        mRotate = state.rotate;
+        forEachBlock(
+            [this, &state, &palette](Block& block, size_t xIndex, size_t yIndex)
+            {
+                block = Block { mPosX + static_cast<int>(xIndex) * BLOCK_SIZE,
+                    mPosY + static_cast<int>(yIndex) * BLOCK_SIZE,
+                    palette.at(state.cells[yIndex][xIndex]) };
+                if (block.exists())
+                {
+                    mRowMasks[yIndex] |= uint64_t { 1 } << xIndex;
+                }
+            });
+    }
+
 private:
     // The X and Y offsets of the grid
     int mPosX, mPosY;
@@ -83,12 +181,16 @@ private:
     int mVelY = VERTICAL_VELOCITY;
     bool mRotate = false; // The user has pressed the rotate key and it should
                           // rotate this frame
+    bool mHardDrop = false; // only for the tick it was pressed, never snapshotted
 
     void transpose();
 
+    void updateRowMasks();
+
     size_t mRows;
     size_t mCols;
-    std::vector<std::vector<Block>> mGrid; // 2D vector of Blocks or nulls
+    std::vector<Block> mBlocks; // Blocks or nulls, row-major, at least mRows * mCols
+    std::vector<uint64_t> mRowMasks; // at least mRows
 };
 
 #endif
\ No newline at end of file
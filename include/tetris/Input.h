@@ -0,0 +1,93 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <SDL.h>
+#include <cstdint>
+
+// One byte of player input per simulation tick. The movement flags are
+// "held" states, the pressed flags are set only on the tick the key went
+// down, so a tap that starts and ends between two ticks is still seen.
+// This is what replays store and what netplay peers exchange
+enum InputFlags : uint8_t
+{
+    INPUT_NONE = 0,
+    INPUT_LEFT = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_DOWN = 1 << 2,
+    INPUT_ROTATE = 1 << 3,
+    INPUT_LEFT_PRESSED = 1 << 4,
+    INPUT_RIGHT_PRESSED = 1 << 5,
+    INPUT_HARD_DROP = 1 << 6, // pressed only, drops the piece as far as it goes and locks it
+};
+
+inline constexpr uint8_t INPUT_HELD_MASK = INPUT_LEFT | INPUT_RIGHT | INPUT_DOWN;
+
+// Delayed auto shift and auto repeat rate, in ticks. A held direction
+// moves once on the press, again after delayTicks, then every repeatTicks
+inline constexpr uint32_t DAS_DEFAULT_TICKS = 10;
+inline constexpr uint32_t ARR_DEFAULT_TICKS = 2;
+
+struct AutoShiftSettings
+{
+    uint32_t delayTicks { DAS_DEFAULT_TICKS };
+    uint32_t repeatTicks { ARR_DEFAULT_TICKS };
+};
+
+// A single key press or release, stamped with SDL_GetTicks() when it happened
+struct InputEvent
+{
+    uint32_t timestamp;
+    uint8_t flag;
+    bool pressed;
+};
+
+// Turns SDL keyboard events into per-tick input flags
+class KeyboardInput
+{
+public:
+    KeyboardInput();
+
+    // Returns false for events that are not game keys, and for key repeats
+    static bool toInputEvent(const SDL_Event&, InputEvent&);
+
+    void handleEvent(SDL_Event& e);
+
+    void handleEvent(const InputEvent&);
+
+    // The input for the next tick. Presses are latched until clearPressed()
+    uint8_t getInput();
+
+    // When the oldest event folded into getInput() happened, 0 if there was none
+    uint32_t getOldestTimestamp();
+
+    // Call once the input has been consumed by a tick
+    void clearPressed();
+
+private:
+    uint8_t mHeld;
+    uint8_t mPressed;
+    uint32_t mOldestTimestamp;
+};
+
+// Works out the horizontal shift for each tick from the held and pressed
+// flags. Lives inside the simulation so it is part of the snapshot and
+// replays the same on every peer
+class AutoShift
+{
+public:
+    explicit AutoShift(AutoShiftSettings = AutoShiftSettings {});
+
+    // -1, 0 or 1 columns to move this tick
+    int update(uint8_t);
+
+    int8_t getDirection() const;
+    uint32_t getHeldTicks() const;
+    void setState(int8_t, uint32_t);
+
+private:
+    AutoShiftSettings mSettings;
+    int8_t mDirection;
+    uint32_t mHeldTicks;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef MATCHPROTOCOL_H
+#define MATCHPROTOCOL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Packets between tetris_server and its clients, little endian over UDP.
+// Clients send their input every tick, the server answers every tick with
+// the state of the whole match
+inline constexpr uint32_t MATCH_PACKET_MAGIC = 0x56525354; // "TSRV"
+inline constexpr uint16_t MATCH_SERVER_DEFAULT_PORT = 7100;
+
+// magic, match, player, sequence, input
+inline constexpr size_t MATCH_INPUT_PACKET_SIZE = 14;
+
+// magic, match, tick, ack, two scores, two playing flags
+inline constexpr size_t MATCH_STATE_PACKET_SIZE = 26;
+
+struct MatchInputPacket
+{
+    uint32_t matchId { 0 };
+    uint8_t player { 0 }; // 0 or 1
+    uint32_t sequence { 0 }; // counts up with every packet the client sends
+    uint8_t input { 0 }; // InputFlags
+};
+
+struct MatchStatePacket
+{
+    uint32_t matchId { 0 };
+    uint32_t tick { 0 };
+    uint32_t ackSequence { 0 }; // the newest input packet from this player the server has used
+    std::array<uint32_t, 2> scores {};
+    std::array<bool, 2> playing {};
+};
+
+void encodeMatchInput(const MatchInputPacket&, uint8_t*);
+
+// False if the buffer is not an input packet
+bool decodeMatchInput(const uint8_t*, size_t, MatchInputPacket&);
+
+void encodeMatchState(const MatchStatePacket&, uint8_t*);
+
+bool decodeMatchState(const uint8_t*, size_t, MatchStatePacket&);
+
+// Matches are spread over the server's shards by id, and shard N listens
+// on basePort + N, so clients can work out where their match lives
+inline uint16_t matchServerPort(uint16_t basePort, uint32_t matchId, size_t shards)
+{
+    return static_cast<uint16_t>(basePort + matchId % shards);
+}
+
+#endif
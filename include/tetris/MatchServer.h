@@ -0,0 +1,71 @@
+#ifndef MATCHSERVER_H
+#define MATCHSERVER_H
+
+#include "engine/LatencyHistogram.h"
+#include "tetris/MatchProtocol.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+inline constexpr uint32_t MATCH_IDLE_TIMEOUT_MS = 5000; // a match with no packets for this long is dropped
+inline constexpr uint32_t MATCH_MAX_CATCH_UP_TICKS = 4; // per wake up, after that the match falls behind real time
+
+struct MatchServerConfig
+{
+    std::string address { "127.0.0.1" };
+    uint16_t basePort { MATCH_SERVER_DEFAULT_PORT }; // 0 gives every shard any free port
+    size_t shards { 0 }; // 0 means one per hardware thread
+    uint32_t idleTimeoutMs { MATCH_IDLE_TIMEOUT_MS };
+    bool pinThreads { true }; // pin shard N to core N
+};
+
+// Counters since the last takeStats(), summed over the shards
+struct MatchServerStats
+{
+    uint64_t ticks { 0 }; // simulation steps, two per match tick
+    uint64_t packetsIn { 0 };
+    uint64_t packetsOut { 0 };
+    uint64_t matchesStarted { 0 };
+    uint64_t matchesDropped { 0 };
+    size_t matches { 0 }; // running right now
+    LatencyHistogram tickLatencyUs; // when a match tick finished, relative to when it was due
+};
+
+// Hosts many two player matches in one process. The server owns the
+// simulations: clients only send inputs and get the scores back. Matches
+// are split over shards, one thread per core, and each shard has its own
+// socket, epoll loop and timer, so shards share nothing while they run.
+// Every match ticks on its own fixed TICK_MS schedule.
+// Only implemented on Linux, start() fails elsewhere
+class MatchServer
+{
+public:
+    explicit MatchServer(const MatchServerConfig&);
+
+    // Stops the shards
+    ~MatchServer();
+
+    MatchServer(const MatchServer&) = delete;
+    MatchServer& operator=(const MatchServer&) = delete;
+
+    // Open every shard's socket and start its thread
+    bool start();
+
+    void stop();
+
+    size_t getShardCount() const;
+
+    // The port a shard actually listens on
+    uint16_t getPort(size_t) const;
+
+    MatchServerStats takeStats();
+
+private:
+    class Shard;
+
+    MatchServerConfig mConfig;
+    std::vector<std::unique_ptr<Shard>> mShards;
+};
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef PARTICLEEFFECTS_H
+#define PARTICLEEFFECTS_H
+
+#include "engine/ParticleSystem.h"
+#include "tetris/GameState.h"
+#include <random>
+
+inline constexpr size_t MAX_PARTICLES = 16384;
+inline constexpr int LINE_CLEAR_PARTICLES_PER_BLOCK = 12;
+inline constexpr int HARD_DROP_PARTICLES_PER_COLUMN = 10;
+inline constexpr int HARD_DROP_TRAIL_PER_ROW = 2; // per column the piece fell past
+inline constexpr float PARTICLE_GRAVITY = 900.0f; // pixels per second squared
+inline constexpr float PARTICLE_SIZE = 4.0f; // pixels
+
+// Sparks where rows were cleared and dust where a hard dropped piece
+// landed. Like RowFlash this only draws over the board, it reads what the
+// simulation already did and never feeds back into the game
+class ParticleEffects
+{
+public:
+    ParticleEffects();
+
+    // Burst every block of the cleared rows, board columns and x offset
+    void lineCleared(const LineClear&, size_t, int);
+
+    // Dust under the landed piece and a trail up the rows it fell, x offset
+    void hardDropped(const HardDrop&, int);
+
+    void update(float);
+
+    void render(SDL_Renderer*);
+
+    void clear();
+
+    bool empty() const;
+
+private:
+    float random(float, float);
+
+    ParticleSystem mParticles;
+    std::minstd_rand mRandom;
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef REPLAYCORPUS_H
+#define REPLAYCORPUS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// A replay is the seed a game was started with plus one input byte per
+// simulation tick. Many replays are packed into a single corpus file:
+//
+//   [ReplayCorpusHeader][payload 0][payload 1]...[padding][ReplayIndexEntry * count]
+//
+// The header has a fixed size and points at the index, so a reader can map
+// the file and reach any replay in O(1) without touching the other payloads.
+// Fields are written in host order and the index is read in place, so the
+// format is little endian and only little endian hosts are supported.
+inline constexpr char REPLAY_CORPUS_MAGIC[8] { 'T', 'E', 'T', 'R', 'I', 'S', 'R', 'C' };
+inline constexpr uint32_t REPLAY_CORPUS_VERSION = 1;
+
+struct ReplayCorpusHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t replayCount;
+    uint64_t indexOffset;
+    uint64_t reserved[4];
+};
+
+// Summary of a single replay, stored in the index so tools can filter
+// without reading the replay itself
+struct ReplayMetadata
+{
+    uint64_t seed;
+    uint32_t score;
+    uint32_t lines;
+    uint32_t length; // number of ticks, which is also the payload size in bytes
+    uint32_t reserved;
+};
+
+struct ReplayIndexEntry
+{
+    uint64_t offset;
+    ReplayMetadata metadata;
+};
+
+static_assert(sizeof(ReplayCorpusHeader) == 64, "ReplayCorpusHeader is part of the file format");
+static_assert(sizeof(ReplayIndexEntry) == 32, "ReplayIndexEntry is part of the file format");
+static_assert(std::is_trivially_copyable_v<ReplayIndexEntry>);
+#if defined(__BYTE_ORDER__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "The replay corpus is mapped in place and stored little endian");
+#endif
+
+// A zero-copy view of one replay inside a mapped corpus. Only valid while
+// the ReplayCorpus it came from stays open
+struct ReplayView
+{
+    const ReplayMetadata* metadata;
+    const uint8_t* inputs;
+    size_t length;
+};
+
+// Appends replays to a new corpus file. The index is written by close()
+class ReplayCorpusWriter
+{
+public:
+    ReplayCorpusWriter();
+    ~ReplayCorpusWriter();
+
+    ReplayCorpusWriter(const ReplayCorpusWriter&) = delete;
+    ReplayCorpusWriter& operator=(const ReplayCorpusWriter&) = delete;
+
+    bool open(const std::string& path);
+
+    bool add(uint64_t seed, uint32_t score, uint32_t lines, const uint8_t* inputs, size_t length);
+
+    // Writes the index and the final header. Called by the destructor if needed
+    bool close();
+
+private:
+    bool write(const void*, size_t);
+
+    std::FILE* mFile;
+    uint64_t mOffset;
+    std::vector<ReplayIndexEntry> mIndex;
+};
+
+// Read-only, memory mapped view of a corpus file
+class ReplayCorpus
+{
+public:
+    ReplayCorpus();
+    ~ReplayCorpus();
+
+    ReplayCorpus(const ReplayCorpus&) = delete;
+    ReplayCorpus& operator=(const ReplayCorpus&) = delete;
+
+    // Maps the file and validates the header and index bounds.
+    // Payloads are not read until they are accessed
+    bool open(const std::string& path);
+
+    void close();
+
+    size_t size() const;
+
+    const ReplayMetadata& getMetadata(size_t) const;
+
+    ReplayView getReplay(size_t) const;
+
+    // Indices of all replays whose metadata satisfies the predicate
+    template <typename Pred>
+    std::vector<size_t> filter(Pred&& pred) const
+    {
+        std::vector<size_t> matches;
+        for (size_t index = 0; index < mCount; ++index)
+        {
+            if (pred(mIndex[index].metadata))
+            {
+                matches.push_back(index);
+            }
+        }
+        return matches;
+    }
+
+    // Hands each selected replay to func on a pool of worker threads.
+    // func must be safe to call concurrently
+    template <typename Func>
+    void forEachParallel(const std::vector<size_t>& indices, unsigned nThreads, Func&& func) const
+    {
+        if (nThreads == 0)
+        {
+            nThreads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        std::atomic<size_t> next { 0 };
+        auto worker = [this, &indices, &next, &func]()
+        {
+            for (size_t i = next++; i < indices.size(); i = next++)
+            {
+                func(indices[i], getReplay(indices[i]));
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < nThreads; ++t)
+        {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : workers)
+        {
+            thread.join();
+        }
+    }
+
+private:
+    const uint8_t* mData;
+    size_t mSize;
+    const ReplayIndexEntry* mIndex;
+    size_t mCount;
+
+#ifdef _WIN32
+    // No mmap on Windows - fall back to reading the file into memory
+    std::vector<uint8_t> mBuffer;
+#endif
+};
+
+#endif
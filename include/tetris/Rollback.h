@@ -0,0 +1,75 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "engine/UdpSocket.h"
+#include "tetris/Simulation.h"
+#include <array>
+
+// How many ticks we may run ahead of the last confirmed remote input.
+// Also the size of the snapshot and input ring buffers
+inline constexpr uint32_t ROLLBACK_WINDOW = 64;
+inline constexpr uint32_t ROLLBACK_PACKET_MAGIC = 0x4B425254; // "TRBK"
+inline constexpr size_t ROLLBACK_MAX_PACKET_SIZE = 16 + ROLLBACK_WINDOW;
+
+struct RollbackStats
+{
+    uint32_t rollbacks { 0 };
+    uint32_t resimulatedTicks { 0 };
+    uint32_t maxResimulatedTicks { 0 }; // worst single rollback
+    uint32_t stalls { 0 };
+    uint32_t mispredictions { 0 };
+};
+
+// Two-player versus session with deterministic lockstep plus rollback.
+// Both peers simulate both boards and only exchange inputs. The remote
+// player's input is predicted (held keys carry over), and when the real
+// input arrives late and differs, both boards are restored from the
+// snapshot ring buffer and the missed ticks are simulated again
+class RollbackSession
+{
+public:
+    RollbackSession(std::unordered_map<std::string_view, std::unique_ptr<Texture>>&, uint64_t, size_t, UdpSocket&);
+
+    // Simulate the next tick with this peer's input. Returns false without
+    // simulating if we are too far ahead of the remote peer to keep predicting
+    bool advance(uint8_t);
+
+    // Service the network without simulating a new tick
+    void poll();
+
+    TetrisSimulation& getSimulation(size_t);
+
+    // The next tick that will be simulated
+    uint32_t getTick();
+
+    // Every tick before this one has real inputs from both players
+    uint32_t getConfirmedTick();
+
+    RollbackStats getStats();
+
+private:
+    void receiveInputs();
+    void sendInputs();
+    void rollback();
+    void simulateTick(uint32_t);
+
+    size_t mLocalPlayer;
+    UdpSocket& mSocket;
+    std::array<TetrisSimulation, 2> mSimulations;
+
+    // Ring buffers indexed by tick % ROLLBACK_WINDOW
+    std::array<std::array<GameState, 2>, ROLLBACK_WINDOW> mSnapshots; // state before the tick ran
+    std::array<uint8_t, ROLLBACK_WINDOW> mLocalInputs;
+    std::array<uint8_t, ROLLBACK_WINDOW> mRemoteInputs; // confirmed
+    std::array<uint8_t, ROLLBACK_WINDOW> mRemoteInputsUsed; // what the simulation actually ran with
+
+    uint32_t mTick;
+    uint32_t mRemoteConfirmed; // remote inputs received, contiguous from tick 0
+    uint32_t mRemoteAcked; // local inputs the remote peer has told us it received
+    uint32_t mRollbackFrom;
+    uint8_t mLastRemoteInput;
+
+    RollbackStats mStats;
+};
+
+#endif
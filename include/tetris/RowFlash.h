@@ -0,0 +1,38 @@
+#ifndef ROWFLASH_H
+#define ROWFLASH_H
+
+#include "engine/AnimationScheduler.h"
+#include "engine/Texture.h"
+#include "tetris/GameState.h"
+
+inline constexpr size_t MAX_ROW_FLASHES = 8; // clears flashing at once, per scheduler
+
+// Flashes cleared rows black and white, N_ROW_FLASHES times, one every
+// COMPLETED_ROW_FLASH_INTERVAL_MS. The rows are already gone from the board
+// and the game carries on underneath, this only draws over where they were
+class RowFlash
+{
+public:
+    RowFlash();
+
+    RowFlash(const LineClear&, size_t, int, Uint32);
+
+    // See AnimationScheduler
+    bool advance(Uint32);
+
+    // Cover the rows with the current flash texture
+    void render(Texture*, Texture*) const;
+
+private:
+    int mOffsetX;
+    size_t mCols;
+    LineClear mClear;
+
+    // Where the flashing has got to
+    int mFlashesRemaining;
+    Uint32 mNextFlashTime;
+};
+
+using RowFlashes = AnimationScheduler<RowFlash, MAX_ROW_FLASHES>;
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef SHAREDSTATE_H
+#define SHAREDSTATE_H
+
+// The live state of a running game, published into POSIX shared memory
+// once per tick with tetris_game --publish-state. This header is plain C,
+// so overlays, loggers and bots can read the game without linking
+// anything. See src/state_reader.c for a complete reader:
+//
+//   int fd = shm_open(TETRIS_SHARED_STATE_NAME, O_RDONLY, 0);
+//   const TetrisSharedState* state = mmap(NULL, sizeof(TetrisSharedState), PROT_READ, MAP_SHARED, fd, 0);
+//   TetrisSharedSnapshot snapshot;
+//   if (tetris_shared_state_read(state, &snapshot, 100)) ...
+
+#include <stdint.h>
+#include <string.h>
+
+#define TETRIS_SHARED_STATE_NAME "/tetris_state"
+#define TETRIS_SHARED_STATE_MAGIC 0x4D485354u // "TSHM"
+#define TETRIS_SHARED_STATE_VERSION 1u
+
+#define TETRIS_SHARED_MAX_ROWS 32
+#define TETRIS_SHARED_MAX_COLS 16
+#define TETRIS_SHARED_PIECE_SIZE 4
+
+// Cell colours: 0 is empty, then 1 red, 2 blue, 3 yellow, 4 green,
+// 5 purple, 6 orange, 7 navy, 8 grey, 9 white and 10 black
+typedef struct TetrisSharedSnapshot
+{
+    uint32_t tick; // simulation ticks since the game started
+    uint32_t score;
+    uint8_t playing; // 0 once the game is over
+    uint8_t rows; // size of the board in blocks
+    uint8_t cols;
+    uint8_t reserved0;
+    uint32_t tickMs; // length of a simulation tick
+    uint64_t publishTimeUs; // CLOCK_MONOTONIC when this snapshot was written
+    uint32_t stepTimeUs; // how long simulating this tick took
+    uint32_t blockSize; // pixels per block, positions below are in pixels
+
+    // Occupancy, bit N of a row is set when column N holds a block
+    uint32_t boardRows[TETRIS_SHARED_MAX_ROWS];
+    uint8_t boardCells[TETRIS_SHARED_MAX_ROWS][TETRIS_SHARED_MAX_COLS];
+
+    // The falling piece. Its top left cell is pieceX, pieceY pixels into the board
+    int32_t pieceX;
+    int32_t pieceY;
+    uint8_t pieceRows;
+    uint8_t pieceCols;
+    uint8_t reserved1[2];
+    uint8_t pieceCells[TETRIS_SHARED_PIECE_SIZE][TETRIS_SHARED_PIECE_SIZE];
+} TetrisSharedSnapshot;
+
+typedef struct TetrisSharedState
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t snapshotSize; // sizeof(TetrisSharedSnapshot) of the writer
+    uint32_t sequence; // seqlock: odd while the game is writing the snapshot
+    TetrisSharedSnapshot snapshot;
+} TetrisSharedState;
+
+// Copy a consistent snapshot out of the shared memory. The game never
+// waits for readers, so if it was writing we try again, up to maxAttempts
+// times. Returns 1 on success and 0 if every attempt overlapped a write
+static inline int tetris_shared_state_read(const TetrisSharedState* state, TetrisSharedSnapshot* out, int maxAttempts)
+{
+    int attempt;
+    for (attempt = 0; attempt < maxAttempts; ++attempt)
+    {
+        uint32_t before = __atomic_load_n(&state->sequence, __ATOMIC_ACQUIRE);
+        uint32_t after;
+        if (before & 1u)
+        {
+            continue;
+        }
+        memcpy(out, &state->snapshot, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&state->sequence, __ATOMIC_RELAXED);
+        if (before == after)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif
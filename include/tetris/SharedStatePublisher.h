@@ -0,0 +1,44 @@
+#ifndef SHAREDSTATEPUBLISHER_H
+#define SHAREDSTATEPUBLISHER_H
+
+#include "tetris/GameState.h"
+#include "tetris/SharedState.h"
+#include <string>
+
+static_assert(TETRIS_SHARED_MAX_ROWS == MAX_STATE_ROWS && TETRIS_SHARED_MAX_COLS == MAX_STATE_COLS,
+    "The shared board must hold any board a GameState can");
+static_assert(TETRIS_SHARED_PIECE_SIZE == MAX_TETRONIMO_SIZE);
+
+// Owns a POSIX shared memory segment holding a TetrisSharedState, and
+// writes the game into it under a seqlock. Publishing never blocks on
+// readers, they retry if they overlapped a write. Not available on Windows
+class SharedStatePublisher
+{
+public:
+    SharedStatePublisher();
+
+    // Unmaps and removes the segment
+    ~SharedStatePublisher();
+
+    SharedStatePublisher(const SharedStatePublisher&) = delete;
+    SharedStatePublisher& operator=(const SharedStatePublisher&) = delete;
+
+    // Create the segment, replacing any left over from a previous run
+    bool open(const std::string& name = TETRIS_SHARED_STATE_NAME);
+
+    void close();
+
+    bool isOpen() const;
+
+    // Write a new snapshot, with how long its tick took to simulate
+    void publish(const GameState&, uint32_t stepTimeUs);
+
+    // CLOCK_MONOTONIC, the clock publishTimeUs is measured on
+    static uint64_t nowUs();
+
+private:
+    std::string mName;
+    TetrisSharedState* mState;
+};
+
+#endif
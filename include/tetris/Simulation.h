@@ -0,0 +1,64 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "tetris/CollisionHandler.h"
+#include "tetris/GameState.h"
+#include "tetris/Input.h"
+#include "tetris/Grid.h"
+#include "tetris/TetronimoFactory.h"
+#include "tetris/TexturePalette.h"
+
+// The headless core of a single game of Tetris. Advances in fixed ticks
+// driven only by the seed and the per-tick InputFlags, so two simulations
+// fed the same inputs stay identical. Nothing here touches SDL video
+class TetrisSimulation
+{
+public:
+    TetrisSimulation(std::unordered_map<std::string_view, std::unique_ptr<Texture>>&,
+        uint64_t,
+        AutoShiftSettings = AutoShiftSettings {},
+        BoardSize = BoardSize {});
+
+    // Advance the game by one tick
+    void step(uint8_t);
+
+    // Only for boards that fit in a GameState, see fitsInGameState. Any
+    // other board prints an error and comes back empty
+    GameState snapshot();
+
+    void restore(const GameState&);
+
+    // Hear about new pieces, moves, locks and cleared rows as they happen
+    void setCollisionListener(CollisionListener*);
+
+    // For drawing effects over rows that were just cleared, and under
+    // pieces that were just hard dropped
+    const LineClear& getLastClear() const;
+
+    const HardDrop& getLastDrop() const;
+
+    Grid& getGameBoard();
+
+    Grid& getCurrentTetronimo();
+
+    uint32_t getTick();
+
+    uint32_t getScore();
+
+    bool isPlaying();
+
+private:
+    TexturePalette mPalette;
+    Grid mGameBoard;
+    Grid mCurrentTetronimo;
+    TetronimoFactory mFactory;
+    CollisionHandler mCollisionHandler;
+    AutoShift mAutoShift;
+    CollisionListener* mListener;
+
+    uint32_t mTick;
+    uint32_t mScore;
+    bool mPlaying;
+};
+
+#endif
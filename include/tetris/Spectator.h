@@ -0,0 +1,75 @@
+#ifndef SPECTATOR_H
+#define SPECTATOR_H
+
+#include "engine/BaseEngine.h"
+#include "tetris/Bot.h"
+#include "tetris/ReplayCorpus.h"
+#include "tetris/Simulation.h"
+#include "tetris/TexturePalette.h"
+#include <string>
+#include <vector>
+
+inline constexpr size_t SPECTATOR_DEFAULT_BOARDS = 64;
+inline constexpr int SPECTATOR_BLOCK_SIZE = 6;
+inline constexpr int SPECTATOR_GAP = 6;
+inline constexpr Uint32 SPECTATOR_MAX_CATCH_UP_TICKS = 4; // per frame, after that fall behind real time
+
+struct SpectatorConfig
+{
+    size_t boards { SPECTATOR_DEFAULT_BOARDS };
+    int blockSize { SPECTATOR_BLOCK_SIZE };
+    std::string replayPath; // replays to play back. Bots play if this is empty
+    uint64_t seed { 1 };
+};
+
+// Watch many headless games at once, tiled in one window at a small block
+// size. Each board is drawn as coloured quads in a single SDL_RenderGeometry
+// call, instead of one Texture::render per block
+class SpectatorGameEngine : public BaseEngine
+{
+public:
+    explicit SpectatorGameEngine(const SpectatorConfig&);
+
+private:
+    bool loadMedia() override;
+    bool create() override;
+    bool update() override;
+    bool render() override;
+    void fontReloaded() override;
+
+    void updateInformationBar();
+
+    // Start a new game on a board, with the next replay or a new bot
+    void restartBoard(size_t);
+
+    // Append a quad to mVertices, in spectator pixels
+    void addQuad(float, float, float, float, SDL_Color);
+
+    void addGrid(Grid&, float, float);
+
+    struct Board
+    {
+        std::unique_ptr<TetrisSimulation> simulation;
+        Bot bot;
+        ReplayView replay; // inputs is null when a bot plays
+    };
+
+    SpectatorConfig mConfig;
+    size_t mColumns; // boards per row of tiles
+    ReplayCorpus mReplays;
+    size_t mNextReplay;
+    uint64_t mNextSeed;
+    std::vector<Board> mBoards;
+    uint32_t mGamesFinished;
+    Uint32 mNextTickTime;
+
+    // Reused for every board, sized for a full board in create()
+    TexturePalette mPalette;
+    std::vector<SDL_Vertex> mVertices;
+    std::vector<int> mIndices;
+
+    std::unique_ptr<Texture> mInfoBar;
+    std::string mInfoBarText; // what mInfoBar currently shows
+};
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef SPECTATORSTREAM_H
+#define SPECTATORSTREAM_H
+
+#include "tetris/CollisionHandler.h"
+#include "tetris/Simulation.h"
+#include "tetris/TexturePalette.h"
+#include <cstdint>
+#include <vector>
+
+// A compact stream of one game for spectators. Every tick is one record,
+// most of them a single byte: how the piece moved and whether it rotated.
+// Locks, cleared rows and new pieces are events inside the
+// record. Every so often a keyframe carries the whole board instead, so a
+// consumer can start from the latest keyframe rather than the start of the
+// game. All fields are little endian.
+//
+// Record header bits:
+//   0-1  vertical move: none, VERTICAL_VELOCITY, VERTICAL_FAST_VELOCITY, int16 pixels follow
+//   2-3  horizontal move: none, one block left, one block right, int8 blocks follow
+//   4    the piece rotated clockwise
+//   5    a uint8 event count and the events follow
+//   6    keyframe, the rest of the record is the whole state
+//   7    the game is over
+inline constexpr uint32_t SPECTATOR_KEYFRAME_INTERVAL = 600; // ticks, about ten seconds
+
+enum SpectatorStreamEvent : uint8_t
+{
+    STREAM_EVENT_LOCK = 0, // freeze the piece into the board where it is
+    STREAM_EVENT_CLEAR = 1, // uint16 bottom row, uint8 count, see Grid::moveRowsDown
+    STREAM_EVENT_SPAWN = 2, // a new piece, see writePiece
+};
+
+// Turns a simulation into a stream, one record per tick. Listens to the
+// simulation's CollisionHandler while it exists, so only one encoder can
+// follow a simulation at a time
+class SpectatorStreamEncoder : public CollisionListener
+{
+public:
+    SpectatorStreamEncoder(TetrisSimulation&,
+        std::unordered_map<std::string_view, std::unique_ptr<Texture>>&,
+        uint32_t = SPECTATOR_KEYFRAME_INTERVAL);
+
+    ~SpectatorStreamEncoder() override;
+
+    SpectatorStreamEncoder(const SpectatorStreamEncoder&) = delete;
+    SpectatorStreamEncoder& operator=(const SpectatorStreamEncoder&) = delete;
+
+    // Append the record for the tick the simulation just stepped. The first
+    // record is a keyframe, and so is any record after the simulation jumped
+    void encodeTick(std::vector<uint8_t>&);
+
+    // The latest keyframe and every record after it: all a spectator who
+    // joins now needs to catch up
+    const std::vector<uint8_t>& getCatchUp() const;
+
+private:
+    void pieceRotated() override;
+    void pieceLocked() override;
+    void rowsCleared(size_t, size_t) override;
+
+    void writeKeyframe(std::vector<uint8_t>&);
+    void writePiece(std::vector<uint8_t>&);
+    void rememberPiece();
+
+    TetrisSimulation& mSimulation;
+    TexturePalette mPalette;
+    uint32_t mKeyframeInterval;
+    uint32_t mTicksSinceKeyframe;
+    std::vector<uint8_t> mCatchUp;
+
+    // What the last record left the spectator with
+    bool mStarted;
+    uint32_t mLastTick;
+    int mLastPosX;
+    int mLastPosY;
+
+    // Collected from the CollisionHandler during the current tick
+    std::vector<uint8_t> mEvents;
+    uint8_t mEventCount;
+    bool mRotated;
+    bool mLocked;
+    int mLockPosX; // where the piece was when it locked
+    int mLockPosY;
+};
+
+// Rebuilds the board and the piece from a stream
+class SpectatorStreamDecoder
+{
+public:
+    explicit SpectatorStreamDecoder(std::unordered_map<std::string_view, std::unique_ptr<Texture>>&);
+
+    // Apply the next record. Returns how many bytes it took, or 0 if the
+    // buffer does not hold a whole valid record. Records before the first
+    // keyframe are skipped over
+    size_t decode(const uint8_t*, size_t);
+
+    // Decode records until the buffer runs out. Returns the bytes used
+    size_t decodeAll(const uint8_t*, size_t);
+
+    // A keyframe has been seen, so the board and piece are real
+    bool isSynced() const;
+
+    Grid& getBoard();
+
+    Grid& getPiece();
+
+    uint32_t getTick() const;
+
+    uint32_t getScore() const;
+
+    bool isPlaying() const;
+
+    // The rows cleared most recently, counted since this decoder started
+    const LineClear& getLastClear() const;
+
+private:
+    class Reader;
+
+    bool readRecord(Reader&, bool);
+    bool readKeyframe(Reader&, bool);
+    bool readPiece(Reader&, bool);
+
+    TexturePalette mPalette;
+    Grid mBoard;
+    Grid mPiece;
+    bool mSynced;
+    uint32_t mTick;
+    uint32_t mScore;
+    bool mPlaying;
+    LineClear mLastClear;
+};
+
+#endif
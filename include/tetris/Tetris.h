@@ -1,34 +1,102 @@
 #ifndef TETRIS_H
 #define TETRIS_H
 
-#include "tetris/CollisionHandler.h"
 #include "engine/BaseEngine.h"
-#include "tetris/Grid.h"
-#include "tetris/TetronimoFactory.h"
-#include <sstream>
+#include "engine/SpscQueue.h"
+#include "engine/TripleBuffer.h"
+#include "tetris/GameEventLog.h"
+#include "tetris/Input.h"
+#include "tetris/ParticleEffects.h"
+#include "tetris/RowFlash.h"
+#include "tetris/SharedStatePublisher.h"
+#include "tetris/Simulation.h"
+#include <mutex>
+#include <string>
+
+inline constexpr size_t INPUT_QUEUE_SIZE = 256;
+
+// An input event and the tick that consumed it, for latency measurement
+struct ConsumedInput
+{
+    uint32_t timestamp;
+    uint32_t tick;
+};
 
 class TetrisGameEngine : public BaseEngine
 {
 public:
-    TetrisGameEngine(); 
+    // The board is drawn from GameState snapshots, so it has to fit in one.
+    // With a shared memory name, every tick is also published there. With
+    // an event log path, gameplay events and frame times are logged there
+    explicit TetrisGameEngine(AutoShiftSettings = AutoShiftSettings {},
+        BoardSize = BoardSize {},
+        const std::string& = {},
+        const std::string& = {});
+
+    // Copy the whole game in and out of a flat, trivially copyable struct.
+    // A restored state is drawn from the next frame
+    GameState snapshot();
+    void restore(const GameState&);
 
 private:
     bool loadMedia() override;
     bool create() override;
     bool update() override;
     bool render() override;
+    void fontReloaded() override;
+    bool simulate() override;
+
+    // Updates the information bar texture text. Returns false if the text didn't change
+    bool updateInformationBar();
+
+    // Moves inputs consumed before the given tick into mInputsOnScreen
+    void collectInputsOnScreen(uint32_t);
+
+    AutoShiftSettings mAutoShift;
+    BoardSize mBoardSize;
+
+    // Owned by the simulation thread
+    std::unique_ptr<TetrisSimulation> mSimulation;
+    KeyboardInput mKeyboard;
+    std::mutex mSimulationMutex; // only contended by snapshot() / restore()
+
+    // Main thread -> simulation thread
+    SpscQueue<InputEvent, INPUT_QUEUE_SIZE> mInputQueue;
+
+    // Simulation thread -> main thread, only used with --latency. An input
+    // is on screen once a render state from after its tick gets drawn
+    SpscQueue<ConsumedInput, INPUT_QUEUE_SIZE> mConsumedInputs;
+    ConsumedInput mNextConsumedInput;
+    bool mHasNextConsumedInput;
+
+    // Simulation thread -> main thread. render() draws the latest published state
+    TripleBuffer<GameState> mRenderStates;
+    bool mFinalStatePublished; // the game is over and the renderer has the last state
+    TexturePalette mPalette;
+
+    // Effects drawn over the board, main thread only
+    RowFlashes mRowFlashes;
+    uint32_t mLastClears; // LineClear::clears of the last state drawn
+    Texture* mWhiteFlashTexture;
+    Texture* mBlackFlashTexture;
+    ParticleEffects mParticles;
+    uint32_t mLastDrops; // HardDrop::drops of the last state drawn
+    Uint32 mLastParticleTicks;
 
-    // Updates the information bar texture text
-    void updateInformationBar();
+    // Simulation thread -> other processes, with --publish-state
+    std::string mSharedStateName;
+    SharedStatePublisher mSharedState;
 
-    Grid mCurrentTetronimo;
-    Grid mGameBoard;
-    TetronimoFactory mFactory;
-    CollisionHandler mCollisionHandler;
+    // Both threads -> a file, with --event-log. The logger listens to the
+    // simulation, so it is declared after it and goes first
+    std::string mEventLogPath;
+    std::unique_ptr<EventLog> mEventLog;
+    std::unique_ptr<GameEventLogger> mEventLogger;
+    uint64_t mLastFrameUs;
 
     // A text texture displaying FPS, score, etc
     std::unique_ptr<Texture> mInfoBar;
-    std::stringstream mInfoText;
+    std::string mInfoBarText; // what mInfoBar currently shows
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -12,13 +12,26 @@ class TetronimoFactory
 public:
     TetronimoFactory(std::unordered_map<std::string_view, std::unique_ptr<Texture>>&);
 
+    // Pieces spawn at the given X, by default in the middle of a default sized board
+    TetronimoFactory(std::unordered_map<std::string_view, std::unique_ptr<Texture>>&, uint64_t, int = TETRONIMO_START_X);
+
     Grid getNextTetronimo();
 
+    // Same, but reuses the storage of an existing Grid instead of allocating
+    void getNextTetronimo(Grid&);
+
+    // The generator state is a single word so it can live in a GameState
+    uint64_t getState();
+
+    void setState(uint64_t);
+
+    // A fresh, non-deterministic seed for games that aren't being replayed
+    static uint64_t randomSeed();
+
 private:
-    void setup();
-    std::mt19937 mGen; // Mersenne Twister generator
-    std::uniform_int_distribution<> mDis; // Uniform distribution
-    const int mTetronimoStartX { TETRONIMO_START_X };
+    int nextRandom(int);
+    uint64_t mState; // SplitMix64 generator state
+    const int mTetronimoStartX;
     const int mTetronimoStartY { TETRONIMO_START_Y };
     std::unordered_map<std::string_view, std::unique_ptr<Texture>>& mTextures;
 };
@@ -0,0 +1,63 @@
+#ifndef TEXTUREPALETTE_H
+#define TEXTUREPALETTE_H
+
+#include "engine/Texture.h"
+#include "tetris/Constants.h"
+#include "tetris/GameState.h"
+#include <array>
+#include <memory>
+#include <unordered_map>
+
+// Maps the block textures to small integer indices, so a Block can be
+// stored as a single byte in a GameState. Index 0 is always "no block"
+inline constexpr std::array<std::string_view, 10> PALETTE_TEXTURES {
+    BLOCK_TEXTURE_RED,
+    BLOCK_TEXTURE_BLUE,
+    BLOCK_TEXTURE_YELLOW,
+    BLOCK_TEXTURE_GREEN,
+    BLOCK_TEXTURE_PURPLE,
+    BLOCK_TEXTURE_ORANGE,
+    BLOCK_TEXTURE_NAVY,
+    BLOCK_TEXTURE_GREY,
+    BLOCK_TEXTURE_WHITE,
+    BLOCK_TEXTURE_BLACK,
+};
+
+// A blank Texture for every palette entry. Enough for a simulation that is
+// never drawn, e.g. on a server, in a tool or in tests
+std::unordered_map<std::string_view, std::unique_ptr<Texture>> makeHeadlessTextures();
+
+class TexturePalette
+{
+public:
+    TexturePalette();
+
+    TexturePalette(std::unordered_map<std::string_view, std::unique_ptr<Texture>>&);
+
+    uint8_t indexOf(Texture*) const;
+
+    Texture* at(uint8_t) const;
+
+    // Draw the blocks of a flattened Grid
+    template <size_t Rows, size_t Cols>
+    void render(const GridState<Rows, Cols>& state, int offsetX = 0, int offsetY = 0) const
+    {
+        for (size_t yIndex = 0; yIndex < state.rows; ++yIndex)
+        {
+            for (size_t xIndex = 0; xIndex < state.cols; ++xIndex)
+            {
+                Texture* texture = at(state.cells[yIndex][xIndex]);
+                if (texture != nullptr)
+                {
+                    texture->render(offsetX + state.posX + static_cast<int>(xIndex) * BLOCK_SIZE,
+                        offsetY + state.posY + static_cast<int>(yIndex) * BLOCK_SIZE);
+                }
+            }
+        }
+    }
+
+private:
+    std::array<Texture*, PALETTE_TEXTURES.size() + 1> mTextures;
+};
+
+#endif
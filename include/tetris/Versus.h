@@ -0,0 +1,62 @@
+#ifndef VERSUS_H
+#define VERSUS_H
+
+#include "engine/BaseEngine.h"
+#include "engine/UdpSocket.h"
+#include "tetris/Input.h"
+#include "tetris/Rollback.h"
+#include "tetris/RowFlash.h"
+#include <array>
+#include <string>
+#include <vector>
+
+inline constexpr int VERSUS_GAP = BLOCK_SIZE;
+inline constexpr uint64_t VERSUS_DEFAULT_SEED = 0x5EED;
+
+// Settings for a two player game over UDP
+struct VersusConfig
+{
+    size_t localPlayer { 0 };
+    uint16_t localPort { 0 };
+    uint16_t remotePort { 0 };
+    std::string remoteAddress { "127.0.0.1" };
+    uint64_t seed { VERSUS_DEFAULT_SEED };
+
+    // Injected network conditions, for testing locally
+    uint32_t latencyMs { 0 };
+    uint32_t jitterMs { 0 };
+    double lossRate { 0.0 };
+};
+
+// Two boards side by side. The local player is driven by the keyboard,
+// the other by a remote peer through a RollbackSession
+class VersusGameEngine : public BaseEngine
+{
+public:
+    VersusGameEngine(const VersusConfig&);
+
+private:
+    bool loadMedia() override;
+    bool create() override;
+    bool update() override;
+    bool render() override;
+    void fontReloaded() override;
+
+    void updateInformationBar();
+
+    VersusConfig mConfig;
+    UdpSocket mSocket;
+    std::unique_ptr<RollbackSession> mSession;
+    KeyboardInput mKeyboard;
+    std::vector<Uint32> mPendingInputs; // timestamps of inputs no tick has consumed yet
+    Uint32 mNextTickTime;
+
+    // Effects drawn over both boards
+    RowFlashes mRowFlashes;
+    std::array<uint32_t, 2> mLastClears; // LineClear::clears of each board when last drawn
+
+    std::unique_ptr<Texture> mInfoBar;
+    std::string mInfoBarText; // what mInfoBar currently shows
+};
+
+#endif
@@ -0,0 +1,136 @@
+#include "engine/AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+// Replacements for the global allocation functions that count every
+// call. A thread_local of trivial type needs no allocation itself
+namespace
+{
+thread_local AllocationCounts gCounts {};
+
+void* countedAllocate(std::size_t size)
+{
+    gCounts.allocations++;
+    gCounts.bytes += size;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* countedAllocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    gCounts.allocations++;
+    gCounts.bytes += size;
+    auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    void* memory { nullptr };
+    return (posix_memalign(&memory, align < sizeof(void*) ? sizeof(void*) : align, size == 0 ? 1 : size) == 0) ? memory : nullptr;
+#endif
+}
+
+void countedFree(void* memory)
+{
+    if (memory != nullptr)
+    {
+        gCounts.deallocations++;
+        std::free(memory);
+    }
+}
+
+void countedFreeAligned(void* memory)
+{
+    if (memory != nullptr)
+    {
+        gCounts.deallocations++;
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+}
+
+void* orThrow(void* memory)
+{
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc {};
+    }
+    return memory;
+}
+}
+
+AllocationCounts AllocationCounter::thisThread()
+{
+    return gCounts;
+}
+
+void* operator new(std::size_t size)
+{
+    return orThrow(countedAllocate(size));
+}
+
+void* operator new[](std::size_t size)
+{
+    return orThrow(countedAllocate(size));
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return countedAllocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return orThrow(countedAllocateAligned(size, alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return orThrow(countedAllocateAligned(size, alignment));
+}
+
+void operator delete(void* memory) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    countedFree(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    countedFreeAligned(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+    countedFreeAligned(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept
+{
+    countedFreeAligned(memory);
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept
+{
+    countedFreeAligned(memory);
+}
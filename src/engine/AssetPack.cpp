@@ -0,0 +1,16 @@
+#include "engine/AssetPack.h"
+
+bool AssetPack::find(std::string_view name, const void*& data, size_t& size)
+{
+    // Only a dozen entries, a linear search is fine
+    for (size_t index = 0; index < EMBEDDED_ASSET_COUNT; ++index)
+    {
+        if (name == EMBEDDED_ASSETS[index].name)
+        {
+            data = EMBEDDED_ASSET_BLOB + EMBEDDED_ASSETS[index].offset;
+            size = EMBEDDED_ASSETS[index].size;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,93 @@
+#include "engine/AssetWatcher.h"
+#include <algorithm>
+#include <cstdio>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+AssetWatcher::AssetWatcher()
+    : mFd { -1 }
+    , mWatch { -1 }
+{
+}
+
+AssetWatcher::~AssetWatcher()
+{
+    close();
+}
+
+#ifdef __linux__
+bool AssetWatcher::open(const std::string& directory)
+{
+    close();
+    mFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mFd < 0)
+    {
+        printf("Unable to start inotify!\n");
+        return false;
+    }
+
+    // Editors either write the file in place or write a temporary and rename it over
+    mWatch = inotify_add_watch(mFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (mWatch < 0)
+    {
+        printf("Unable to watch %s!\n", directory.c_str());
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetWatcher::close()
+{
+    if (mFd >= 0)
+    {
+        ::close(mFd);
+    }
+    mFd = -1;
+    mWatch = -1;
+}
+
+void AssetWatcher::poll(std::vector<std::string>& changed)
+{
+    if (mFd < 0)
+    {
+        return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t length;
+    while ((length = read(mFd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char* cursor = buffer; cursor < buffer + length;)
+        {
+            auto* event = reinterpret_cast<inotify_event*>(cursor);
+            if (event->len > 0)
+            {
+                std::string name { event->name };
+                if (std::find(changed.begin(), changed.end(), name) == changed.end())
+                {
+                    changed.push_back(name);
+                }
+            }
+            cursor += sizeof(inotify_event) + event->len;
+        }
+    }
+}
+#else
+bool AssetWatcher::open(const std::string& directory)
+{
+    printf("Watching %s for changes is only supported on Linux!\n", directory.c_str());
+    return false;
+}
+
+void AssetWatcher::close()
+{
+}
+
+void AssetWatcher::poll(std::vector<std::string>&)
+{
+}
+#endif
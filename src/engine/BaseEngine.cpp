@@ -1,17 +1,48 @@
 #include <iostream>
 
+#include "engine/AllocationCounter.h"
+#include "engine/AssetPack.h"
 #include "engine/BaseEngine.h"
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdlib>
 #include <memory>
+#include <thread>
 
 BaseEngine::BaseEngine(const int screenHeight, const int screenWidth)
     : mScreenHeight { screenHeight }
     , mScreenWidth { screenWidth }
     , mWindow { nullptr }
     , mRenderer { nullptr }
+    , mHeadless { false }
+    , mFrame { nullptr }
+    , mHeadlessTicks { 0 }
     , mFont { nullptr }
+    , mLoader {}
+    , mPendingTextures {}
+    , mHotReload { false }
+    , mWatcher {}
+    , mChangedAssets {}
+    , mPendingReloads {}
+    , mFontName {}
+    , mFontData {}
+    , mPendingFont {}
+    , mStartTime {}
+    , mFirstFrameShown { false }
+    , mGameFrameShown { false }
     , mQuit { false }
     , mPlaying { true }
+    , mSimulationTickMs { 0 }
+    , mMeasureLatency { false }
+    , mLatency {}
+    , mInputsOnScreen {}
+    , mFrameArena {}
+    , mCheckFrameAllocations { true }
+    , mCapture {}
+    , mRecordSeconds { 0 }
+    , mMeasureCpu { false }
+    , mCpuMeter {}
     , mElapsedTime { 0 }
     , mFrameCount { 0 }
     , mScore { 0 }
@@ -21,6 +52,11 @@ BaseEngine::BaseEngine(const int screenHeight, const int screenWidth)
 
 BaseEngine::~BaseEngine()
 {
+    // run() closes down when it returns, headless engines are closed here
+    if (mHeadless)
+    {
+        close();
+    }
 }
 
 bool BaseEngine::init()
@@ -28,21 +64,41 @@ bool BaseEngine::init()
     // Initialization flag
     bool success = true;
 
+    // No display is needed headless, e.g. on CI. An SDL_VIDEODRIVER
+    // already in the environment (say offscreen) is left alone
+    if (mHeadless)
+    {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    }
+
     // Initialize SDL
     printf("Initialising SDL\n");
     if (SDL_Init(SDL_INIT_VIDEO) < 0)
     {
         printf("SDL could not initialize! SDL Error: %s\n", SDL_GetError());
-        success = false;
+        return false;
     }
-    else
+
+    // Set texture filtering to linear
+    if (!SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1"))
+    {
+        printf("Warning: Linear texture filtering not enabled!");
+    }
+
+    if (mHeadless)
     {
-        // Set texture filtering to linear
-        if (!SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1"))
+        // The software renderer draws straight into a surface we can read back
+        printf("Creating headless software renderer\n");
+        mFrame = Framebuffer::create(mScreenWidth, mScreenHeight);
+        if (mFrame == NULL)
         {
-            printf("Warning: Linear texture filtering not enabled!");
+            printf("Frame surface could not be created! SDL Error: %s\n", SDL_GetError());
+            return false;
         }
-
+        mRenderer.reset(SDL_CreateSoftwareRenderer(mFrame.get()));
+    }
+    else
+    {
         // Create window
         printf("Creating SDL window\n");
         mWindow.reset(SDL_CreateWindow("Tetris",
@@ -54,45 +110,41 @@ bool BaseEngine::init()
         if (mWindow == NULL)
         {
             printf("Window could not be created! SDL Error: %s\n", SDL_GetError());
-            success = false;
+            return false;
         }
-        else
-        {
-            // Create vsynced renderer for window
-            printf("Creating SDL renderer\n");
-            mRenderer.reset(SDL_CreateRenderer(
-                mWindow.get(), -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC));
-            if (mRenderer == NULL)
-            {
-                printf("Renderer could not be created! SDL Error: %s\n",
-                    SDL_GetError());
-                success = false;
-            }
-            else
-            {
-                // Initialize renderer color
-                SDL_SetRenderDrawColor(mRenderer.get(), 0xFF, 0xFF, 0xFF, 0xFF);
 
-                // Initialize PNG loading
-                printf("Initialising SDL Image\n");
-                int imgFlags = IMG_INIT_PNG;
-                if (!(IMG_Init(imgFlags) & imgFlags))
-                {
-                    printf("SDL_image could not initialize! SDL_image Error: %s\n",
-                        IMG_GetError());
-                    success = false;
-                }
+        // Create vsynced renderer for window
+        printf("Creating SDL renderer\n");
+        mRenderer.reset(SDL_CreateRenderer(
+            mWindow.get(), -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC));
+    }
+    if (mRenderer == NULL)
+    {
+        printf("Renderer could not be created! SDL Error: %s\n",
+            SDL_GetError());
+        return false;
+    }
 
-                // Initialize SDL_ttf
-                printf("Initialising SDL TTF\n");
-                if (TTF_Init() == -1)
-                {
-                    printf("SDL_ttf could not initialize! SDL_ttf Error: %s\n",
-                        TTF_GetError());
-                    success = false;
-                }
-            }
-        }
+    // Initialize renderer color
+    SDL_SetRenderDrawColor(mRenderer.get(), 0xFF, 0xFF, 0xFF, 0xFF);
+
+    // Initialize PNG loading
+    printf("Initialising SDL Image\n");
+    int imgFlags = IMG_INIT_PNG;
+    if (!(IMG_Init(imgFlags) & imgFlags))
+    {
+        printf("SDL_image could not initialize! SDL_image Error: %s\n",
+            IMG_GetError());
+        success = false;
+    }
+
+    // Initialize SDL_ttf
+    printf("Initialising SDL TTF\n");
+    if (TTF_Init() == -1)
+    {
+        printf("SDL_ttf could not initialize! SDL_ttf Error: %s\n",
+            TTF_GetError());
+        success = false;
     }
 
     return success;
@@ -110,22 +162,224 @@ bool BaseEngine::loadTexture(const std::string_view fileName)
     }
     else
     {
+        // Decode on the loader threads. The texture is uploaded by finishLoading(),
+        // but it exists from now on so create() can already hold on to it
+        if (!mLoader)
+        {
+            mLoader = std::make_unique<ThreadPool>();
+        }
         mTextures.emplace(fileName, std::make_unique<Texture>(mRenderer.get()));
-        if (!mTextures.at(fileName)->loadFromFile(filePath))
+        mPendingTextures.push_back(PendingTexture { mTextures.at(fileName).get(),
+            filePath,
+            mLoader->submit([fileName, filePath]()
+                {
+                    // Prefer the copy compiled into the binary, fall back to the assets directory
+                    const void* data { nullptr };
+                    size_t size { 0 };
+                    return AssetPack::find(fileName, data, size)
+                        ? Texture::decodeMemory(data, size, std::string(fileName))
+                        : Texture::decodeFile(filePath);
+                }) });
+    }
+    return success;
+}
+
+bool BaseEngine::finishLoading()
+{
+    bool success = true;
+    size_t uploaded = 0;
+    while (uploaded < mPendingTextures.size() && !mQuit)
+    {
+        // Sleep until the next image is decoded, or for a frame to keep the
+        // window responsive, rather than spinning on the decoders' core
+        auto next = std::find_if(mPendingTextures.begin(), mPendingTextures.end(),
+            [](const PendingTexture& pending)
+            {
+                return pending.surface.valid();
+            });
+        next->surface.wait_for(std::chrono::milliseconds(LOADING_FRAME_MS));
+
+        while (SDL_PollEvent(&mEvent) != 0)
         {
-            printf("Failed to load %s image!\n", filePath.c_str());
-            success = false;
+            if (mEvent.type == SDL_QUIT)
+            {
+                mQuit = true;
+            }
+        }
+
+        // Only the main thread may talk to the renderer, so uploads happen here
+        for (auto& pending : mPendingTextures)
+        {
+            if (pending.surface.valid() && pending.surface.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                SDL_Surface* surface = pending.surface.get();
+                if (surface == NULL || !pending.texture->loadFromSurface(surface, pending.name))
+                {
+                    printf("Failed to load %s image!\n", pending.name.c_str());
+                    success = false;
+                }
+                uploaded++;
+            }
+        }
+        renderLoadingScreen(uploaded, mPendingTextures.size());
+    }
+
+    // Closed while loading. The run loop ends before anything is drawn, so
+    // only the images still decoding need freeing
+    for (auto& pending : mPendingTextures)
+    {
+        if (pending.surface.valid())
+        {
+            SDL_FreeSurface(pending.surface.get());
         }
     }
+    mPendingTextures.clear();
+    mLoader.reset();
     return success;
 }
 
+void BaseEngine::renderLoadingScreen(size_t loaded, size_t total)
+{
+    SDL_SetRenderDrawColor(mRenderer.get(), 0xFF, 0xFF, 0xFF, 0xFF);
+    SDL_RenderClear(mRenderer.get());
+
+    // Progress bar across the middle of the window
+    int barWidth = mScreenWidth / 2;
+    SDL_Rect outline { (mScreenWidth - barWidth) / 2, (mScreenHeight - LOADING_BAR_HEIGHT) / 2, barWidth, LOADING_BAR_HEIGHT };
+    SDL_Rect filled { outline.x, outline.y, static_cast<int>(barWidth * loaded / std::max<size_t>(total, 1)), LOADING_BAR_HEIGHT };
+    SDL_SetRenderDrawColor(mRenderer.get(), 0xC8, 0xC8, 0xC8, 0xFF);
+    SDL_RenderFillRect(mRenderer.get(), &filled);
+    SDL_SetRenderDrawColor(mRenderer.get(), 0x00, 0x00, 0x00, 0xFF);
+    SDL_RenderDrawRect(mRenderer.get(), &outline);
+
+    SDL_RenderPresent(mRenderer.get());
+    if (!mFirstFrameShown)
+    {
+        mFirstFrameShown = true;
+        printf("First loading frame after %lld ms\n", static_cast<long long>(millisecondsSinceStart()));
+    }
+}
+
+bool BaseEngine::reloadChangedAssets()
+{
+    // Start decoding whatever changed since last frame
+    mChangedAssets.clear();
+    mWatcher.poll(mChangedAssets);
+    for (const auto& name : mChangedAssets)
+    {
+        std::string path { std::string(ASSETS_DIR) + "/" + name };
+        if (!mLoader)
+        {
+            mLoader = std::make_unique<ThreadPool>(1);
+        }
+
+        auto texture = mTextures.find(name);
+        if (texture != mTextures.end())
+        {
+            printf("Reloading %s\n", name.c_str());
+            mPendingReloads.push_back(PendingTexture { texture->second.get(),
+                path,
+                mLoader->submit([path]()
+                    {
+                        return Texture::decodeFile(path);
+                    }) });
+        }
+        else if (name == mFontName)
+        {
+            // SDL_ttf isn't safe to use from two threads, so only read the file in the background
+            printf("Reloading %s\n", name.c_str());
+            mPendingFont = mLoader->submit([path]()
+                {
+                    std::vector<char> data;
+                    if (FILE* file = fopen(path.c_str(), "rb"))
+                    {
+                        char buffer[4096];
+                        size_t read;
+                        while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+                        {
+                            data.insert(data.end(), buffer, buffer + read);
+                        }
+                        fclose(file);
+                    }
+                    return data;
+                });
+        }
+    }
+
+    // Swap in anything that has finished, never waiting on the rest.
+    // A file caught halfway through being saved just keeps the old version
+    bool reloaded = false;
+    auto ready = [](auto& future)
+    {
+        return future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    };
+    for (auto& pending : mPendingReloads)
+    {
+        if (ready(pending.surface))
+        {
+            reloaded = true;
+            SDL_Surface* surface = pending.surface.get();
+            if (surface == NULL || !pending.texture->loadFromSurface(surface, pending.name))
+            {
+                printf("Failed to reload %s, keeping the old texture\n", pending.name.c_str());
+            }
+        }
+    }
+    mPendingReloads.erase(std::remove_if(mPendingReloads.begin(), mPendingReloads.end(),
+                              [](const PendingTexture& pending)
+                              {
+                                  return !pending.surface.valid();
+                              }),
+        mPendingReloads.end());
+
+    if (ready(mPendingFont))
+    {
+        std::vector<char> data = mPendingFont.get();
+        TTF_Font* font = data.empty()
+            ? NULL
+            : TTF_OpenFontRW(SDL_RWFromConstMem(data.data(), static_cast<int>(data.size())), 1, FONT_SIZE);
+        if (font == NULL)
+        {
+            printf("Failed to reload font, keeping the old one\n");
+        }
+        else
+        {
+            // The old font is closed before the data it was reading from goes away
+            mFont.reset(font);
+            mFontData = std::move(data);
+            fontReloaded();
+            reloaded = true;
+        }
+    }
+    return reloaded;
+}
+
+void BaseEngine::fontReloaded()
+{
+}
+
+long long BaseEngine::millisecondsSinceStart()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mStartTime).count();
+}
+
 bool BaseEngine::loadFont(const std::string_view fileName)
 {
     bool success { true };
     std::string fontPath { std::string(ASSETS_DIR) + "/" + std::string(fileName) };
     printf("Loading %s\n", std::string(fileName).c_str());
-    mFont.reset(TTF_OpenFont(fontPath.c_str(), FONT_SIZE));
+    mFontName = fileName;
+    const void* data { nullptr };
+    size_t size { 0 };
+    if (AssetPack::find(fileName, data, size))
+    {
+        // The embedded data lives as long as the program, so SDL_ttf can keep reading it
+        mFont.reset(TTF_OpenFontRW(SDL_RWFromConstMem(data, static_cast<int>(size)), 1, FONT_SIZE));
+    }
+    else
+    {
+        mFont.reset(TTF_OpenFont(fontPath.c_str(), FONT_SIZE));
+    }
     if (mFont == NULL)
     {
         printf("Failed to load font! SDL_ttf Error: %s\n", TTF_GetError());
@@ -135,12 +389,134 @@ bool BaseEngine::loadFont(const std::string_view fileName)
 }
 
 
+bool BaseEngine::isIdle()
+{
+    return !mPlaying;
+}
+
+bool BaseEngine::simulate()
+{
+    return true;
+}
+
+void BaseEngine::simulationLoop()
+{
+    auto tick = std::chrono::milliseconds(mSimulationTickMs);
+    auto nextTick = std::chrono::steady_clock::now();
+    while (!mQuit)
+    {
+        simulate();
+
+        // Catch up if we fall a little behind, but don't spin through a
+        // huge backlog after a long stall (e.g. a debugger break)
+        nextTick += tick;
+        auto now = std::chrono::steady_clock::now();
+        if (now - nextTick > 10 * tick)
+        {
+            nextTick = now;
+        }
+        std::this_thread::sleep_until(nextTick);
+    }
+}
+
+bool BaseEngine::drawFrame()
+{
+    // Clear screen
+    SDL_SetRenderDrawColor(mRenderer.get(), 0xFF, 0xFF, 0xFF, 0xFF);
+    SDL_RenderClear(mRenderer.get());
+
+    // Draw the information box
+    SDL_SetRenderDrawColor(mRenderer.get(),
+        BACKGROUND_COLOUR.r,
+        BACKGROUND_COLOUR.g,
+        BACKGROUND_COLOUR.b,
+        BACKGROUND_COLOUR.a);
+    SDL_Rect infoBoxRect {
+        0, mScreenHeight - BOTTOM_BAR_HEIGHT, mScreenWidth, BOTTOM_BAR_HEIGHT
+    };
+    SDL_RenderFillRect(mRenderer.get(), &infoBoxRect);
+
+    // Render game state objects
+    render();
+
+    // Read back before presenting, afterwards the back buffer is undefined
+    bool captured = mCapture.capture(mRenderer.get(), getTicks());
+
+    // Update screen
+    SDL_RenderPresent(mRenderer.get());
+    return captured;
+}
+
+void BaseEngine::handleCaptureKeys(const SDL_Event& event)
+{
+    if (event.type != SDL_KEYDOWN || event.key.repeat != 0)
+    {
+        return;
+    }
+    if (event.key.keysym.sym == SDLK_F12)
+    {
+        mCapture.requestScreenshot();
+    }
+    else if (event.key.keysym.sym == SDLK_F11)
+    {
+        mCapture.requestClip();
+    }
+}
+
+bool BaseEngine::startHeadless()
+{
+    mStartTime = std::chrono::steady_clock::now();
+    mHeadless = true;
+    if (!init())
+    {
+        printf("Failed to initialize headless!\n");
+        return false;
+    }
+    bool loaded = loadMedia() && loadFont(FONT_ARIAL);
+    loaded = finishLoading() && loaded;
+    if (!loaded)
+    {
+        printf("Failed to load media!\n");
+        return false;
+    }
+    mElapsedTime = getTicks();
+    return create();
+}
+
+bool BaseEngine::drawHeadlessFrame(Uint32 elapsedMs)
+{
+    if (mFrame == nullptr)
+    {
+        return false;
+    }
+    mHeadlessTicks += elapsedMs;
+    mFrameArena.reset();
+    update();
+    drawFrame();
+    mFrameCount++;
+    return true;
+}
+
+Uint32 BaseEngine::getTicks() const
+{
+    return mHeadless ? mHeadlessTicks : SDL_GetTicks();
+}
+
+const SDL_Surface* BaseEngine::getFrame() const
+{
+    return mFrame.get();
+}
+
 void BaseEngine::close()
 {
+    // Finish writing any captures still queued
+    mCapture.close();
+
     // Free resrources
     mTextures.clear();
     mFont.reset();
     mRenderer.reset();
+    mFrame.reset();
     mWindow.reset();
 
     // Quit SDL subsystems
@@ -151,6 +527,28 @@ void BaseEngine::close()
 
 int BaseEngine::run(int argc, char* args[])
 {
+    mStartTime = std::chrono::steady_clock::now();
+    for (int index = 1; index < argc; ++index)
+    {
+        if (std::string(args[index]) == "--latency")
+        {
+            mMeasureLatency = true;
+        }
+        else if (std::string(args[index]) == "--hot-reload")
+        {
+            mHotReload = true;
+        }
+        else if (std::string(args[index]) == "--cpu-usage")
+        {
+            mMeasureCpu = true;
+        }
+        else if (std::string(args[index]) == "--record")
+        {
+            bool timed = index + 1 < argc && args[index + 1][0] != '-';
+            mRecordSeconds = timed ? static_cast<Uint32>(std::strtoul(args[++index], nullptr, 10)) : DEFAULT_RECORD_SECONDS;
+        }
+    }
+
     // Start up SDL and create window
     printf("Initialising engine\n");
     if (!init())
@@ -159,9 +557,12 @@ int BaseEngine::run(int argc, char* args[])
     }
     else
     {
-        // Load media
+        // Load media. Images decode in the background while the font loads
         printf("Loading media\n");
-        if (!loadMedia() || !loadFont(FONT_ARIAL))
+        bool loaded = loadMedia() && loadFont(FONT_ARIAL);
+        loaded = finishLoading() && loaded;
+        printf("Media loaded after %lld ms\n", static_cast<long long>(millisecondsSinceStart()));
+        if (!loaded)
         {
             printf("Failed to load media!\n");
         }
@@ -173,42 +574,111 @@ int BaseEngine::run(int argc, char* args[])
             printf("Creating game state objects\n");
             create();
 
+            if (!mCapture.open(mScreenWidth, mScreenHeight, mRecordSeconds))
+            {
+                printf("Screenshots and recording are unavailable\n");
+            }
+
+            if (mHotReload && mWatcher.open(ASSETS_DIR))
+            {
+                printf("Watching %s for changes\n", ASSETS_DIR);
+            }
+
+            // Fixed rate simulation gets its own thread, so it never waits on vsync
+            std::thread simulationThread;
+            if (mSimulationTickMs > 0)
+            {
+                printf("Starting simulation thread\n");
+                simulationThread = std::thread(&BaseEngine::simulationLoop, this);
+            }
+
             // While application is running
             printf("Starting engine loop\n");
+#ifdef TETRIS_COUNT_ALLOCATIONS
+            Uint32 framesDrawn = 0;
+#endif
             while (!mQuit)
             {
-                // Increment counters
-                mFrameCount++;
+                // Nothing is moving, so block until there is an event rather than
+                // spinning. The timeout keeps the counters and hot reload going
+                bool idle = isIdle();
+                if (idle)
+                {
+                    SDL_WaitEventTimeout(NULL, IDLE_WAIT_MS);
+                }
+
+                // Update counters
                 if (SDL_GetTicks() - mElapsedTime > 1000)
                 {
                     mFps = mFrameCount;
                     mFrameCount = 0;
                     mElapsedTime = SDL_GetTicks();
+                    if (mMeasureLatency && mLatency.getTotalSamples() > 0)
+                    {
+                        mLatency.log("Rolling");
+                    }
+                    if (mMeasureCpu)
+                    {
+                        printf("CPU usage: %.1f%% of one core%s\n", mCpuMeter.sample(), idle ? " (idle)" : "");
+                    }
                 }
 
-                // Update game state objects
-                update();
-
-                // Clear screen
-                SDL_SetRenderDrawColor(mRenderer.get(), 0xFF, 0xFF, 0xFF, 0xFF);
-                SDL_RenderClear(mRenderer.get());
-
-                // Draw the information box
-                SDL_SetRenderDrawColor(mRenderer.get(),
-                    BACKGROUND_COLOUR.r,
-                    BACKGROUND_COLOUR.g,
-                    BACKGROUND_COLOUR.b,
-                    BACKGROUND_COLOUR.a);
-                static SDL_Rect infoBoxRect = {
-                    0, mScreenHeight - BOTTOM_BAR_HEIGHT, mScreenWidth, BOTTOM_BAR_HEIGHT
-                };
-                SDL_RenderFillRect(mRenderer.get(), &infoBoxRect);
-
-                // Render game state objects
-                render();
-
-                // Update screen
-                SDL_RenderPresent(mRenderer.get());
+                // Swap in changed assets between frames
+                bool reloaded = mHotReload && reloadChangedAssets();
+
+                mFrameArena.reset();
+#ifdef TETRIS_COUNT_ALLOCATIONS
+                AllocationCounts frameStart = AllocationCounter::thisThread();
+#endif
+
+                // Update game state objects. Skip the frame if nothing changed while
+                // idle, unless a capture wants it. Recording then keeps drawing a
+                // frame every wake up, so an idle screen still takes up clip time
+                bool changed = update();
+                if (idle && !changed && !reloaded && !mCapture.isPending(getTicks()))
+                {
+                    continue;
+                }
+                mFrameCount++;
+
+                [[maybe_unused]] bool captured = drawFrame(); // only checked when counting allocations
+                if (!mGameFrameShown)
+                {
+                    mGameFrameShown = true;
+                    printf("Time to first frame: %lld ms\n", static_cast<long long>(millisecondsSinceStart()));
+                }
+                if (mMeasureLatency)
+                {
+                    Uint32 presentTime = SDL_GetTicks();
+                    for (Uint32 inputTime : mInputsOnScreen)
+                    {
+                        mLatency.record(presentTime - inputTime);
+                    }
+                }
+                mInputsOnScreen.clear();
+
+#ifdef TETRIS_COUNT_ALLOCATIONS
+                // Loading a changed asset is allowed to allocate, and so is
+                // SDL when it reads a frame back for a capture
+                uint64_t allocations = AllocationCounter::thisThread().allocations - frameStart.allocations;
+                if (mCheckFrameAllocations && !reloaded && !captured && ++framesDrawn > ALLOCATION_WARMUP_FRAMES && allocations > 0)
+                {
+                    printf("Frame %u made %llu heap allocations\n", framesDrawn, static_cast<unsigned long long>(allocations));
+                    assert(allocations == 0);
+                }
+#endif
+            }
+
+            printf("Frame arena high water mark: %zu of %zu bytes\n", mFrameArena.highWaterMark(), mFrameArena.capacity());
+
+            if (mMeasureLatency)
+            {
+                mLatency.log("Session");
+            }
+
+            if (simulationThread.joinable())
+            {
+                simulationThread.join();
             }
         }
     }
@@ -0,0 +1,19 @@
+#include "engine/CpuMeter.h"
+
+CpuMeter::CpuMeter()
+    : mCpuTime { std::clock() }
+    , mWallTime { std::chrono::steady_clock::now() }
+{
+}
+
+double CpuMeter::sample()
+{
+    // std::clock() counts CPU time for all threads of the process on Linux and macOS
+    std::clock_t cpuTime = std::clock();
+    auto wallTime = std::chrono::steady_clock::now();
+    double cpuSeconds = static_cast<double>(cpuTime - mCpuTime) / CLOCKS_PER_SEC;
+    double wallSeconds = std::chrono::duration<double>(wallTime - mWallTime).count();
+    mCpuTime = cpuTime;
+    mWallTime = wallTime;
+    return (wallSeconds > 0.0) ? 100.0 * cpuSeconds / wallSeconds : 0.0;
+}
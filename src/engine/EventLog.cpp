@@ -0,0 +1,277 @@
+#include "engine/EventLog.h"
+#include "engine/ByteOrder.h"
+
+namespace
+{
+uint64_t zigzag(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void writeVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+}
+
+EventLog::EventLog()
+    : mProducers {}
+    , mFile { nullptr }
+    , mWriter {}
+    , mStopping { false }
+    , mStart {}
+    , mBuffer {}
+    , mLastTimeUs { 0 }
+    , mWriteFailed { false }
+{
+}
+
+EventLog::~EventLog()
+{
+    close();
+}
+
+bool EventLog::open(const std::string& path)
+{
+    close();
+    mFile = std::fopen(path.c_str(), "wb");
+    if (mFile == nullptr)
+    {
+        printf("Failed to create event log %s\n", path.c_str());
+        return false;
+    }
+
+    uint8_t header[EVENT_LOG_HEADER_SIZE] {};
+    writeU32(header, EVENT_LOG_MAGIC);
+    writeU16(header + 4, EVENT_LOG_VERSION);
+    mBuffer.clear();
+    mBuffer.reserve(2 * EVENT_LOG_WRITE_BYTES);
+    mBuffer.insert(mBuffer.end(), header, header + EVENT_LOG_HEADER_SIZE);
+    mLastTimeUs = 0;
+    mWriteFailed = false;
+    for (auto& producer : mProducers)
+    {
+        producer.dropped.store(0, std::memory_order_relaxed);
+        producer.droppedWritten = 0;
+    }
+
+    mStart = std::chrono::steady_clock::now();
+    mStopping = false;
+    mWriter = std::thread(&EventLog::writerLoop, this);
+    return true;
+}
+
+void EventLog::close()
+{
+    if (mFile == nullptr)
+    {
+        return;
+    }
+    mStopping = true;
+    mWriter.join();
+
+    // The producers are done, so whatever is left in the queues is final
+    drain();
+    write();
+    std::fclose(mFile);
+    mFile = nullptr;
+    if (mWriteFailed)
+    {
+        printf("Failed to write the event log, it is incomplete\n");
+    }
+    if (getDropped() > 0)
+    {
+        printf("The event log dropped %llu events\n", static_cast<unsigned long long>(getDropped()));
+    }
+}
+
+bool EventLog::isOpen() const
+{
+    return mFile != nullptr;
+}
+
+bool EventLog::log(size_t producer, uint8_t type, uint32_t tick, int32_t arg0, int32_t arg1)
+{
+    if (mFile == nullptr)
+    {
+        return false;
+    }
+    Producer& queue = mProducers[producer];
+    if (!queue.queue.push(LogEvent { nowUs(), tick, { arg0, arg1 }, type }))
+    {
+        queue.dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+uint64_t EventLog::getDropped() const
+{
+    uint64_t dropped = 0;
+    for (auto& producer : mProducers)
+    {
+        dropped += producer.dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+uint64_t EventLog::nowUs() const
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mStart).count());
+}
+
+void EventLog::writerLoop()
+{
+    auto lastFlush = std::chrono::steady_clock::now();
+    while (!mStopping)
+    {
+        bool busy = drain();
+        if (mBuffer.size() >= EVENT_LOG_WRITE_BYTES)
+        {
+            write();
+        }
+
+        // A quiet log still reaches the disk every so often, so a crash
+        // loses at most the last second
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastFlush >= std::chrono::milliseconds(EVENT_LOG_FLUSH_MS))
+        {
+            write();
+            std::fflush(mFile);
+            lastFlush = now;
+        }
+        if (!busy)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(EVENT_LOG_IDLE_MS));
+        }
+    }
+}
+
+bool EventLog::drain()
+{
+    bool any = false;
+    for (size_t index = 0; index < mProducers.size(); ++index)
+    {
+        Producer& producer = mProducers[index];
+        LogEvent event;
+        while (producer.queue.pop(event))
+        {
+            encode(event);
+            any = true;
+        }
+
+        // Say where the gap is, next to the events around it
+        uint64_t dropped = producer.dropped.load(std::memory_order_relaxed);
+        if (dropped != producer.droppedWritten)
+        {
+            encode(LogEvent { nowUs(), 0, { static_cast<int32_t>(index), static_cast<int32_t>(dropped - producer.droppedWritten) }, EVENT_LOG_DROPPED });
+            producer.droppedWritten = dropped;
+        }
+    }
+    return any;
+}
+
+void EventLog::encode(const LogEvent& event)
+{
+    mBuffer.push_back(event.type);
+    writeVarint(mBuffer, zigzag(static_cast<int64_t>(event.timeUs - mLastTimeUs)));
+    writeVarint(mBuffer, event.tick);
+    writeVarint(mBuffer, zigzag(event.args[0]));
+    writeVarint(mBuffer, zigzag(event.args[1]));
+    mLastTimeUs = event.timeUs;
+}
+
+void EventLog::write()
+{
+    if (!mBuffer.empty() && std::fwrite(mBuffer.data(), mBuffer.size(), 1, mFile) != 1)
+    {
+        mWriteFailed = true;
+    }
+    mBuffer.clear();
+}
+
+EventLogReader::EventLogReader()
+    : mData {}
+    , mOffset { 0 }
+    , mTimeUs { 0 }
+{
+}
+
+bool EventLogReader::open(const std::string& path)
+{
+    mData.clear();
+    mOffset = 0;
+    mTimeUs = 0;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        printf("Failed to open event log %s\n", path.c_str());
+        return false;
+    }
+    uint8_t chunk[4096];
+    size_t read;
+    while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        mData.insert(mData.end(), chunk, chunk + read);
+    }
+    std::fclose(file);
+
+    if (mData.size() < EVENT_LOG_HEADER_SIZE || readU32(mData.data()) != EVENT_LOG_MAGIC
+        || readU16(mData.data() + 4) != EVENT_LOG_VERSION)
+    {
+        printf("%s is not an event log\n", path.c_str());
+        mData.clear();
+        return false;
+    }
+    mOffset = EVENT_LOG_HEADER_SIZE;
+    return true;
+}
+
+bool EventLogReader::next(LogEvent& event)
+{
+    if (mOffset >= mData.size())
+    {
+        return false;
+    }
+    size_t start = mOffset;
+    uint8_t type = mData[mOffset++];
+    uint64_t delta, tick, arg0, arg1;
+    if (!readVarint(delta) || !readVarint(tick) || !readVarint(arg0) || !readVarint(arg1))
+    {
+        mOffset = start;
+        return false;
+    }
+    mTimeUs += static_cast<uint64_t>(unzigzag(delta));
+    event.timeUs = mTimeUs;
+    event.tick = static_cast<uint32_t>(tick);
+    event.args[0] = static_cast<int32_t>(unzigzag(arg0));
+    event.args[1] = static_cast<int32_t>(unzigzag(arg1));
+    event.type = type;
+    return true;
+}
+
+bool EventLogReader::readVarint(uint64_t& value)
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && mOffset < mData.size(); shift += 7)
+    {
+        uint8_t byte = mData[mOffset++];
+        value |= uint64_t { byte & 0x7Fu } << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
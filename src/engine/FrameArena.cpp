@@ -0,0 +1,48 @@
+#include "engine/FrameArena.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t capacity)
+    : mBuffer { std::make_unique<std::byte[]>(capacity) }
+    , mCapacity { capacity }
+    , mUsed { 0 }
+    , mHighWaterMark { 0 }
+{
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    // Round up from the actual address, the buffer itself is only aligned for max_align_t
+    auto base = reinterpret_cast<uintptr_t>(mBuffer.get());
+    uintptr_t start = (base + mUsed + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    size_t offset = static_cast<size_t>(start - base);
+    if (offset + size > mCapacity)
+    {
+        assert(!"FrameArena is full, make FRAME_ARENA_SIZE bigger");
+        return nullptr;
+    }
+    mUsed = offset + size;
+    mHighWaterMark = std::max(mHighWaterMark, mUsed);
+    return mBuffer.get() + offset;
+}
+
+void FrameArena::reset()
+{
+    mUsed = 0;
+}
+
+size_t FrameArena::used() const
+{
+    return mUsed;
+}
+
+size_t FrameArena::capacity() const
+{
+    return mCapacity;
+}
+
+size_t FrameArena::highWaterMark() const
+{
+    return mHighWaterMark;
+}
@@ -0,0 +1,322 @@
+#include "engine/FrameCapture.h"
+#include "engine/FrameExporter.h"
+#include <SDL_image.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+FrameCapture::FrameCapture()
+    : mWidth { 0 }
+    , mHeight { 0 }
+    , mDirectory {}
+    , mRecordFrames { 0 }
+    , mBuffers {}
+    , mBufferBusy {}
+    , mScreenshotRequested { false }
+    , mClipRequested { false }
+    , mNextRecordMs { 0 }
+    , mDroppedFrames { 0 }
+    , mJobs {}
+    , mWorker {}
+    , mWakeMutex {}
+    , mWake {}
+    , mStopping { false }
+    , mRing {}
+    , mRingNext { 0 }
+    , mRingCount { 0 }
+    , mFilesWritten { 0 }
+    , mFramesProcessed { 0 }
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+    close();
+}
+
+bool FrameCapture::open(int width, int height, Uint32 recordSeconds, const std::string& directory)
+{
+    close();
+    mWidth = width;
+    mHeight = height;
+    mDirectory = directory;
+    for (size_t index = 0; index < CAPTURE_BUFFERS; ++index)
+    {
+        mBuffers[index] = Framebuffer::create(width, height);
+        mBufferBusy[index] = false;
+        if (mBuffers[index] == nullptr)
+        {
+            printf("Capture buffer could not be created! SDL Error: %s\n", SDL_GetError());
+            return false;
+        }
+    }
+
+    // The whole ring is allocated now, recording only ever overwrites it
+    mRecordFrames = recordSeconds * RECORD_FPS;
+    size_t chromaSize = static_cast<size_t>((width + 1) / 2) * static_cast<size_t>((height + 1) / 2);
+    mRing.assign(mRecordFrames, std::vector<uint8_t>(static_cast<size_t>(width * height) + 2 * chromaSize));
+    mRingNext = 0;
+    mRingCount = 0;
+    if (mRecordFrames > 0)
+    {
+        printf("Recording the last %u seconds, %.0f MB\n", recordSeconds,
+            static_cast<double>(mRing.size() * mRing[0].size()) / (1024.0 * 1024.0));
+    }
+
+    mStopping = false;
+    mWorker = std::thread(&FrameCapture::workerLoop, this);
+    return true;
+}
+
+void FrameCapture::close()
+{
+    if (!mWorker.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+        mStopping = true;
+    }
+    mWake.notify_one();
+    mWorker.join();
+    mRing.clear();
+    mRecordFrames = 0;
+}
+
+bool FrameCapture::isOpen() const
+{
+    return mWorker.joinable();
+}
+
+bool FrameCapture::isRecording() const
+{
+    return mRecordFrames > 0;
+}
+
+void FrameCapture::requestScreenshot()
+{
+    mScreenshotRequested = true;
+}
+
+void FrameCapture::requestClip()
+{
+    if (!isRecording())
+    {
+        printf("Not recording, run with --record to save clips\n");
+        return;
+    }
+    mClipRequested = true;
+}
+
+bool FrameCapture::isPending(Uint32 now) const
+{
+    return isOpen() && (mScreenshotRequested || mClipRequested || (isRecording() && now >= mNextRecordMs));
+}
+
+bool FrameCapture::capture(SDL_Renderer* renderer, Uint32 now)
+{
+    if (!isOpen())
+    {
+        return false;
+    }
+
+    // Recording keeps to RECORD_FPS whatever the frame rate. A slow or
+    // skipped frame is repeated, so clips play back at the speed they were played
+    constexpr Uint32 RECORD_INTERVAL_MS = 1000 / RECORD_FPS;
+    Uint32 repeats = 0;
+    if (isRecording() && now >= mNextRecordMs)
+    {
+        repeats = (mNextRecordMs == 0) ? 1 : std::min(1 + (now - mNextRecordMs) / RECORD_INTERVAL_MS, RECORD_MAX_REPEATS);
+        mNextRecordMs = now - (now - mNextRecordMs) % RECORD_INTERVAL_MS + RECORD_INTERVAL_MS;
+    }
+
+    bool captured = false;
+    if (mScreenshotRequested || repeats > 0)
+    {
+        size_t buffer;
+        if (!acquireBuffer(buffer))
+        {
+            // A screenshot waits for the next frame, a recorded frame is lost
+            mDroppedFrames += (repeats > 0) ? 1 : 0;
+        }
+        else if (SDL_RenderReadPixels(renderer, nullptr, SDL_PIXELFORMAT_ARGB8888,
+                     mBuffers[buffer]->pixels, mBuffers[buffer]->pitch)
+            != 0)
+        {
+            printf("Failed to read the frame back! SDL Error: %s\n", SDL_GetError());
+            mBufferBusy[buffer] = false;
+            mScreenshotRequested = false;
+        }
+        else
+        {
+            submit(Job { buffer, mScreenshotRequested, repeats });
+            mScreenshotRequested = false;
+            captured = true;
+        }
+    }
+
+    // After this frame's job, so the clip ends on it
+    if (mClipRequested)
+    {
+        submit(Job { CAPTURE_BUFFERS, false, 0 });
+        mClipRequested = false;
+    }
+    return captured;
+}
+
+bool FrameCapture::acquireBuffer(size_t& buffer)
+{
+    for (buffer = 0; buffer < CAPTURE_BUFFERS; ++buffer)
+    {
+        if (!mBufferBusy[buffer])
+        {
+            mBufferBusy[buffer] = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FrameCapture::submit(const Job& job)
+{
+    // There are more queue slots than buffers, so only a pile of clips can fill it
+    if (!mJobs.push(job))
+    {
+        printf("Capture queue is full, dropping a capture\n");
+        if (job.buffer < CAPTURE_BUFFERS)
+        {
+            mBufferBusy[job.buffer] = false;
+        }
+        return;
+    }
+    // Taking the lock means the capture thread is either waiting already or
+    // hasn't checked the queue yet, so the wake up can't be missed
+    {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+    }
+    mWake.notify_one();
+}
+
+size_t FrameCapture::getDroppedFrames() const
+{
+    return mDroppedFrames;
+}
+
+size_t FrameCapture::getFilesWritten() const
+{
+    return mFilesWritten;
+}
+
+size_t FrameCapture::getFramesProcessed() const
+{
+    return mFramesProcessed;
+}
+
+void FrameCapture::workerLoop()
+{
+    Job job;
+    while (true)
+    {
+        while (mJobs.pop(job))
+        {
+            run(job);
+        }
+        std::unique_lock<std::mutex> lock(mWakeMutex);
+        mWake.wait(lock,
+            [this]()
+            {
+                return mStopping || !mJobs.empty();
+            });
+        if (mStopping && mJobs.empty())
+        {
+            return;
+        }
+    }
+}
+
+void FrameCapture::run(const Job& job)
+{
+    if (job.buffer == CAPTURE_BUFFERS)
+    {
+        saveClip();
+        return;
+    }
+    const SDL_Surface* frame = mBuffers[job.buffer].get();
+    if (job.screenshot)
+    {
+        saveScreenshot(frame);
+    }
+    if (job.recordRepeats > 0)
+    {
+        record(frame, job.recordRepeats);
+    }
+    mBufferBusy[job.buffer] = false;
+    mFramesProcessed++;
+}
+
+std::string FrameCapture::nextFileName(const char* prefix, const char* extension)
+{
+    // Local time to the second, and a counter in case of two in a second
+    char stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::localtime(&now));
+    char name[96];
+    std::snprintf(name, sizeof(name), "/%s_%s_%zu.%s", prefix, stamp, mFilesWritten.load(), extension);
+    return mDirectory + name;
+}
+
+void FrameCapture::saveScreenshot(const SDL_Surface* frame)
+{
+    std::string path = nextFileName("screenshot", "png");
+    if (IMG_SavePNG(const_cast<SDL_Surface*>(frame), path.c_str()) != 0)
+    {
+        printf("Failed to save %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError());
+        return;
+    }
+    mFilesWritten++;
+    printf("Saved %s\n", path.c_str());
+}
+
+void FrameCapture::record(const SDL_Surface* frame, Uint32 repeats)
+{
+    std::vector<uint8_t>& first = mRing[mRingNext];
+    FrameExporter::toI420(frame, first);
+    mRingNext = (mRingNext + 1) % mRing.size();
+    for (Uint32 repeat = 1; repeat < repeats; ++repeat)
+    {
+        std::copy(first.begin(), first.end(), mRing[mRingNext].begin());
+        mRingNext = (mRingNext + 1) % mRing.size();
+    }
+    mRingCount = std::min(mRingCount + repeats, mRing.size());
+}
+
+void FrameCapture::saveClip()
+{
+    if (mRingCount == 0)
+    {
+        printf("Nothing recorded yet, no clip saved\n");
+        return;
+    }
+
+    // Recording waits while this writes, any frames it misses are dropped
+    auto start = std::chrono::steady_clock::now();
+    std::string path = nextFileName("clip", "y4m");
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    bool ok = file != nullptr && FrameExporter::writeY4MHeader(file, mWidth, mHeight, static_cast<int>(RECORD_FPS), 1);
+    size_t oldest = (mRingNext + mRing.size() - mRingCount) % mRing.size();
+    for (size_t index = 0; ok && index < mRingCount; ++index)
+    {
+        ok = FrameExporter::writeY4MFrame(file, mRing[(oldest + index) % mRing.size()]);
+    }
+    ok = (file != nullptr && std::fclose(file) == 0) && ok;
+    if (!ok)
+    {
+        printf("Failed to save %s\n", path.c_str());
+        return;
+    }
+    mFilesWritten++;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("Saved %s, %.1f s in %.1f s\n", path.c_str(), static_cast<double>(mRingCount) / RECORD_FPS, elapsed.count());
+}
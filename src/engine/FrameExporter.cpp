@@ -0,0 +1,218 @@
+#include "engine/FrameExporter.h"
+#include <SDL_image.h>
+#include <algorithm>
+
+namespace
+{
+// The integer BT.601 approximations, inputs and outputs 0-255
+uint8_t lumaOf(int red, int green, int blue)
+{
+    return static_cast<uint8_t>(((66 * red + 129 * green + 25 * blue + 128) >> 8) + 16);
+}
+
+uint8_t blueDifferenceOf(int red, int green, int blue)
+{
+    return static_cast<uint8_t>(((-38 * red - 74 * green + 112 * blue + 128) >> 8) + 128);
+}
+
+uint8_t redDifferenceOf(int red, int green, int blue)
+{
+    return static_cast<uint8_t>(((112 * red - 94 * green - 18 * blue + 128) >> 8) + 128);
+}
+
+uint32_t pixelAt(const SDL_Surface* frame, int x, int y)
+{
+    const uint8_t* row = static_cast<const uint8_t*>(frame->pixels) + y * frame->pitch;
+    return reinterpret_cast<const uint32_t*>(row)[x];
+}
+}
+
+FrameExporter::FrameExporter()
+    : mFormat { ExportFormat::PNG }
+    , mPath {}
+    , mWidth { 0 }
+    , mHeight { 0 }
+    , mFile { nullptr }
+    , mEncoders {}
+    , mInFlight {}
+    , mMaxInFlight { 0 }
+    , mFramesPushed { 0 }
+    , mFramesWritten { 0 }
+    , mFailed { false }
+{
+}
+
+FrameExporter::~FrameExporter()
+{
+    close();
+}
+
+bool FrameExporter::open(ExportFormat format, const std::string& path, int width, int height, int rateNumerator, int rateDenominator, size_t threads)
+{
+    close();
+    mFormat = format;
+    mPath = path;
+    mWidth = width;
+    mHeight = height;
+    mFramesPushed = 0;
+    mFramesWritten = 0;
+    mFailed = false;
+    if (format == ExportFormat::Y4M)
+    {
+        mFile = std::fopen(path.c_str(), "wb");
+        if (mFile == nullptr)
+        {
+            printf("Failed to open %s for writing\n", path.c_str());
+            return false;
+        }
+        mFailed = !writeY4MHeader(mFile, width, height, rateNumerator, rateDenominator);
+    }
+    mEncoders = std::make_unique<ThreadPool>(threads);
+    mMaxInFlight = EXPORT_FRAMES_PER_THREAD * mEncoders->size();
+    return true;
+}
+
+bool FrameExporter::push(const SDL_Surface* frame)
+{
+    if (mEncoders == nullptr || frame->w != mWidth || frame->h != mHeight)
+    {
+        return false;
+    }
+
+    // Back pressure: don't draw further ahead than the encoders can keep up with
+    while (mInFlight.size() >= mMaxInFlight)
+    {
+        writeOldest();
+    }
+
+    // The caller draws the next frame over this one, so encode a copy
+    std::shared_ptr<SDL_Surface> copy { Framebuffer::copy(frame).release(), SDLSurfaceDeleter {} };
+    if (copy == nullptr)
+    {
+        return false;
+    }
+    size_t index = mFramesPushed++;
+    mInFlight.push_back(mEncoders->submit([this, copy, index]()
+        {
+            return encode(copy.get(), index);
+        }));
+    return !mFailed;
+}
+
+FrameExporter::Encoded FrameExporter::encode(const SDL_Surface* frame, size_t index) const
+{
+    Encoded encoded { true, {} };
+    if (mFormat == ExportFormat::Y4M)
+    {
+        toI420(frame, encoded.bytes);
+        return encoded;
+    }
+
+    // Each PNG is its own file, so the worker writes it. Only the
+    // bookkeeping goes back through the queue in order
+    char name[32];
+    std::snprintf(name, sizeof(name), "/frame_%06zu.png", index);
+    std::string path { mPath + name };
+    encoded.ok = IMG_SavePNG(const_cast<SDL_Surface*>(frame), path.c_str()) == 0;
+    if (!encoded.ok)
+    {
+        printf("Failed to write %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError());
+    }
+    return encoded;
+}
+
+bool FrameExporter::writeOldest()
+{
+    Encoded encoded = mInFlight.front().get();
+    mInFlight.pop_front();
+    if (encoded.ok && mFile != nullptr)
+    {
+        encoded.ok = writeY4MFrame(mFile, encoded.bytes);
+    }
+    mFailed = mFailed || !encoded.ok;
+    mFramesWritten += encoded.ok ? 1 : 0;
+    return encoded.ok;
+}
+
+bool FrameExporter::close()
+{
+    while (!mInFlight.empty())
+    {
+        writeOldest();
+    }
+    mEncoders.reset();
+    if (mFile != nullptr)
+    {
+        mFailed = (std::fclose(mFile) != 0) || mFailed;
+        mFile = nullptr;
+    }
+    return !mFailed;
+}
+
+size_t FrameExporter::getFramesWritten() const
+{
+    return mFramesWritten;
+}
+
+bool FrameExporter::writeY4MHeader(std::FILE* file, int width, int height, int rateNumerator, int rateDenominator)
+{
+    // C420jpeg: chroma sited between the four luma samples it covers,
+    // which is what averaging each 2x2 block gives
+    return std::fprintf(file, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C420jpeg\n", width, height, rateNumerator, rateDenominator) > 0;
+}
+
+bool FrameExporter::writeY4MFrame(std::FILE* file, const std::vector<uint8_t>& planes)
+{
+    static const char FRAME_HEADER[] = "FRAME\n";
+    return std::fwrite(FRAME_HEADER, 1, sizeof(FRAME_HEADER) - 1, file) == sizeof(FRAME_HEADER) - 1
+        && std::fwrite(planes.data(), 1, planes.size(), file) == planes.size();
+}
+
+void FrameExporter::toI420(const SDL_Surface* frame, std::vector<uint8_t>& planes)
+{
+    size_t width = static_cast<size_t>(frame->w);
+    size_t height = static_cast<size_t>(frame->h);
+    size_t chromaWidth = (width + 1) / 2;
+    size_t chromaHeight = (height + 1) / 2;
+    planes.resize(width * height + 2 * chromaWidth * chromaHeight);
+    uint8_t* luma = planes.data();
+    uint8_t* blue = luma + width * height;
+    uint8_t* red = blue + chromaWidth * chromaHeight;
+
+    for (int y = 0; y < frame->h; ++y)
+    {
+        for (int x = 0; x < frame->w; ++x)
+        {
+            uint32_t pixel = pixelAt(frame, x, y);
+            *luma++ = lumaOf(static_cast<int>((pixel >> 16) & 0xFF),
+                static_cast<int>((pixel >> 8) & 0xFF),
+                static_cast<int>(pixel & 0xFF));
+        }
+    }
+
+    // One chroma sample per 2x2 block, from the average colour
+    for (int y = 0; y < frame->h; y += 2)
+    {
+        for (int x = 0; x < frame->w; x += 2)
+        {
+            int sums[3] { 0, 0, 0 };
+            int count = 0;
+            for (int row = y; row < std::min(y + 2, frame->h); ++row)
+            {
+                for (int col = x; col < std::min(x + 2, frame->w); ++col)
+                {
+                    uint32_t pixel = pixelAt(frame, col, row);
+                    sums[0] += static_cast<int>((pixel >> 16) & 0xFF);
+                    sums[1] += static_cast<int>((pixel >> 8) & 0xFF);
+                    sums[2] += static_cast<int>(pixel & 0xFF);
+                    count++;
+                }
+            }
+            int averageRed = (sums[0] + count / 2) / count;
+            int averageGreen = (sums[1] + count / 2) / count;
+            int averageBlue = (sums[2] + count / 2) / count;
+            *blue++ = blueDifferenceOf(averageRed, averageGreen, averageBlue);
+            *red++ = redDifferenceOf(averageRed, averageGreen, averageBlue);
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include "engine/Framebuffer.h"
+#include <cstdio>
+
+namespace
+{
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+const uint32_t* row(const SDL_Surface* frame, int y)
+{
+    return reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(frame->pixels) + y * frame->pitch);
+}
+}
+
+SurfacePtr Framebuffer::create(int width, int height)
+{
+    return SurfacePtr { SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888) };
+}
+
+SurfacePtr Framebuffer::copy(const SDL_Surface* frame)
+{
+    // Converting to the format it is already in copies it
+    return SurfacePtr { SDL_ConvertSurfaceFormat(const_cast<SDL_Surface*>(frame), SDL_PIXELFORMAT_ARGB8888, 0) };
+}
+
+uint64_t Framebuffer::hash(const SDL_Surface* frame)
+{
+    uint64_t hash = FNV_OFFSET;
+    for (int y = 0; y < frame->h; ++y)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(row(frame, y));
+        for (size_t index = 0; index < 4 * static_cast<size_t>(frame->w); ++index)
+        {
+            hash = (hash ^ bytes[index]) * FNV_PRIME;
+        }
+    }
+    return hash;
+}
+
+long Framebuffer::countDifferentPixels(const SDL_Surface* first, const SDL_Surface* second)
+{
+    if (first->w != second->w || first->h != second->h)
+    {
+        return -1;
+    }
+    long different = 0;
+    for (int y = 0; y < first->h; ++y)
+    {
+        const uint32_t* firstRow = row(first, y);
+        const uint32_t* secondRow = row(second, y);
+        for (int x = 0; x < first->w; ++x)
+        {
+            different += (firstRow[x] != secondRow[x]) ? 1 : 0;
+        }
+    }
+    return different;
+}
+
+bool Framebuffer::save(const SDL_Surface* frame, const std::string& path)
+{
+    // SDL_SaveBMP only reads the surface, it just isn't declared const
+    if (SDL_SaveBMP(const_cast<SDL_Surface*>(frame), path.c_str()) != 0)
+    {
+        printf("Failed to save frame to %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+SurfacePtr Framebuffer::load(const std::string& path)
+{
+    SurfacePtr loaded { SDL_LoadBMP(path.c_str()) };
+    if (loaded == nullptr)
+    {
+        printf("Failed to load frame from %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+        return loaded;
+    }
+
+    // Whatever the BMP was saved as, compare it as ARGB8888
+    return SurfacePtr { SDL_ConvertSurfaceFormat(loaded.get(), SDL_PIXELFORMAT_ARGB8888, 0) };
+}
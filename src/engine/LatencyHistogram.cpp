@@ -0,0 +1,104 @@
+#include "engine/LatencyHistogram.h"
+#include <algorithm>
+
+namespace
+{
+// Index of the highest set bit, value must not be 0
+uint32_t highestBit(uint32_t value)
+{
+    uint32_t bit = 0;
+    while (value >>= 1)
+    {
+        bit++;
+    }
+    return bit;
+}
+}
+
+LatencyHistogram::LatencyHistogram()
+    : mBuckets {}
+    , mCount { 0 }
+    , mMax { 0 }
+{
+}
+
+size_t LatencyHistogram::bucketOf(uint32_t value)
+{
+    if (value < LATENCY_HISTOGRAM_EXACT)
+    {
+        return value;
+    }
+    // The top bit picks the power of two, the next four bits the sub bucket
+    uint32_t bit = highestBit(value);
+    uint32_t sub = (value >> (bit - 4)) & (LATENCY_HISTOGRAM_SUB_BUCKETS - 1);
+    return LATENCY_HISTOGRAM_EXACT + (bit - 5) * LATENCY_HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+uint32_t LatencyHistogram::bucketValue(size_t bucket)
+{
+    if (bucket < LATENCY_HISTOGRAM_EXACT)
+    {
+        return static_cast<uint32_t>(bucket);
+    }
+    auto bit = static_cast<uint32_t>((bucket - LATENCY_HISTOGRAM_EXACT) / LATENCY_HISTOGRAM_SUB_BUCKETS + 5);
+    auto sub = static_cast<uint32_t>((bucket - LATENCY_HISTOGRAM_EXACT) % LATENCY_HISTOGRAM_SUB_BUCKETS);
+    return (LATENCY_HISTOGRAM_SUB_BUCKETS + sub) << (bit - 4);
+}
+
+void LatencyHistogram::record(uint32_t value)
+{
+    mBuckets[bucketOf(value)]++;
+    mCount++;
+    mMax = std::max(mMax, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (size_t bucket = 0; bucket < LATENCY_HISTOGRAM_BUCKETS; ++bucket)
+    {
+        mBuckets[bucket] += other.mBuckets[bucket];
+    }
+    mCount += other.mCount;
+    mMax = std::max(mMax, other.mMax);
+}
+
+void LatencyHistogram::clear()
+{
+    *this = LatencyHistogram {};
+}
+
+uint32_t LatencyHistogram::percentile(uint64_t percent) const
+{
+    // The same rank LatencyTracker picks from its sorted window
+    uint64_t rank = (mCount - 1) * percent / 100;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < LATENCY_HISTOGRAM_BUCKETS; ++bucket)
+    {
+        seen += mBuckets[bucket];
+        if (seen > rank)
+        {
+            return bucketValue(bucket);
+        }
+    }
+    return mMax;
+}
+
+LatencyPercentiles LatencyHistogram::getPercentiles() const
+{
+    LatencyPercentiles percentiles {};
+    percentiles.samples = static_cast<size_t>(mCount);
+    if (mCount == 0)
+    {
+        return percentiles;
+    }
+    percentiles.p50 = percentile(50);
+    percentiles.p90 = percentile(90);
+    percentiles.p99 = percentile(99);
+    percentiles.max = mMax;
+    return percentiles;
+}
+
+uint64_t LatencyHistogram::getCount() const
+{
+    return mCount;
+}
@@ -0,0 +1,56 @@
+#include "engine/LatencyTracker.h"
+#include <algorithm>
+#include <cstdio>
+
+LatencyTracker::LatencyTracker()
+    : mSamples {}
+    , mTotalSamples { 0 }
+{
+}
+
+void LatencyTracker::record(uint32_t latencyMs)
+{
+    mSamples[mTotalSamples % LATENCY_WINDOW] = latencyMs;
+    mTotalSamples++;
+}
+
+LatencyPercentiles LatencyTracker::getPercentiles() const
+{
+    LatencyPercentiles percentiles {};
+    percentiles.samples = static_cast<size_t>(std::min<uint64_t>(mTotalSamples, LATENCY_WINDOW));
+    if (percentiles.samples == 0)
+    {
+        return percentiles;
+    }
+
+    // Sort a copy, the window is small enough that this is cheap once a second
+    std::array<uint32_t, LATENCY_WINDOW> sorted = mSamples;
+    std::sort(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(percentiles.samples));
+    auto at = [&sorted, &percentiles](size_t percent)
+    {
+        return sorted[(percentiles.samples - 1) * percent / 100];
+    };
+    percentiles.p50 = at(50);
+    percentiles.p90 = at(90);
+    percentiles.p99 = at(99);
+    percentiles.max = sorted[percentiles.samples - 1];
+    return percentiles;
+}
+
+uint64_t LatencyTracker::getTotalSamples() const
+{
+    return mTotalSamples;
+}
+
+void LatencyTracker::log(const char* label) const
+{
+    LatencyPercentiles percentiles = getPercentiles();
+    printf("%s input latency: p50 %u ms, p90 %u ms, p99 %u ms, max %u ms over %zu events (%llu total)\n",
+        label,
+        percentiles.p50,
+        percentiles.p90,
+        percentiles.p99,
+        percentiles.max,
+        percentiles.samples,
+        static_cast<unsigned long long>(mTotalSamples));
+}
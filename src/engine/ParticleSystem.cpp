@@ -0,0 +1,175 @@
+#include "engine/ParticleSystem.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARTICLES_SSE2
+#endif
+
+ParticleSystem::ParticleSystem(size_t capacity)
+    : mCount { 0 }
+    , mGravity { 0 }
+    , mPosX(capacity)
+    , mPosY(capacity)
+    , mVelX(capacity)
+    , mVelY(capacity)
+    , mLife(capacity)
+    , mFade(capacity)
+    , mColour(capacity)
+    , mVertices(4 * capacity)
+    , mIndices(6 * capacity)
+{
+    // Two triangles per quad, the same pattern for every particle
+    for (size_t quad = 0; quad < capacity; ++quad)
+    {
+        int first = static_cast<int>(4 * quad);
+        int* indices = &mIndices[6 * quad];
+        indices[0] = first;
+        indices[1] = first + 1;
+        indices[2] = first + 2;
+        indices[3] = first + 2;
+        indices[4] = first + 1;
+        indices[5] = first + 3;
+    }
+}
+
+bool ParticleSystem::emit(float x, float y, float velX, float velY, float life, SDL_Color colour)
+{
+    if (mCount == mPosX.size() || life <= 0)
+    {
+        return false;
+    }
+    mPosX[mCount] = x;
+    mPosY[mCount] = y;
+    mVelX[mCount] = velX;
+    mVelY[mCount] = velY;
+    mLife[mCount] = life;
+    mFade[mCount] = 1.0f / life;
+    mColour[mCount] = colour;
+    mCount++;
+    return true;
+}
+
+void ParticleSystem::update(float seconds)
+{
+    integrate(seconds);
+    removeDead();
+}
+
+void ParticleSystem::integrate(float seconds)
+{
+    float* posX = mPosX.data();
+    float* posY = mPosY.data();
+    float* velX = mVelX.data();
+    float* velY = mVelY.data();
+    float* life = mLife.data();
+    float gravity = mGravity * seconds;
+
+    size_t index = 0;
+#ifdef PARTICLES_SSE2
+    __m128 step = _mm_set1_ps(seconds);
+    __m128 fall = _mm_set1_ps(gravity);
+    for (; index + 4 <= mCount; index += 4)
+    {
+        __m128 newVelY = _mm_add_ps(_mm_loadu_ps(velY + index), fall);
+        _mm_storeu_ps(velY + index, newVelY);
+        _mm_storeu_ps(posX + index, _mm_add_ps(_mm_loadu_ps(posX + index), _mm_mul_ps(_mm_loadu_ps(velX + index), step)));
+        _mm_storeu_ps(posY + index, _mm_add_ps(_mm_loadu_ps(posY + index), _mm_mul_ps(newVelY, step)));
+        _mm_storeu_ps(life + index, _mm_sub_ps(_mm_loadu_ps(life + index), step));
+    }
+#endif
+    // The tail, or everything without SSE2. Plain enough to auto-vectorize
+    for (; index < mCount; ++index)
+    {
+        velY[index] += gravity;
+        posX[index] += velX[index] * seconds;
+        posY[index] += velY[index] * seconds;
+        life[index] -= seconds;
+    }
+}
+
+void ParticleSystem::removeDead()
+{
+    // Move the last live particle into each hole, order doesn't matter
+    size_t index = 0;
+    while (index < mCount)
+    {
+        if (mLife[index] > 0)
+        {
+            ++index;
+            continue;
+        }
+        --mCount;
+        mPosX[index] = mPosX[mCount];
+        mPosY[index] = mPosY[mCount];
+        mVelX[index] = mVelX[mCount];
+        mVelY[index] = mVelY[mCount];
+        mLife[index] = mLife[mCount];
+        mFade[index] = mFade[mCount];
+        mColour[index] = mColour[mCount];
+    }
+}
+
+void ParticleSystem::setGravity(float gravity)
+{
+    mGravity = gravity;
+}
+
+void ParticleSystem::render(SDL_Renderer* renderer, float size)
+{
+    if (mCount == 0)
+    {
+        return;
+    }
+
+    SDL_Vertex* vertices = mVertices.data();
+    for (size_t index = 0; index < mCount; ++index)
+    {
+        SDL_Color colour = mColour[index];
+        float alpha = std::min(1.0f, mLife[index] * mFade[index]);
+        colour.a = static_cast<Uint8>(static_cast<float>(colour.a) * alpha);
+
+        float x = mPosX[index];
+        float y = mPosY[index];
+        SDL_Vertex* quad = vertices + 4 * index;
+        quad[0] = SDL_Vertex { SDL_FPoint { x, y }, colour, SDL_FPoint { 0, 0 } };
+        quad[1] = SDL_Vertex { SDL_FPoint { x + size, y }, colour, SDL_FPoint { 0, 0 } };
+        quad[2] = SDL_Vertex { SDL_FPoint { x, y + size }, colour, SDL_FPoint { 0, 0 } };
+        quad[3] = SDL_Vertex { SDL_FPoint { x + size, y + size }, colour, SDL_FPoint { 0, 0 } };
+    }
+
+    // The whole pool in one draw call
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    int quads = static_cast<int>(mCount);
+    SDL_RenderGeometry(renderer, nullptr, vertices, 4 * quads, mIndices.data(), 6 * quads);
+}
+
+void ParticleSystem::clear()
+{
+    mCount = 0;
+}
+
+bool ParticleSystem::empty() const
+{
+    return mCount == 0;
+}
+
+size_t ParticleSystem::size() const
+{
+    return mCount;
+}
+
+size_t ParticleSystem::capacity() const
+{
+    return mPosX.size();
+}
+
+float ParticleSystem::getPosX(size_t index) const
+{
+    return mPosX[index];
+}
+
+float ParticleSystem::getPosY(size_t index) const
+{
+    return mPosY[index];
+}
@@ -35,25 +35,54 @@ Texture::~Texture()
 
 bool Texture::loadFromFile(const std::string& path)
 {
-    // The final texture
-    SDL_Texture* newTexture { nullptr };
+    SDL_Surface* loadedSurface = decodeFile(path);
+    return loadedSurface != NULL && loadFromSurface(loadedSurface, path);
+}
+
+bool Texture::loadFromMemory(const void* data, size_t size, const std::string& name)
+{
+    SDL_Surface* loadedSurface = decodeMemory(data, size, name);
+    return loadedSurface != NULL && loadFromSurface(loadedSurface, name);
+}
 
+SDL_Surface* Texture::decodeFile(const std::string& path)
+{
     // Load image at specified path
     SDL_Surface* loadedSurface = IMG_Load(path.c_str());
     if (loadedSurface == NULL)
     {
         printf("Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError());
-        return false;
+        return NULL;
+    }
+
+    // Color key image
+    SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB(loadedSurface->format, 0, 0xFF, 0xFF));
+    return loadedSurface;
+}
+
+SDL_Surface* Texture::decodeMemory(const void* data, size_t size, const std::string& name)
+{
+    // SDL_image closes the RWops for us
+    SDL_Surface* loadedSurface = IMG_Load_RW(SDL_RWFromConstMem(data, static_cast<int>(size)), 1);
+    if (loadedSurface == NULL)
+    {
+        printf("Unable to load image %s! SDL_image Error: %s\n", name.c_str(), IMG_GetError());
+        return NULL;
     }
 
     // Color key image
     SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB(loadedSurface->format, 0, 0xFF, 0xFF));
+    return loadedSurface;
+}
 
+bool Texture::loadFromSurface(SDL_Surface* loadedSurface, const std::string& name)
+{
     // Create texture from surface pixels
-    newTexture = SDL_CreateTextureFromSurface(mRenderer, loadedSurface);
+    SDL_Texture* newTexture = SDL_CreateTextureFromSurface(mRenderer, loadedSurface);
     if (newTexture == NULL)
     {
-        printf("Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError());
+        printf("Unable to create texture from %s! SDL Error: %s\n", name.c_str(), SDL_GetError());
+        SDL_FreeSurface(loadedSurface);
         return false;
     }
 
@@ -68,13 +97,13 @@ bool Texture::loadFromFile(const std::string& path)
     return true;
 }
 
-bool Texture::loadFromRenderedText(std::string textureText, SDL_Color textColor, SDL_Color backgroundColour)
+bool Texture::loadFromRenderedText(const char* textureText, SDL_Color textColor, SDL_Color backgroundColour)
 {   
     // The final texture
     SDL_Texture* newTexture { nullptr };
 
     // Render text surface
-    SDL_Surface* textSurface = TTF_RenderText_Shaded(mFont, textureText.c_str(), textColor, backgroundColour);
+    SDL_Surface* textSurface = TTF_RenderText_Shaded(mFont, textureText, textColor, backgroundColour);
     if (textSurface == NULL)
     {
         printf("Unable to render text surface! SDL_ttf Error: %s\n", TTF_GetError());
@@ -107,6 +136,11 @@ void Texture::reset()
     mHeight = 0;
 }
 
+void Texture::setFont(TTF_Font* font)
+{
+    mFont = font;
+}
+
 void Texture::render(int x, int y, SDL_Rect* clip, double angle, SDL_Point* center, SDL_RendererFlip flip)
 {
     // Set rendering space and render to screen
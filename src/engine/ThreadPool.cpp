@@ -0,0 +1,60 @@
+#include "engine/ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads)
+    : mWorkers {}
+    , mTasks {}
+    , mMutex {}
+    , mWake {}
+    , mStopping { false }
+{
+    if (threads == 0)
+    {
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    mWorkers.reserve(threads);
+    for (size_t index = 0; index < threads; ++index)
+    {
+        mWorkers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mWake.notify_all();
+    for (auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const
+{
+    return mWorkers.size();
+}
+
+void ThreadPool::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWake.wait(lock, [this]()
+                {
+                    return mStopping || !mTasks.empty();
+                });
+            if (mTasks.empty())
+            {
+                return;
+            }
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,219 @@
+#include "engine/UdpSocket.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+namespace
+{
+constexpr SocketHandle INVALID_SOCKET_HANDLE = INVALID_SOCKET;
+void closeSocket(SocketHandle socket)
+{
+    closesocket(socket);
+}
+bool startSockets()
+{
+    static bool started = []()
+    {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return started;
+}
+}
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+namespace
+{
+constexpr SocketHandle INVALID_SOCKET_HANDLE = -1;
+void closeSocket(SocketHandle socket)
+{
+    ::close(socket);
+}
+bool startSockets()
+{
+    return true;
+}
+}
+#endif
+
+UdpSocket::UdpSocket()
+    : mSocket { INVALID_SOCKET_HANDLE }
+    , mPeer {}
+    , mHasPeer { false }
+    , mLatencyMs { 0 }
+    , mJitterMs { 0 }
+    , mLossRate { 0.0 }
+    , mRandom { 1 }
+    , mDelayed {}
+    , mManualClock { false }
+    , mManualTime {}
+{
+}
+
+UdpSocket::~UdpSocket()
+{
+    close();
+}
+
+bool UdpSocket::open(uint16_t port, const std::string& address)
+{
+    close();
+    if (!startSockets())
+    {
+        printf("Unable to start the socket library!\n");
+        return false;
+    }
+
+    mSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (mSocket == INVALID_SOCKET_HANDLE)
+    {
+        printf("Unable to create UDP socket!\n");
+        return false;
+    }
+
+    sockaddr_in local {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    if (inet_pton(AF_INET, address.c_str(), &local.sin_addr) != 1
+        || bind(mSocket, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0)
+    {
+        printf("Unable to bind UDP socket to %s:%u!\n", address.c_str(), port);
+        close();
+        return false;
+    }
+
+    // Never block the game loop on the network
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(mSocket, FIONBIO, &nonBlocking);
+#else
+    fcntl(mSocket, F_SETFL, fcntl(mSocket, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    return true;
+}
+
+void UdpSocket::close()
+{
+    if (mSocket != INVALID_SOCKET_HANDLE)
+    {
+        closeSocket(mSocket);
+        mSocket = INVALID_SOCKET_HANDLE;
+    }
+    mDelayed.clear();
+}
+
+uint16_t UdpSocket::getLocalPort()
+{
+    sockaddr_in local {};
+    socklen_t length = sizeof(local);
+    if (getsockname(mSocket, reinterpret_cast<sockaddr*>(&local), &length) != 0)
+    {
+        return 0;
+    }
+    return ntohs(local.sin_port);
+}
+
+bool UdpSocket::setPeer(const std::string& address, uint16_t port)
+{
+    mPeer = sockaddr_in {};
+    mPeer.sin_family = AF_INET;
+    mPeer.sin_port = htons(port);
+    mHasPeer = inet_pton(AF_INET, address.c_str(), &mPeer.sin_addr) == 1;
+    if (!mHasPeer)
+    {
+        printf("Invalid peer address %s!\n", address.c_str());
+    }
+    return mHasPeer;
+}
+
+void UdpSocket::setImpairment(uint32_t latencyMs, uint32_t jitterMs, double lossRate, uint32_t seed)
+{
+    mLatencyMs = latencyMs;
+    mJitterMs = std::min(jitterMs, latencyMs);
+    mLossRate = lossRate;
+    mRandom.seed(seed);
+}
+
+void UdpSocket::useManualClock()
+{
+    mManualClock = true;
+}
+
+void UdpSocket::advanceClock(std::chrono::microseconds elapsed)
+{
+    mManualTime += elapsed;
+}
+
+std::chrono::steady_clock::time_point UdpSocket::now() const
+{
+    return mManualClock ? mManualTime : std::chrono::steady_clock::now();
+}
+
+bool UdpSocket::send(const uint8_t* data, size_t size)
+{
+    flushDelayed();
+    if (mLossRate > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(mRandom) < mLossRate)
+    {
+        // Pretend it got lost on the way
+        return true;
+    }
+    if (mLatencyMs == 0)
+    {
+        return sendNow(data, size);
+    }
+
+    int jitter = (mJitterMs > 0)
+        ? std::uniform_int_distribution<int>(-static_cast<int>(mJitterMs), static_cast<int>(mJitterMs))(mRandom)
+        : 0;
+    auto delay = std::chrono::milliseconds(static_cast<int>(mLatencyMs) + jitter);
+    mDelayed.push_back(DelayedPacket { now() + delay, std::vector<uint8_t>(data, data + size) });
+    return true;
+}
+
+size_t UdpSocket::receive(uint8_t* buffer, size_t capacity)
+{
+    flushDelayed();
+    if (mSocket == INVALID_SOCKET_HANDLE)
+    {
+        return 0;
+    }
+    auto received = recvfrom(mSocket, reinterpret_cast<char*>(buffer), static_cast<int>(capacity), 0, nullptr, nullptr);
+    return (received > 0) ? static_cast<size_t>(received) : 0;
+}
+
+bool UdpSocket::sendNow(const uint8_t* data, size_t size)
+{
+    if (mSocket == INVALID_SOCKET_HANDLE || !mHasPeer)
+    {
+        return false;
+    }
+    auto sent = sendto(mSocket,
+        reinterpret_cast<const char*>(data),
+        static_cast<int>(size),
+        0,
+        reinterpret_cast<const sockaddr*>(&mPeer),
+        sizeof(mPeer));
+    return sent == static_cast<decltype(sent)>(size);
+}
+
+void UdpSocket::flushDelayed()
+{
+    // Jitter can reorder packets, just like a real network
+    auto current = now();
+    auto due = std::stable_partition(mDelayed.begin(), mDelayed.end(),
+        [current](const DelayedPacket& packet)
+        {
+            return packet.sendTime > current;
+        });
+    for (auto it = due; it != mDelayed.end(); ++it)
+    {
+        sendNow(it->data.data(), it->data.size());
+    }
+    mDelayed.erase(due, mDelayed.end());
+}
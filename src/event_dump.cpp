@@ -0,0 +1,98 @@
+#include "engine/EventLog.h"
+#include "engine/LatencyHistogram.h"
+#include "tetris/GameEventLog.h"
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Prints the events in a log written with tetris_game --event-log, then a
+// summary: events by type, dropped events, frame times and every frame
+// slower than the stutter threshold with the tick that was on screen
+//
+// tetris_event_dump <log> [--summary] [--stutter-ms <ms>]
+int main(int argc, char* args[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: tetris_event_dump <log> [--summary] [--stutter-ms <ms>]\n");
+        return 1;
+    }
+    bool summaryOnly = false;
+    uint32_t stutterUs = 50000;
+    for (int index = 2; index < argc; ++index)
+    {
+        std::string option { args[index] };
+        if (option == "--summary")
+        {
+            summaryOnly = true;
+        }
+        else if (option == "--stutter-ms" && index + 1 < argc)
+        {
+            stutterUs = 1000 * static_cast<uint32_t>(std::strtoul(args[++index], nullptr, 10));
+        }
+    }
+
+    EventLogReader reader;
+    if (!reader.open(args[1]))
+    {
+        return 1;
+    }
+
+    std::array<uint64_t, 256> counts {};
+    uint64_t dropped = 0;
+    uint64_t stutters = 0;
+    LatencyHistogram frameTimes;
+    LogEvent event;
+    while (reader.next(event))
+    {
+        counts[event.type]++;
+        if (!summaryOnly)
+        {
+            printf("%10.3f ms  tick %7u  %-10s %d %d\n",
+                static_cast<double>(event.timeUs) / 1000.0,
+                event.tick,
+                gameEventName(event.type),
+                event.args[0],
+                event.args[1]);
+        }
+        if (event.type == EVENT_LOG_DROPPED)
+        {
+            dropped += static_cast<uint64_t>(event.args[1]);
+        }
+        else if (event.type == GAME_EVENT_FRAME && event.args[0] >= 0)
+        {
+            uint32_t frameUs = static_cast<uint32_t>(event.args[0]);
+            frameTimes.record(frameUs);
+            if (frameUs >= stutterUs)
+            {
+                stutters++;
+                printf("Stutter: %.1f ms frame at %.3f s, tick %u on screen\n",
+                    frameUs / 1000.0,
+                    static_cast<double>(event.timeUs) / 1e6,
+                    event.tick);
+            }
+        }
+    }
+
+    printf("\nEvents:");
+    for (size_t type = 0; type < counts.size(); ++type)
+    {
+        if (counts[type] > 0)
+        {
+            printf("  %s %llu", gameEventName(static_cast<uint8_t>(type)), static_cast<unsigned long long>(counts[type]));
+        }
+    }
+    printf("\nDropped: %llu\n", static_cast<unsigned long long>(dropped));
+    if (frameTimes.getCount() > 0)
+    {
+        LatencyPercentiles frames = frameTimes.getPercentiles();
+        printf("Frame time us: p50 %u  p99 %u  max %u  (%llu stutters over %u ms)\n",
+            frames.p50,
+            frames.p99,
+            frames.max,
+            static_cast<unsigned long long>(stutters),
+            stutterUs / 1000);
+    }
+    return 0;
+}
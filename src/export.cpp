@@ -0,0 +1,92 @@
+#include "engine/FrameExporter.h"
+#include "tetris/ReplayCorpus.h"
+#include "tetris/Tetris.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Plays a replay from a corpus headless, drawing one frame per simulation
+// tick exactly as tetris_game would, and writes the frames out. There is
+// no vsync and no real time to wait for, and frames are encoded on a
+// thread pool, so an export runs much faster than the game did
+//
+// tetris_export <corpus> <replay> <out> [--y4m] [--threads <n>]
+//
+// <out> is an existing directory for a PNG sequence, or with --y4m a
+// .y4m file
+int main(int argc, char* args[])
+{
+    if (argc < 4)
+    {
+        printf("Usage: tetris_export <corpus> <replay> <out> [--y4m] [--threads <n>]\n");
+        return 1;
+    }
+    ExportFormat format = ExportFormat::PNG;
+    size_t threads = 0;
+    for (int index = 4; index < argc; ++index)
+    {
+        std::string option { args[index] };
+        if (option == "--y4m")
+        {
+            format = ExportFormat::Y4M;
+        }
+        else if (option == "--threads" && index + 1 < argc)
+        {
+            threads = std::strtoul(args[++index], nullptr, 10);
+        }
+    }
+
+    ReplayCorpus corpus;
+    if (!corpus.open(args[1]))
+    {
+        return 1;
+    }
+    size_t replayIndex = std::strtoul(args[2], nullptr, 10);
+    if (replayIndex >= corpus.size())
+    {
+        printf("Replay %zu is out of range, the corpus has %zu\n", replayIndex, corpus.size());
+        return 1;
+    }
+    ReplayView replay = corpus.getReplay(replayIndex);
+
+    // The replay is played on a simulation of our own, with the same seed and
+    // settings the replay was recorded with. Each tick is restored into the
+    // engine and drawn
+    auto textures = makeHeadlessTextures();
+    TetrisSimulation simulation { textures, replay.metadata->seed };
+    TetrisGameEngine tetris {};
+    if (!tetris.startHeadless())
+    {
+        return 1;
+    }
+
+    // One frame per tick, TICK_MS apart
+    const SDL_Surface* frame = tetris.getFrame();
+    FrameExporter exporter;
+    if (!exporter.open(format, args[3], frame->w, frame->h, 1000, static_cast<int>(TICK_MS), threads))
+    {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    tetris.restore(simulation.snapshot());
+    bool ok = tetris.drawHeadlessFrame() && exporter.push(frame);
+    for (size_t tick = 0; ok && tick < replay.length && simulation.isPlaying(); ++tick)
+    {
+        simulation.step(replay.inputs[tick]);
+        tetris.restore(simulation.snapshot());
+        ok = tetris.drawHeadlessFrame(TICK_MS) && exporter.push(frame);
+    }
+    ok = exporter.close() && ok;
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double played = static_cast<double>(exporter.getFramesWritten() * TICK_MS) / 1000.0;
+    printf("Exported %zu frames, %.1f s of play in %.1f s (%.1fx real time)%s\n",
+        exporter.getFramesWritten(),
+        played,
+        elapsed.count(),
+        played / elapsed.count(),
+        ok ? "" : ", with errors");
+    return ok ? 0 : 1;
+}
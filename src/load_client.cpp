@@ -0,0 +1,268 @@
+#include "engine/LatencyHistogram.h"
+#include "engine/Texture.h"
+#include "engine/UdpSocket.h"
+#include "tetris/Bot.h"
+#include "tetris/MatchProtocol.h"
+#include "tetris/Simulation.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Load test for tetris_server. Plays the given number of matches at once,
+// two bot clients per match, and prints the round trip time from sending
+// an input to getting back the state that used it. Finished matches are
+// replaced with new ones
+//
+// tetris_load_client <matches> [--address <ip>] [--port <base port>] [--shards <n>] [--threads <n>] [--seconds <n>]
+namespace
+{
+constexpr uint32_t SEND_TIME_WINDOW = 64; // inputs in flight we can match up with an ack
+
+struct LoadConfig
+{
+    size_t matches { 1 };
+    std::string address { "127.0.0.1" };
+    uint16_t basePort { MATCH_SERVER_DEFAULT_PORT };
+    size_t shards { std::max<size_t>(std::thread::hardware_concurrency(), 1) }; // must match the server
+    size_t threads { 1 };
+    uint32_t seconds { 10 };
+};
+
+struct LoadStats
+{
+    uint64_t packetsOut { 0 };
+    uint64_t packetsIn { 0 };
+    uint64_t matchesFinished { 0 };
+    LatencyHistogram roundTripUs;
+};
+
+// One player. The bot plays a local copy of the game to choose its inputs,
+// the server's copy is the one that counts
+struct Client
+{
+    UdpSocket socket;
+    std::unique_ptr<TetrisSimulation> simulation;
+    Bot bot { 0 };
+    uint32_t matchId { 0 };
+    uint8_t player { 0 };
+    uint32_t sequence { 0 };
+    uint32_t lastAck { 0 };
+    std::array<std::chrono::steady_clock::time_point, SEND_TIME_WINDOW> sendTimes {};
+};
+
+std::atomic<bool> gQuit { false };
+
+class ClientThread
+{
+public:
+    ClientThread(const LoadConfig& config, size_t firstMatch, size_t matches)
+        : mConfig { config }
+        , mTextures { makeHeadlessTextures() }
+        , mClients {}
+        , mThread {}
+        , mStatsMutex {}
+        , mStats {}
+    {
+        for (size_t match = firstMatch; match < firstMatch + matches; ++match)
+        {
+            for (uint8_t player = 0; player < 2; ++player)
+            {
+                auto client = std::make_unique<Client>();
+                client->player = player;
+                if (!client->socket.open(0))
+                {
+                    continue;
+                }
+                joinMatch(*client, static_cast<uint32_t>(match));
+                mClients.push_back(std::move(client));
+            }
+        }
+        mThread = std::thread(&ClientThread::run, this);
+    }
+
+    ~ClientThread()
+    {
+        mThread.join();
+    }
+
+    void takeStats(LoadStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        stats.packetsOut += mStats.packetsOut;
+        stats.packetsIn += mStats.packetsIn;
+        stats.matchesFinished += mStats.matchesFinished;
+        stats.roundTripUs.merge(mStats.roundTripUs);
+        mStats = LoadStats {};
+    }
+
+private:
+    void joinMatch(Client& client, uint32_t matchId)
+    {
+        client.matchId = matchId;
+        client.socket.setPeer(mConfig.address, matchServerPort(mConfig.basePort, matchId, mConfig.shards));
+        client.simulation = std::make_unique<TetrisSimulation>(mTextures, matchId);
+        client.bot = Bot { uint64_t { matchId } * 2 + client.player };
+    }
+
+    void run()
+    {
+        auto nextTick = std::chrono::steady_clock::now();
+        while (!gQuit)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mStatsMutex);
+                for (auto& client : mClients)
+                {
+                    receive(*client);
+                    send(*client);
+                }
+            }
+            nextTick += std::chrono::milliseconds(TICK_MS);
+            std::this_thread::sleep_until(nextTick);
+        }
+    }
+
+    void receive(Client& client)
+    {
+        uint8_t buffer[MATCH_STATE_PACKET_SIZE];
+        bool finished = false;
+        auto now = std::chrono::steady_clock::now();
+        size_t received = 0;
+        while ((received = client.socket.receive(buffer, sizeof(buffer))) > 0)
+        {
+            MatchStatePacket state;
+            if (!decodeMatchState(buffer, received, state) || state.matchId != client.matchId)
+            {
+                continue;
+            }
+            mStats.packetsIn++;
+            if (state.ackSequence > client.lastAck && client.sequence - state.ackSequence < SEND_TIME_WINDOW)
+            {
+                auto sent = client.sendTimes[state.ackSequence % SEND_TIME_WINDOW];
+                mStats.roundTripUs.record(static_cast<uint32_t>(
+                    std::chrono::duration_cast<std::chrono::microseconds>(now - sent).count()));
+                client.lastAck = state.ackSequence;
+            }
+            finished = finished || (!state.playing[0] && !state.playing[1]);
+        }
+
+        // Both clients see the end of the match and move on to the same new one
+        if (finished)
+        {
+            if (client.player == 0)
+            {
+                mStats.matchesFinished++;
+            }
+            joinMatch(client, client.matchId + static_cast<uint32_t>(mConfig.matches));
+        }
+    }
+
+    void send(Client& client)
+    {
+        if (!client.simulation->isPlaying())
+        {
+            client.simulation = std::make_unique<TetrisSimulation>(mTextures, client.sequence);
+        }
+        uint8_t input = client.bot.nextInput(*client.simulation);
+        client.simulation->step(input);
+
+        MatchInputPacket packet {};
+        packet.matchId = client.matchId;
+        packet.player = client.player;
+        packet.sequence = ++client.sequence;
+        packet.input = input;
+        uint8_t buffer[MATCH_INPUT_PACKET_SIZE];
+        encodeMatchInput(packet, buffer);
+        client.sendTimes[packet.sequence % SEND_TIME_WINDOW] = std::chrono::steady_clock::now();
+        if (client.socket.send(buffer, sizeof(buffer)))
+        {
+            mStats.packetsOut++;
+        }
+    }
+
+    const LoadConfig& mConfig;
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>> mTextures;
+    std::vector<std::unique_ptr<Client>> mClients;
+    std::thread mThread;
+    std::mutex mStatsMutex;
+    LoadStats mStats;
+};
+}
+
+int main(int argc, char* args[])
+{
+    LoadConfig config {};
+    int index = 1;
+    if (argc > index && args[index][0] != '-')
+    {
+        config.matches = std::max<size_t>(1, std::strtoul(args[index++], nullptr, 10));
+    }
+    for (; index + 1 < argc; ++index)
+    {
+        std::string option { args[index] };
+        if (option == "--address")
+        {
+            config.address = args[++index];
+        }
+        else if (option == "--port")
+        {
+            config.basePort = static_cast<uint16_t>(std::strtoul(args[++index], nullptr, 10));
+        }
+        else if (option == "--shards")
+        {
+            config.shards = std::max<size_t>(1, std::strtoul(args[++index], nullptr, 10));
+        }
+        else if (option == "--threads")
+        {
+            config.threads = std::max<size_t>(1, std::strtoul(args[++index], nullptr, 10));
+        }
+        else if (option == "--seconds")
+        {
+            config.seconds = static_cast<uint32_t>(std::strtoul(args[++index], nullptr, 10));
+        }
+    }
+
+    printf("Playing %zu matches against %s:%u with %zu threads\n",
+        config.matches, config.address.c_str(), config.basePort, config.threads);
+    std::vector<std::unique_ptr<ClientThread>> threads;
+    size_t threadCount = std::min(config.threads, config.matches);
+    for (size_t thread = 0; thread < threadCount; ++thread)
+    {
+        size_t first = config.matches * thread / threadCount;
+        size_t last = config.matches * (thread + 1) / threadCount;
+        threads.push_back(std::make_unique<ClientThread>(config, first, last - first));
+    }
+
+    auto last = std::chrono::steady_clock::now();
+    for (uint32_t elapsed = 0; elapsed < config.seconds; ++elapsed)
+    {
+        std::this_thread::sleep_until(last + std::chrono::seconds(1));
+        auto now = std::chrono::steady_clock::now();
+        double interval = std::chrono::duration<double>(now - last).count();
+        last = now;
+
+        LoadStats stats {};
+        for (auto& thread : threads)
+        {
+            thread->takeStats(stats);
+        }
+        LatencyPercentiles roundTrip = stats.roundTripUs.getPercentiles();
+        printf("packets/s out %.0f in %.0f | matches finished %llu | round trip p50 %u us, p99 %u us, max %u us\n",
+            static_cast<double>(stats.packetsOut) / interval,
+            static_cast<double>(stats.packetsIn) / interval,
+            static_cast<unsigned long long>(stats.matchesFinished),
+            roundTrip.p50,
+            roundTrip.p99,
+            roundTrip.max);
+    }
+
+    gQuit = true;
+    threads.clear();
+    return 0;
+}
@@ -1,9 +1,99 @@
 #define SDL_MAIN_HANDLED
 
+#include "tetris/Spectator.h"
 #include "tetris/Tetris.h"
+#include "tetris/Versus.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
 
+// tetris_game [--das <ticks>] [--arr <ticks>] [--rows <rows>] [--cols <cols>] [--publish-state [name]] [--event-log <path>] [--latency] [--hot-reload] [--cpu-usage] [--record [seconds]]
+// tetris_game --versus <player 0|1> <local port> <remote port> [latency ms] [loss 0-1] [jitter ms] [--latency]
+// tetris_game --spectate [boards] [--replays <corpus>] [--block-size <px>]
 int main(int argc, char* args[])
 {
-    TetrisGameEngine tetris {};
+    if (argc >= 2 && std::string(args[1]) == "--spectate")
+    {
+        SpectatorConfig config {};
+        int index = 2;
+        if (argc > index && args[index][0] != '-')
+        {
+            config.boards = std::max<size_t>(1, std::strtoul(args[index++], nullptr, 10));
+        }
+        for (; index + 1 < argc; ++index)
+        {
+            std::string option { args[index] };
+            if (option == "--replays")
+            {
+                config.replayPath = args[++index];
+            }
+            else if (option == "--block-size")
+            {
+                config.blockSize = std::max(2, std::atoi(args[++index]));
+            }
+        }
+        SpectatorGameEngine spectator { config };
+        return spectator.run(argc, args);
+    }
+
+    if (argc >= 5 && std::string(args[1]) == "--versus")
+    {
+        VersusConfig config {};
+        config.localPlayer = std::strtoul(args[2], nullptr, 10) == 0 ? 0 : 1;
+        config.localPort = static_cast<uint16_t>(std::strtoul(args[3], nullptr, 10));
+        config.remotePort = static_cast<uint16_t>(std::strtoul(args[4], nullptr, 10));
+        config.latencyMs = (argc > 5) ? static_cast<uint32_t>(std::strtoul(args[5], nullptr, 10)) : 0;
+        config.lossRate = (argc > 6) ? std::strtod(args[6], nullptr) : 0.0;
+        config.jitterMs = (argc > 7) ? static_cast<uint32_t>(std::strtoul(args[7], nullptr, 10)) : 0;
+        VersusGameEngine versus { config };
+        return versus.run(argc, args);
+    }
+
+    AutoShiftSettings autoShift {};
+    BoardSize board {};
+    std::string sharedStateName;
+    std::string eventLogPath;
+    for (int index = 1; index < argc; ++index)
+    {
+        if (std::string(args[index]) == "--publish-state")
+        {
+            bool named = index + 1 < argc && args[index + 1][0] != '-';
+            sharedStateName = named ? args[index + 1] : TETRIS_SHARED_STATE_NAME;
+        }
+    }
+    for (int index = 1; index + 1 < argc; ++index)
+    {
+        std::string option { args[index] };
+        if (option == "--das")
+        {
+            autoShift.delayTicks = static_cast<uint32_t>(std::strtoul(args[++index], nullptr, 10));
+        }
+        else if (option == "--arr")
+        {
+            autoShift.repeatTicks = static_cast<uint32_t>(std::strtoul(args[++index], nullptr, 10));
+        }
+        else if (option == "--rows")
+        {
+            board.rows = std::strtoul(args[++index], nullptr, 10);
+        }
+        else if (option == "--cols")
+        {
+            board.cols = std::strtoul(args[++index], nullptr, 10);
+        }
+        else if (option == "--event-log")
+        {
+            eventLogPath = args[++index];
+        }
+    }
+
+    if (board.rows < MIN_BOARD_ROWS || board.cols < MIN_BOARD_COLS || !fitsInGameState(board))
+    {
+        printf("The board must be between %zux%zu and %zux%zu blocks! tetris_stress plays bigger boards headless\n",
+            MIN_BOARD_COLS, MIN_BOARD_ROWS, MAX_STATE_COLS, MAX_STATE_ROWS);
+        return 1;
+    }
+
+    TetrisGameEngine tetris { autoShift, board, sharedStateName, eventLogPath };
     return tetris.run(argc, args);
 }
@@ -0,0 +1,93 @@
+#include "tetris/MatchServer.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+namespace
+{
+volatile std::sig_atomic_t gQuit = 0;
+
+void onSignal(int)
+{
+    gQuit = 1;
+}
+}
+
+// Hosts versus matches for clients such as tetris_load_client, and prints
+// throughput and tick latency once a second until interrupted
+//
+// tetris_server [--address <ip>] [--port <base port>] [--shards <n>] [--seconds <n>] [--no-pin]
+int main(int argc, char* args[])
+{
+    MatchServerConfig config {};
+    uint32_t seconds = 0;
+    for (int index = 1; index < argc; ++index)
+    {
+        std::string option { args[index] };
+        if (option == "--no-pin")
+        {
+            config.pinThreads = false;
+        }
+        else if (index + 1 >= argc)
+        {
+            break;
+        }
+        else if (option == "--address")
+        {
+            config.address = args[++index];
+        }
+        else if (option == "--port")
+        {
+            config.basePort = static_cast<uint16_t>(std::strtoul(args[++index], nullptr, 10));
+        }
+        else if (option == "--shards")
+        {
+            config.shards = std::strtoul(args[++index], nullptr, 10);
+        }
+        else if (option == "--seconds")
+        {
+            seconds = static_cast<uint32_t>(std::strtoul(args[++index], nullptr, 10));
+        }
+    }
+
+    MatchServer server { config };
+    if (!server.start())
+    {
+        return 1;
+    }
+    printf("Serving matches on %s ports %u-%u with %zu shards\n",
+        config.address.c_str(),
+        server.getPort(0),
+        server.getPort(server.getShardCount() - 1),
+        server.getShardCount());
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    auto last = std::chrono::steady_clock::now();
+    for (uint32_t elapsed = 0; !gQuit && (seconds == 0 || elapsed < seconds); ++elapsed)
+    {
+        std::this_thread::sleep_until(last + std::chrono::seconds(1));
+        auto now = std::chrono::steady_clock::now();
+        double interval = std::chrono::duration<double>(now - last).count();
+        last = now;
+
+        MatchServerStats stats = server.takeStats();
+        LatencyPercentiles latency = stats.tickLatencyUs.getPercentiles();
+        printf("matches %zu (+%llu -%llu) | ticks/s %.0f | packets/s in %.0f out %.0f | tick latency p50 %u us, p99 %u us, max %u us\n",
+            stats.matches,
+            static_cast<unsigned long long>(stats.matchesStarted),
+            static_cast<unsigned long long>(stats.matchesDropped),
+            static_cast<double>(stats.ticks) / interval,
+            static_cast<double>(stats.packetsIn) / interval,
+            static_cast<double>(stats.packetsOut) / interval,
+            latency.p50,
+            latency.p99,
+            latency.max);
+    }
+
+    server.stop();
+    return 0;
+}
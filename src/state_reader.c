@@ -0,0 +1,91 @@
+// Sample consumer of tetris_game --publish-state. Maps the shared memory
+// read only and prints the board whenever a new tick is published
+//
+// tetris_state_reader [name] [seconds]
+
+#include "tetris/SharedState.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint64_t nowUs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000u + (uint64_t)now.tv_nsec / 1000u;
+}
+
+static void printSnapshot(const TetrisSharedSnapshot* snapshot)
+{
+    int row;
+    int col;
+    int pieceRow = snapshot->pieceY / (int)snapshot->blockSize;
+    int pieceCol = snapshot->pieceX / (int)snapshot->blockSize;
+
+    printf("tick %u  score %u  %s  step %u us  age %llu us\n",
+        snapshot->tick,
+        snapshot->score,
+        snapshot->playing ? "playing" : "game over",
+        snapshot->stepTimeUs,
+        (unsigned long long)(nowUs() - snapshot->publishTimeUs));
+    for (row = 0; row < snapshot->rows; ++row)
+    {
+        putchar('|');
+        for (col = 0; col < snapshot->cols; ++col)
+        {
+            int pieceY = row - pieceRow;
+            int pieceX = col - pieceCol;
+            int inPiece = pieceY >= 0 && pieceY < snapshot->pieceRows && pieceX >= 0 && pieceX < snapshot->pieceCols
+                && snapshot->pieceCells[pieceY][pieceX] != 0;
+            int onBoard = (snapshot->boardRows[row] >> col) & 1u;
+            putchar(inPiece ? '@' : onBoard ? '#' : ' ');
+        }
+        puts("|");
+    }
+}
+
+int main(int argc, char* args[])
+{
+    const char* name = (argc > 1) ? args[1] : TETRIS_SHARED_STATE_NAME;
+    int seconds = (argc > 2) ? atoi(args[2]) : 0;
+    int fd = shm_open(name, O_RDONLY, 0);
+    const TetrisSharedState* state;
+    TetrisSharedSnapshot snapshot = { 0 };
+    uint32_t lastTick = UINT32_MAX;
+    uint64_t deadline = nowUs() + (uint64_t)seconds * 1000000u;
+
+    if (fd < 0)
+    {
+        printf("Unable to open shared memory %s, is tetris_game running with --publish-state?\n", name);
+        return 1;
+    }
+    state = (const TetrisSharedState*)mmap(NULL, sizeof(TetrisSharedState), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (state == MAP_FAILED)
+    {
+        printf("Unable to map shared memory %s!\n", name);
+        return 1;
+    }
+    if (__atomic_load_n(&state->magic, __ATOMIC_ACQUIRE) != TETRIS_SHARED_STATE_MAGIC
+        || state->version != TETRIS_SHARED_STATE_VERSION
+        || state->snapshotSize != sizeof(TetrisSharedSnapshot))
+    {
+        printf("Shared memory %s is not a version %u game state!\n", name, TETRIS_SHARED_STATE_VERSION);
+        return 1;
+    }
+
+    while (seconds == 0 || nowUs() < deadline)
+    {
+        if (tetris_shared_state_read(state, &snapshot, 100) && snapshot.tick != lastTick)
+        {
+            lastTick = snapshot.tick;
+            printSnapshot(&snapshot);
+        }
+        usleep(snapshot.tickMs > 0 ? snapshot.tickMs * 1000u : 16000u);
+    }
+    munmap((void*)state, sizeof(TetrisSharedState));
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include "tetris/Bot.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+// Plays bot games headless on a board of any size the simulation allows,
+// including boards far too big for a GameState or a window, and reports
+// how fast it steps. Nothing is snapshotted or drawn. A game that ends is
+// restarted with the next seed
+//
+// tetris_stress [--rows <rows>] [--cols <cols>] [--ticks <n>] [--seed <n>]
+int main(int argc, char* args[])
+{
+    BoardSize board {};
+    uint64_t ticks = 100000;
+    uint64_t seed = 1;
+    for (int index = 1; index + 1 < argc; ++index)
+    {
+        std::string option { args[index] };
+        if (option == "--rows")
+        {
+            board.rows = std::strtoul(args[++index], nullptr, 10);
+        }
+        else if (option == "--cols")
+        {
+            board.cols = std::strtoul(args[++index], nullptr, 10);
+        }
+        else if (option == "--ticks")
+        {
+            ticks = std::strtoull(args[++index], nullptr, 10);
+        }
+        else if (option == "--seed")
+        {
+            seed = std::strtoull(args[++index], nullptr, 10);
+        }
+    }
+    if (board.rows < MIN_BOARD_ROWS || board.cols < MIN_BOARD_COLS || board.cols > MAX_BOARD_COLS)
+    {
+        printf("The board must be at least %zux%zu blocks and at most %zu wide!\n",
+            MIN_BOARD_COLS, MIN_BOARD_ROWS, MAX_BOARD_COLS);
+        return 1;
+    }
+
+    auto textures = makeHeadlessTextures();
+    auto simulation = std::make_unique<TetrisSimulation>(textures, seed, AutoShiftSettings {}, board);
+    Bot bot { seed };
+    uint64_t games = 1;
+    uint64_t score = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t tick = 0; tick < ticks; ++tick)
+    {
+        if (!simulation->isPlaying())
+        {
+            score += simulation->getScore();
+            simulation = std::make_unique<TetrisSimulation>(textures, seed + games, AutoShiftSettings {}, board);
+            bot = Bot { seed + games };
+            games++;
+        }
+        simulation->step(bot.nextInput(*simulation));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    score += simulation->getScore();
+
+    printf("%zux%zu board: %llu ticks in %.2f s, %.0f ticks/s, %.2f us a tick\n",
+        board.cols,
+        board.rows,
+        static_cast<unsigned long long>(ticks),
+        elapsed.count(),
+        static_cast<double>(ticks) / elapsed.count(),
+        1e6 * elapsed.count() / static_cast<double>(ticks));
+    printf("%llu games, %llu points\n", static_cast<unsigned long long>(games), static_cast<unsigned long long>(score));
+    return 0;
+}
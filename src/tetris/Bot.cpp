@@ -0,0 +1,49 @@
+#include "tetris/Bot.h"
+
+Bot::Bot(uint64_t seed)
+    : mState { seed }
+    , mTick { 0 }
+{
+}
+
+uint32_t Bot::nextRandom(uint32_t n)
+{
+    mState += 0x9E3779B97F4A7C15ull;
+    uint64_t z = mState;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z = z ^ (z >> 31);
+    return static_cast<uint32_t>((z >> 32) % n);
+}
+
+uint8_t Bot::nextInput(TetrisSimulation& simulation)
+{
+    Grid& piece = simulation.getCurrentTetronimo();
+    if (piece.getPosY() < mLastPosY)
+    {
+        // A new piece was dealt - decide where it goes
+        size_t columns = simulation.getGameBoard().getWidth() - piece.getWidth() + 1;
+        mRotationsLeft = static_cast<int>(nextRandom(4));
+        mTargetCol = static_cast<int>(nextRandom(static_cast<uint32_t>(columns)));
+    }
+    mLastPosY = piece.getPosY();
+    mTick++;
+
+    int col = piece.getPosX() / BLOCK_SIZE;
+    if (mRotationsLeft == 0 && col == mTargetCol)
+    {
+        return INPUT_DOWN;
+    }
+
+    // Let go every other tick, so each tap is a fresh press
+    if (mTick % 2 == 0)
+    {
+        return INPUT_NONE;
+    }
+    if (mRotationsLeft > 0)
+    {
+        mRotationsLeft--;
+        return INPUT_ROTATE;
+    }
+    return (col > mTargetCol) ? (INPUT_LEFT | INPUT_LEFT_PRESSED) : (INPUT_RIGHT | INPUT_RIGHT_PRESSED);
+}
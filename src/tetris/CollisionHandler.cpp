@@ -1,10 +1,6 @@
 #include "tetris/CollisionHandler.h"
 
-CollisionHandler::CollisionHandler(Texture* whiteFlashTexture, Texture* blackFlashTexture, uint32_t currentTime)
-    : mPreviousTime { 0 }
-    , mCurrentTime { currentTime }
-    , mWhiteFlashTexture { whiteFlashTexture }
-    , mBlackFlashTexture { blackFlashTexture }
+CollisionHandler::CollisionHandler()
 {
 }
 
@@ -13,23 +9,41 @@ bool CollisionHandler::keepPlaying()
     return mKeepPlaying;
 }
 
-bool CollisionHandler::handle(Grid& tetronimo, Grid& gameBoard, uint32_t currentTime)
+const LineClear& CollisionHandler::getLastClear() const
 {
-    mCurrentTime = currentTime;
+    return mLastClear;
+}
 
-    // If we are midway through animating a completed row, do this branch instead
-    if (mFinishedRowRoutine)
-    {
-        return animateCompletedRows(gameBoard);
-    }
+const HardDrop& CollisionHandler::getLastDrop() const
+{
+    return mLastDrop;
+}
 
-    // Cap horizontal movements and rotations to a certain frequency
-    if ((mCurrentTime - mPreviousTime) >= INPUT_INTERVAL_MS)
-    {
-        mPreviousTime = mCurrentTime;
-        handleHorizontal(tetronimo, gameBoard);
-        handleRotational(tetronimo, gameBoard);
-    }
+void CollisionHandler::snapshot(GameState& state) const
+{
+    state.lastClear = mLastClear;
+    state.lastDrop = mLastDrop;
+    state.keepPlaying = mKeepPlaying;
+}
+
+void CollisionHandler::restore(const GameState& state)
+{
+    mLastClear = state.lastClear;
+    mLastDrop = state.lastDrop;
+    mKeepPlaying = state.keepPlaying;
+}
+
+void CollisionHandler::setListener(CollisionListener* listener)
+{
+    mListener = listener;
+}
+
+bool CollisionHandler::handle(Grid& tetronimo, Grid& gameBoard)
+{
+    // Horizontal moves are already rate limited by AutoShift, and a
+    // rotation is applied on the tick it was pressed
+    handleHorizontal(tetronimo, gameBoard);
+    handleRotational(tetronimo, gameBoard);
 
     // Move the block vertically - return whether we need a new tetronimo
     return handleVertical(tetronimo, gameBoard);
@@ -38,11 +52,16 @@ bool CollisionHandler::handle(Grid& tetronimo, Grid& gameBoard, uint32_t current
 void CollisionHandler::handleHorizontal(Grid& tetronimo, Grid& gameBoard)
 {
     // Move the block horizontally
+    int posX = tetronimo.getPosX();
     tetronimo.move(1, 0);
     if (hasCollided(tetronimo, gameBoard))
     {
         tetronimo.move(-1, 0);
     };
+    if (mListener != nullptr && tetronimo.getPosX() != posX)
+    {
+        mListener->pieceMoved((tetronimo.getPosX() - posX) / BLOCK_SIZE);
+    }
 }
 
 void CollisionHandler::handleRotational(Grid& tetronimo, Grid& gameBoard)
@@ -55,11 +74,20 @@ void CollisionHandler::handleRotational(Grid& tetronimo, Grid& gameBoard)
         {
             tetronimo.rotateAntiClockwise();
         }
+        else if (mListener != nullptr)
+        {
+            mListener->pieceRotated();
+        }
     };
 }
 
 bool CollisionHandler::handleVertical(Grid& tetronimo, Grid& gameBoard)
 {
+    if (tetronimo.shouldHardDrop())
+    {
+        hardDrop(tetronimo, gameBoard);
+    }
+
     bool newTetronimoRequired = false;
     tetronimo.move(0, 1);
     if (hasCollided(tetronimo, gameBoard))
@@ -75,11 +103,65 @@ bool CollisionHandler::handleVertical(Grid& tetronimo, Grid& gameBoard)
     return newTetronimoRequired;
 }
 
+void CollisionHandler::hardDrop(Grid& tetronimo, Grid& gameBoard)
+{
+    // Fall a block at a time while there is room, then a pixel at a time,
+    // and stop one pixel short. The normal fall below then lands the piece
+    // exactly like one that got there by itself
+    int startY = tetronimo.getPosY();
+    for (int step : { BLOCK_SIZE, VERTICAL_VELOCITY })
+    {
+        tetronimo.setVelY(step);
+        while (!hasCollided(tetronimo, gameBoard))
+        {
+            tetronimo.move(0, 1);
+        }
+        tetronimo.move(0, -1);
+    }
+    tetronimo.setVelY(VERTICAL_VELOCITY);
+
+    // Which columns the piece covers and where its lowest block lands
+    uint64_t columns = 0;
+    size_t lowestRow = 0;
+    for (size_t yIndex = 0; yIndex < tetronimo.getHeight(); ++yIndex)
+    {
+        uint64_t mask = tetronimo.getRowMask(yIndex);
+        columns |= mask;
+        lowestRow = (mask != 0) ? yIndex : lowestRow;
+    }
+    if (columns == 0)
+    {
+        return;
+    }
+    int firstColumn = 0;
+    while (((columns >> firstColumn) & 1) == 0)
+    {
+        ++firstColumn;
+    }
+    int lastColumn = 63;
+    while (((columns >> lastColumn) & 1) == 0)
+    {
+        --lastColumn;
+    }
+    int landedRow = (tetronimo.getPosY() + VERTICAL_VELOCITY) / BLOCK_SIZE;
+    mLastDrop = HardDrop {
+        mLastDrop.drops + 1,
+        static_cast<uint8_t>(tetronimo.getPosX() / BLOCK_SIZE + firstColumn),
+        static_cast<uint8_t>(lastColumn - firstColumn + 1),
+        static_cast<uint16_t>(landedRow + static_cast<int>(lowestRow)),
+        static_cast<uint16_t>((landedRow * BLOCK_SIZE - startY) / BLOCK_SIZE)
+    };
+}
+
 void CollisionHandler::freezeTetronimo(Grid& tetronimo, Grid& gameBoard)
 {
     // find nearest whole number of blocks on game board
     int rowOnGameBoard = tetronimo.getPosY() / BLOCK_SIZE;
     int colOnGameBoard = tetronimo.getPosX() / BLOCK_SIZE;
+    if (mListener != nullptr)
+    {
+        mListener->pieceLocked();
+    }
 
     tetronimo.forEachBlock(
         [this, &gameBoard, rowOnGameBoard, colOnGameBoard](Block& block, size_t xIndex, size_t yIndex)
@@ -99,103 +181,107 @@ void CollisionHandler::freezeTetronimo(Grid& tetronimo, Grid& gameBoard)
 void CollisionHandler::handleCompletedRows(Grid& tetronimo, Grid& gameBoard)
 {
     // work out which rows have been completed
+    std::array<size_t, MAX_COMPLETED_ROWS> completedRows {};
+    size_t numberOfCompletedRows = 0;
     int rowOnGameBoard = tetronimo.getPosY() / BLOCK_SIZE;
-    int colOnGameBoard = tetronimo.getPosX() / BLOCK_SIZE;
-    std::vector<int> completedRows;
     for (int yIndex = 0; yIndex < tetronimo.getHeight(); ++yIndex)
     {
         int rowNum = rowOnGameBoard + yIndex;
         if ((rowNum < gameBoard.getHeight()) && checkForCompletedRow(rowNum, gameBoard))
         {
-            mCompletedRows.push_back(rowNum);
+            completedRows[numberOfCompletedRows++] = static_cast<size_t>(rowNum);
         }
     }
 
-    if (mCompletedRows.size() > 0)
+    // delete the completed rows and move existing rows down. Nothing waits
+    // for an animation, the next piece starts falling on the next tick
+    if (numberOfCompletedRows == 0)
     {
-        // start the finished row animation routine
-        mFinishedRowRoutine = true;
-        setFlashingTexture(mCompletedRows, gameBoard, mBlackFlashTexture);
+        return;
     }
-}
 
-bool CollisionHandler::checkForCompletedRow(int rowNum, Grid& gameBoard)
-{
-    for (int xIndex = 0; xIndex < gameBoard.getWidth(); ++xIndex)
+    // Usually the rows are adjacent and go in one move. If there is an
+    // incomplete row between them, each run of rows is deleted on its own,
+    // top run first, so the rows below it haven't moved yet
+    LineClear clear { mLastClear.clears + 1, 0, 0, 0 };
+    size_t first = 0;
+    for (size_t index = 1; index <= numberOfCompletedRows; ++index)
     {
-        if (!gameBoard.getBlock(xIndex, rowNum).exists())
+        if (index < numberOfCompletedRows && completedRows[index] == completedRows[index - 1] + 1)
         {
-            return false;
+            continue;
         }
+        size_t bottomRow = completedRows[index - 1];
+        size_t count = index - first;
+        gameBoard.moveRowsDown(bottomRow, count);
+        clear.addRows(bottomRow, count);
+        if (mListener != nullptr)
+        {
+            mListener->rowsCleared(bottomRow, count);
+        }
+        first = index;
     }
-    return true;
+    mLastClear = clear;
 }
 
-bool CollisionHandler::animateCompletedRows(Grid& gameBoard)
+bool CollisionHandler::checkForCompletedRow(int rowNum, Grid& gameBoard)
 {
-    if (mCurrentTime >= mFlashRowTransitionTime)
-    {
-        setFlashingTexture(mCompletedRows, gameBoard, (mNumberOfFlashesRemaining % 2 == 0) ? mBlackFlashTexture : mWhiteFlashTexture);
-    }
-
-    // finish the completed row routine - delete the completed rows and move existing rows down
-    if (mNumberOfFlashesRemaining == 0)
-    {
-        gameBoard.moveRowsDown(mCompletedRows.back(), mCompletedRows.size());
-        gameBoard.updatePositions();
-        mCompletedRows.clear();
-        mFinishedRowRoutine = false;
-        mNumberOfFlashesRemaining = N_ROW_FLASHES;
-    }
-    return false;
+    return gameBoard.isRowFull(rowNum);
 }
 
-// Visual effect when the player completes a row
-void CollisionHandler::setFlashingTexture(std::vector<size_t> completedRows,
-    Grid& gameBoard,
-    Texture* texture)
+bool CollisionHandler::hasCollided(Grid& tetronimo, Grid& gameBoard)
 {
-    for (auto rowNum : completedRows)
+    // Pieces move sideways a whole block at a time, so the column is exact
+    int colOnGameBoard = tetronimo.getPosX() / BLOCK_SIZE;
+    uint64_t boardMask = Grid::fullRowMask(gameBoard.getWidth());
+    int boardBottom = static_cast<int>(gameBoard.getHeight()) * BLOCK_SIZE;
+
+    for (size_t yIndex = 0; yIndex < tetronimo.getHeight(); ++yIndex)
     {
-        for (auto xIndex = 0; xIndex < gameBoard.getWidth(); ++xIndex)
+        uint64_t piece = tetronimo.getRowMask(yIndex);
+        if (piece == 0)
         {
-            gameBoard.getBlock(xIndex, rowNum).setTexture(texture);
+            continue;
         }
-    }
-    mNumberOfFlashesRemaining -= 1;
-    mFlashRowTransitionTime = mCurrentTime + COMPLETED_ROW_FLASH_INTERVAL_MS;
-}
 
-bool CollisionHandler::hasCollided(Grid& tetronimo, Grid& gameBoard)
-{
-    // find nearest whole number of blocks on game board
-    int rowOnGameBoard = (tetronimo.getPosY() / BLOCK_SIZE);
-    int colOnGameBoard = (tetronimo.getPosX() / BLOCK_SIZE);
-
-    return tetronimo.anyBlocks(
-        [this, &gameBoard, rowOnGameBoard, colOnGameBoard] (Block& block, size_t xIndex, size_t yIndex)
+        // Check sides of the board - no bits may fall off either end of the row
+        uint64_t shifted;
+        if (colOnGameBoard < 0)
         {
-            if (block.exists())
+            int shift = -colOnGameBoard;
+            if (shift >= 64 || (piece & ((uint64_t { 1 } << shift) - 1)) != 0)
             {
-                // Check sides of screen
-                if ((block.getPosX() < 0) || ((block.getPosX() + BLOCK_SIZE) > SCREEN_WIDTH))
-                {
-                    return true;
-                }
-                // Check top and bottom of playable area
-                if ((block.getPosY() < 0) || (block.getPosY() + BLOCK_SIZE) >= (N_ROWS * BLOCK_SIZE))
-                {
-                    return true;
-                }
-                // Check for an already frozen Tetronimo in the same grid squares as the Block
-                if (
-                    gameBoard.getBlock(colOnGameBoard + xIndex, rowOnGameBoard + yIndex).exists() || 
-                    gameBoard.getBlock(colOnGameBoard + xIndex, rowOnGameBoard + yIndex + 1).exists())
-                {
-                    return true;
-                }
+                return true;
             }
-            return false;
+            shifted = piece >> shift;
         }
-    );
-}
\ No newline at end of file
+        else
+        {
+            if (colOnGameBoard >= 64 || ((piece << colOnGameBoard) >> colOnGameBoard) != piece)
+            {
+                return true;
+            }
+            shifted = piece << colOnGameBoard;
+        }
+        if ((shifted & ~boardMask) != 0)
+        {
+            return true;
+        }
+
+        // Check top and bottom of playable area
+        int posY = tetronimo.getPosY() + static_cast<int>(yIndex) * BLOCK_SIZE;
+        if ((posY < 0) || (posY + BLOCK_SIZE) >= boardBottom)
+        {
+            return true;
+        }
+
+        // Check for an already frozen Tetronimo in the same grid squares. The piece
+        // falls a pixel at a time, so it can overlap the row below too
+        size_t rowOnGameBoard = static_cast<size_t>(posY / BLOCK_SIZE);
+        if ((gameBoard.getRowMask(rowOnGameBoard) | gameBoard.getRowMask(rowOnGameBoard + 1)) & shifted)
+        {
+            return true;
+        }
+    }
+    return false;
+}
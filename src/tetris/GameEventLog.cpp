@@ -0,0 +1,88 @@
+#include "tetris/GameEventLog.h"
+
+const char* gameEventName(uint8_t type)
+{
+    switch (type)
+    {
+    case GAME_EVENT_SPAWN:
+        return "spawn";
+    case GAME_EVENT_MOVE:
+        return "move";
+    case GAME_EVENT_ROTATE:
+        return "rotate";
+    case GAME_EVENT_LOCK:
+        return "lock";
+    case GAME_EVENT_LINE_CLEAR:
+        return "clear";
+    case GAME_EVENT_GAME_OVER:
+        return "game_over";
+    case GAME_EVENT_FRAME:
+        return "frame";
+    case EVENT_LOG_DROPPED:
+        return "dropped";
+    default:
+        return "unknown";
+    }
+}
+
+GameEventLogger::GameEventLogger(EventLog& log,
+    TetrisSimulation& simulation,
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>>& textures)
+    : mLog { log }
+    , mSimulation { simulation }
+    , mPalette { textures }
+{
+    mSimulation.setCollisionListener(this);
+
+    // The first piece was dealt before anyone was listening
+    pieceSpawned();
+}
+
+GameEventLogger::~GameEventLogger()
+{
+    mSimulation.setCollisionListener(nullptr);
+}
+
+void GameEventLogger::gameOver()
+{
+    log(GAME_EVENT_GAME_OVER, static_cast<int32_t>(mSimulation.getScore()));
+}
+
+void GameEventLogger::pieceSpawned()
+{
+    Grid& piece = mSimulation.getCurrentTetronimo();
+    Texture* texture = nullptr;
+    piece.anyBlocks(
+        [&texture](Block& block, size_t, size_t)
+        {
+            texture = block.getTexture();
+            return block.exists();
+        });
+    log(GAME_EVENT_SPAWN, mPalette.indexOf(texture), piece.getPosX() / BLOCK_SIZE);
+}
+
+void GameEventLogger::pieceMoved(int blocks)
+{
+    log(GAME_EVENT_MOVE, blocks);
+}
+
+void GameEventLogger::pieceRotated()
+{
+    log(GAME_EVENT_ROTATE);
+}
+
+void GameEventLogger::pieceLocked()
+{
+    Grid& piece = mSimulation.getCurrentTetronimo();
+    log(GAME_EVENT_LOCK, piece.getPosX() / BLOCK_SIZE, piece.getPosY() / BLOCK_SIZE);
+}
+
+void GameEventLogger::rowsCleared(size_t bottomRow, size_t count)
+{
+    log(GAME_EVENT_LINE_CLEAR, static_cast<int32_t>(count), static_cast<int32_t>(bottomRow));
+}
+
+void GameEventLogger::log(uint8_t type, int32_t arg0, int32_t arg1)
+{
+    mLog.log(GAME_EVENT_SIMULATION, type, mSimulation.getTick(), arg0, arg1);
+}
@@ -1,24 +1,69 @@
 #include "tetris/Grid.h"
+#include "tetris/Input.h"
+#include <algorithm>
 
 Grid::Grid(int x, int y, size_t rows, size_t cols)
     : mPosX(x)
     , mPosY(y)
     , mRows(rows)
     , mCols(cols)
-    , mGrid(rows, std::vector<Block>(cols))
+    , mBlocks(rows * cols)
+    , mRowMasks(rows, 0)
 {
+    assert(cols <= MAX_BOARD_COLS);
+}
+
+void Grid::reset(int x, int y, size_t rows, size_t cols)
+{
+    mPosX = x;
+    mPosY = y;
+    mVelX = 0;
+    mVelY = VERTICAL_VELOCITY;
+    mRotate = false;
+    mHardDrop = false;
+    mRows = rows;
+    mCols = cols;
+    assert(mCols <= MAX_BOARD_COLS);
+
+    // Never shrink, so spawning a small piece after a big one doesn't free and reallocate
+    if (mBlocks.size() < mRows * mCols)
+    {
+        mBlocks.resize(mRows * mCols);
+    }
+    std::fill(begin(), end(), Block());
+    if (mRowMasks.size() < mRows)
+    {
+        mRowMasks.resize(mRows);
+    }
+    std::fill(mRowMasks.begin(), mRowMasks.end(), 0);
 }
 
 void Grid::createBlock(int xIndex, int yIndex, Texture* texture)
 {
     int blockX = mPosX + (xIndex * BLOCK_SIZE);
     int blockY = mPosY + (yIndex * BLOCK_SIZE);
-    mGrid[yIndex][xIndex] = Block { blockX, blockY, texture };
+    getRow(yIndex)[xIndex] = Block { blockX, blockY, texture };
+    mRowMasks[yIndex] |= uint64_t { 1 } << xIndex;
 };
 
 Block& Grid::getBlock(size_t xIndex, size_t yIndex)
 {
-    return mGrid[yIndex][xIndex];
+    return getRow(yIndex)[xIndex];
+}
+
+uint64_t Grid::getRowMask(size_t yIndex)
+{
+    return mRowMasks[yIndex];
+}
+
+bool Grid::isRowFull(size_t yIndex)
+{
+    return mRowMasks[yIndex] == fullRowMask(mCols);
+}
+
+uint64_t Grid::fullRowMask(size_t cols)
+{
+    return (cols >= 64) ? ~uint64_t { 0 } : (uint64_t { 1 } << cols) - 1;
 }
 
 void Grid::handleEvent(SDL_Event& e)
@@ -62,6 +107,19 @@ void Grid::handleEvent(SDL_Event& e)
     }
 }
 
+void Grid::applyInput(uint8_t input, int shift)
+{
+    setVelX(shift * BLOCK_SIZE);
+    setVelY((input & INPUT_DOWN) ? VERTICAL_FAST_VELOCITY : VERTICAL_VELOCITY);
+
+    // Rotation stays pending until the CollisionHandler gets to it
+    if (input & INPUT_ROTATE)
+    {
+        mRotate = true;
+    }
+    mHardDrop = (input & INPUT_HARD_DROP) != 0;
+}
+
 void Grid::move(int xMul, int yMul)
 {
     bool allowedMove = true;
@@ -86,9 +144,10 @@ void Grid::rotateClockwise()
     // Reverse each row
     for (size_t xIndex = 0; xIndex < mCols; ++xIndex)
     {
-        std::reverse(mGrid[xIndex].begin(), mGrid[xIndex].end());
+        std::reverse(getRow(xIndex), getRow(xIndex) + mCols);
     }
     updatePositions();
+    updateRowMasks();
     mRotate = false;
 }
 
@@ -105,7 +164,7 @@ void Grid::transpose()
     {
         for (int yIndex = xIndex + 1; yIndex < mRows; ++yIndex)
         {
-            std::swap(mGrid[xIndex][yIndex], mGrid[yIndex][xIndex]);
+            std::swap(getBlock(yIndex, xIndex), getBlock(xIndex, yIndex));
         }
     }
 }
@@ -119,32 +178,53 @@ void Grid::updatePositions()
         });
 }
 
-void Grid::moveRowsDown(size_t bottomRow, size_t nRowsToDelete)
+void Grid::updateRowMasks()
 {
-    // Move rows down
-    for (size_t r = bottomRow; r >= nRowsToDelete; r--)
+    for (size_t yIndex = 0; yIndex < mRows; ++yIndex)
     {
-        mGrid[r] = mGrid[r - nRowsToDelete];
+        uint64_t mask = 0;
+        for (size_t xIndex = 0; xIndex < mCols; ++xIndex)
+        {
+            if (getBlock(xIndex, yIndex).exists())
+            {
+                mask |= uint64_t { 1 } << xIndex;
+            }
+        }
+        mRowMasks[yIndex] = mask;
     }
-    
+}
+
+void Grid::moveRowsDown(size_t bottomRow, size_t nRowsToDelete)
+{
+    // Shift everything above the deleted rows down in one contiguous move
+    size_t first = bottomRow + 1 - nRowsToDelete;
+    std::move_backward(getRow(0), getRow(first), getRow(bottomRow + 1));
+    std::move_backward(mRowMasks.begin(), mRowMasks.begin() + static_cast<std::ptrdiff_t>(first),
+        mRowMasks.begin() + static_cast<std::ptrdiff_t>(bottomRow + 1));
+
     // Clear the top rows that are now empty
-    for (size_t r = 0; r < nRowsToDelete; r++)
+    std::fill(getRow(0), getRow(nRowsToDelete), Block());
+    std::fill(mRowMasks.begin(), mRowMasks.begin() + static_cast<std::ptrdiff_t>(nRowsToDelete), 0);
+
+    // Only the rows that moved need new screen positions
+    for (size_t r = 0; r <= bottomRow; r++)
     {
+        Block* row = getRow(r);
         for (size_t c = 0; c < mCols; c++)
         {
-            mGrid[r][c] = Block(); // Create empty block
+            row[c].moveTo(mPosX + static_cast<int>(c) * BLOCK_SIZE, mPosY + static_cast<int>(r) * BLOCK_SIZE);
         }
     }
 }
 
-void Grid::render()
+void Grid::render(int offsetX, int offsetY)
 {
     forEachBlock(
-        [](Block& block, size_t, size_t)
+        [offsetX, offsetY](Block& block, size_t, size_t)
         {
             if (block.exists())
             {
-                block.render();
+                block.render(offsetX, offsetY);
             }
         });
 }
@@ -182,4 +262,9 @@ void Grid::setVelY(int velY)
 bool Grid::shouldRotate()
 {
     return mRotate;
+}
+
+bool Grid::shouldHardDrop()
+{
+    return mHardDrop;
 }
\ No newline at end of file
@@ -0,0 +1,161 @@
+#include "tetris/Input.h"
+#include <algorithm>
+
+KeyboardInput::KeyboardInput()
+    : mHeld { INPUT_NONE }
+    , mPressed { INPUT_NONE }
+    , mOldestTimestamp { 0 }
+{
+}
+
+bool KeyboardInput::toInputEvent(const SDL_Event& e, InputEvent& event)
+{
+    if (e.type != SDL_KEYDOWN && e.type != SDL_KEYUP)
+    {
+        return false;
+    }
+
+    // The OS repeating a held key is not a new press. Holding is timed by
+    // AutoShift, so a repeat would restart the delay
+    if (e.key.repeat != 0)
+    {
+        return false;
+    }
+
+    switch (e.key.keysym.sym)
+    {
+    case SDLK_DOWN:
+        event.flag = INPUT_DOWN;
+        break;
+    case SDLK_LEFT:
+        event.flag = INPUT_LEFT;
+        break;
+    case SDLK_RIGHT:
+        event.flag = INPUT_RIGHT;
+        break;
+    case SDLK_SPACE:
+        event.flag = INPUT_ROTATE;
+        break;
+    case SDLK_UP:
+        event.flag = INPUT_HARD_DROP;
+        break;
+    default:
+        return false;
+    }
+    event.timestamp = e.key.timestamp;
+    event.pressed = (e.type == SDL_KEYDOWN);
+    return true;
+}
+
+void KeyboardInput::handleEvent(SDL_Event& e)
+{
+    InputEvent event {};
+    if (toInputEvent(e, event))
+    {
+        handleEvent(event);
+    }
+}
+
+void KeyboardInput::handleEvent(const InputEvent& event)
+{
+    if (mOldestTimestamp == 0)
+    {
+        mOldestTimestamp = event.timestamp;
+    }
+
+    if (event.pressed)
+    {
+        mHeld |= event.flag;
+        mPressed |= event.flag;
+    }
+    else
+    {
+        mHeld &= static_cast<uint8_t>(~event.flag);
+    }
+}
+
+uint8_t KeyboardInput::getInput()
+{
+    // A key that went down and up again since the last tick still counts
+    uint8_t input = static_cast<uint8_t>((mHeld & INPUT_HELD_MASK) | (mPressed & (INPUT_ROTATE | INPUT_DOWN | INPUT_HARD_DROP)));
+    if (mPressed & INPUT_LEFT)
+    {
+        input |= INPUT_LEFT_PRESSED;
+    }
+    if (mPressed & INPUT_RIGHT)
+    {
+        input |= INPUT_RIGHT_PRESSED;
+    }
+    return input;
+}
+
+uint32_t KeyboardInput::getOldestTimestamp()
+{
+    return mOldestTimestamp;
+}
+
+void KeyboardInput::clearPressed()
+{
+    mPressed = INPUT_NONE;
+    mOldestTimestamp = 0;
+}
+
+AutoShift::AutoShift(AutoShiftSettings settings)
+    : mSettings { settings }
+    , mDirection { 0 }
+    , mHeldTicks { 0 }
+{
+}
+
+int AutoShift::update(uint8_t input)
+{
+    bool leftHeld = input & INPUT_LEFT;
+    bool rightHeld = input & INPUT_RIGHT;
+    bool leftPressed = input & INPUT_LEFT_PRESSED;
+    bool rightPressed = input & INPUT_RIGHT_PRESSED;
+
+    // The most recent press wins. If the direction we were charging is
+    // released, fall back to the other one if it is still held
+    bool fresh = false;
+    if (leftPressed != rightPressed)
+    {
+        mDirection = leftPressed ? -1 : 1;
+        fresh = true;
+    }
+    else if ((mDirection < 0 && !leftHeld) || (mDirection > 0 && !rightHeld) || mDirection == 0)
+    {
+        mDirection = (leftHeld && !rightHeld) ? -1 : (rightHeld && !leftHeld) ? 1 : 0;
+        fresh = (mDirection != 0);
+    }
+
+    if (mDirection == 0 || fresh)
+    {
+        // Move straight away on the press, then start charging
+        mHeldTicks = 0;
+        return mDirection;
+    }
+
+    mHeldTicks++;
+    if (mHeldTicks < mSettings.delayTicks)
+    {
+        return 0;
+    }
+    uint32_t repeatTicks = std::max<uint32_t>(mSettings.repeatTicks, 1);
+    return ((mHeldTicks - mSettings.delayTicks) % repeatTicks == 0) ? mDirection : 0;
+}
+
+int8_t AutoShift::getDirection() const
+{
+    return mDirection;
+}
+
+uint32_t AutoShift::getHeldTicks() const
+{
+    return mHeldTicks;
+}
+
+void AutoShift::setState(int8_t direction, uint32_t heldTicks)
+{
+    mDirection = direction;
+    mHeldTicks = heldTicks;
+}
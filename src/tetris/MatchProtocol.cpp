@@ -0,0 +1,52 @@
+#include "tetris/MatchProtocol.h"
+#include "engine/ByteOrder.h"
+
+void encodeMatchInput(const MatchInputPacket& packet, uint8_t* buffer)
+{
+    writeU32(buffer, MATCH_PACKET_MAGIC);
+    writeU32(buffer + 4, packet.matchId);
+    buffer[8] = packet.player;
+    writeU32(buffer + 9, packet.sequence);
+    buffer[13] = packet.input;
+}
+
+bool decodeMatchInput(const uint8_t* buffer, size_t size, MatchInputPacket& packet)
+{
+    if (size < MATCH_INPUT_PACKET_SIZE || readU32(buffer) != MATCH_PACKET_MAGIC || buffer[8] > 1)
+    {
+        return false;
+    }
+    packet.matchId = readU32(buffer + 4);
+    packet.player = buffer[8];
+    packet.sequence = readU32(buffer + 9);
+    packet.input = buffer[13];
+    return true;
+}
+
+void encodeMatchState(const MatchStatePacket& packet, uint8_t* buffer)
+{
+    writeU32(buffer, MATCH_PACKET_MAGIC);
+    writeU32(buffer + 4, packet.matchId);
+    writeU32(buffer + 8, packet.tick);
+    writeU32(buffer + 12, packet.ackSequence);
+    writeU32(buffer + 16, packet.scores[0]);
+    writeU32(buffer + 20, packet.scores[1]);
+    buffer[24] = packet.playing[0] ? 1 : 0;
+    buffer[25] = packet.playing[1] ? 1 : 0;
+}
+
+bool decodeMatchState(const uint8_t* buffer, size_t size, MatchStatePacket& packet)
+{
+    if (size < MATCH_STATE_PACKET_SIZE || readU32(buffer) != MATCH_PACKET_MAGIC)
+    {
+        return false;
+    }
+    packet.matchId = readU32(buffer + 4);
+    packet.tick = readU32(buffer + 8);
+    packet.ackSequence = readU32(buffer + 12);
+    packet.scores[0] = readU32(buffer + 16);
+    packet.scores[1] = readU32(buffer + 20);
+    packet.playing[0] = buffer[24] != 0;
+    packet.playing[1] = buffer[25] != 0;
+    return true;
+}
@@ -0,0 +1,525 @@
+#include "tetris/MatchServer.h"
+#include <cstdio>
+
+#ifdef __linux__
+#include "engine/Texture.h"
+#include "tetris/Input.h"
+#include "tetris/Simulation.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <climits>
+#include <ctime>
+#include <mutex>
+#include <pthread.h>
+#include <queue>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace
+{
+constexpr uint64_t TICK_US = TICK_MS * 1000;
+constexpr int MAX_EPOLL_EVENTS = 8;
+constexpr unsigned int PACKET_BATCH = 64; // datagrams per recvmmsg and sendmmsg call
+constexpr size_t MAX_PACKETS_PER_WAKE = 4096; // so a flood of inputs can't starve the ticks
+constexpr int SOCKET_BUFFER_SIZE = 4 << 20;
+
+// CLOCK_MONOTONIC, the clock the timerfd runs on
+uint64_t nowUs()
+{
+    timespec now {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + static_cast<uint64_t>(now.tv_nsec) / 1000;
+}
+
+void closeFd(int& fd)
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+    fd = -1;
+}
+
+void mergeStats(MatchServerStats& into, const MatchServerStats& from)
+{
+    into.ticks += from.ticks;
+    into.packetsIn += from.packetsIn;
+    into.packetsOut += from.packetsOut;
+    into.matchesStarted += from.matchesStarted;
+    into.matchesDropped += from.matchesDropped;
+    if (from.tickLatencyUs.getCount() > 0)
+    {
+        into.tickLatencyUs.merge(from.tickLatencyUs);
+    }
+}
+
+struct Match
+{
+    Match(std::unordered_map<std::string_view, std::unique_ptr<Texture>>& textures, uint32_t id, uint64_t now)
+        : simulations { TetrisSimulation { textures, id }, TetrisSimulation { textures, id } }
+        , nextTickUs { now }
+        , lastHeardUs { now }
+    {
+    }
+
+    // Both players get the same pieces
+    std::array<TetrisSimulation, 2> simulations;
+    std::array<sockaddr_in, 2> clients {};
+    std::array<bool, 2> joined {};
+    std::array<uint32_t, 2> sequences {}; // newest input packet used from each player
+    std::array<uint8_t, 2> held {};
+    std::array<uint8_t, 2> pressed {}; // latched until the next tick, like KeyboardInput
+    uint64_t nextTickUs;
+    uint64_t lastHeardUs;
+};
+}
+
+class MatchServer::Shard
+{
+public:
+    Shard(const MatchServerConfig& config, size_t index)
+        : mConfig { config }
+        , mIndex { index }
+        , mSocket { -1 }
+        , mEpoll { -1 }
+        , mTimer { -1 }
+        , mWake { -1 }
+        , mPort { 0 }
+        , mThread {}
+        , mStopping { false }
+        , mTextures { makeHeadlessTextures() }
+        , mMatches {}
+        , mSchedule {}
+        , mReceiveHeaders {}
+        , mReceiveVectors {}
+        , mReceiveAddresses {}
+        , mReceiveBuffers {}
+        , mSendHeaders {}
+        , mSendVectors {}
+        , mSendAddresses {}
+        , mSendBuffers {}
+        , mQueued { 0 }
+        , mPending {}
+        , mStatsMutex {}
+        , mStats {}
+    {
+        for (unsigned int slot = 0; slot < PACKET_BATCH; ++slot)
+        {
+            mReceiveVectors[slot] = iovec { mReceiveBuffers[slot].data(), mReceiveBuffers[slot].size() };
+            mReceiveHeaders[slot].msg_hdr.msg_iov = &mReceiveVectors[slot];
+            mReceiveHeaders[slot].msg_hdr.msg_iovlen = 1;
+            mSendVectors[slot] = iovec { mSendBuffers[slot].data(), MATCH_STATE_PACKET_SIZE };
+            mSendHeaders[slot].msg_hdr.msg_iov = &mSendVectors[slot];
+            mSendHeaders[slot].msg_hdr.msg_iovlen = 1;
+            mSendHeaders[slot].msg_hdr.msg_name = &mSendAddresses[slot];
+            mSendHeaders[slot].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+    }
+
+    ~Shard()
+    {
+        stop();
+        closeFd(mSocket);
+        closeFd(mEpoll);
+        closeFd(mTimer);
+        closeFd(mWake);
+    }
+
+    bool open()
+    {
+        mSocket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+        mEpoll = epoll_create1(EPOLL_CLOEXEC);
+        mTimer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        mWake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (mSocket < 0 || mEpoll < 0 || mTimer < 0 || mWake < 0)
+        {
+            printf("Unable to create the sockets for shard %zu!\n", mIndex);
+            return false;
+        }
+
+        // Every client of every match on this shard shares one socket, give bursts room
+        setsockopt(mSocket, SOL_SOCKET, SO_RCVBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+        setsockopt(mSocket, SOL_SOCKET, SO_SNDBUF, &SOCKET_BUFFER_SIZE, sizeof(SOCKET_BUFFER_SIZE));
+
+        sockaddr_in local {};
+        local.sin_family = AF_INET;
+        local.sin_port = htons(static_cast<uint16_t>(mConfig.basePort == 0 ? 0 : mConfig.basePort + mIndex));
+        if (inet_pton(AF_INET, mConfig.address.c_str(), &local.sin_addr) != 1
+            || bind(mSocket, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0)
+        {
+            printf("Unable to bind shard %zu to %s:%u!\n", mIndex, mConfig.address.c_str(), ntohs(local.sin_port));
+            return false;
+        }
+        socklen_t length = sizeof(local);
+        getsockname(mSocket, reinterpret_cast<sockaddr*>(&local), &length);
+        mPort = ntohs(local.sin_port);
+
+        for (int fd : { mSocket, mTimer, mWake })
+        {
+            epoll_event event {};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(mEpoll, EPOLL_CTL_ADD, fd, &event) != 0)
+            {
+                printf("Unable to watch shard %zu's sockets!\n", mIndex);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void start()
+    {
+        mThread = std::thread(&Shard::run, this);
+        if (mConfig.pinThreads)
+        {
+            cpu_set_t cores;
+            CPU_ZERO(&cores);
+            CPU_SET(mIndex % std::max(std::thread::hardware_concurrency(), 1u), &cores);
+            pthread_setaffinity_np(mThread.native_handle(), sizeof(cores), &cores);
+        }
+    }
+
+    void stop()
+    {
+        if (!mThread.joinable())
+        {
+            return;
+        }
+        mStopping = true;
+        uint64_t one = 1;
+        if (write(mWake, &one, sizeof(one)) < 0)
+        {
+            printf("Unable to wake shard %zu!\n", mIndex);
+        }
+        mThread.join();
+    }
+
+    uint16_t getPort() const
+    {
+        return mPort;
+    }
+
+    void takeStats(MatchServerStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        size_t matches = mStats.matches;
+        mergeStats(stats, mStats);
+        stats.matches += matches;
+        mStats = MatchServerStats {};
+        mStats.matches = matches;
+    }
+
+private:
+    void run()
+    {
+        std::array<epoll_event, MAX_EPOLL_EVENTS> events;
+        while (!mStopping)
+        {
+            int count = epoll_wait(mEpoll, events.data(), MAX_EPOLL_EVENTS, -1);
+            for (int index = 0; index < count; ++index)
+            {
+                int fd = events[static_cast<size_t>(index)].data.fd;
+                if (fd == mSocket)
+                {
+                    receivePackets();
+                }
+                else if (fd == mTimer)
+                {
+                    uint64_t expirations;
+                    if (read(mTimer, &expirations, sizeof(expirations)) > 0)
+                    {
+                        runDueTicks();
+                    }
+                }
+            }
+            flushPackets();
+            armTimer();
+            publishStats();
+        }
+    }
+
+    void receivePackets()
+    {
+        for (size_t received = 0; received < MAX_PACKETS_PER_WAKE;)
+        {
+            for (unsigned int index = 0; index < PACKET_BATCH; ++index)
+            {
+                mReceiveHeaders[index].msg_hdr.msg_name = &mReceiveAddresses[index];
+                mReceiveHeaders[index].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            }
+            int count = recvmmsg(mSocket, mReceiveHeaders.data(), PACKET_BATCH, 0, nullptr);
+            if (count <= 0)
+            {
+                return;
+            }
+
+            uint64_t now = nowUs();
+            for (size_t index = 0; index < static_cast<size_t>(count); ++index)
+            {
+                MatchInputPacket packet;
+                if (decodeMatchInput(mReceiveBuffers[index].data(), mReceiveHeaders[index].msg_len, packet))
+                {
+                    handleInput(packet, mReceiveAddresses[index], now);
+                }
+            }
+            mPending.packetsIn += static_cast<uint64_t>(count);
+            received += static_cast<size_t>(count);
+            if (count < static_cast<int>(PACKET_BATCH))
+            {
+                return;
+            }
+        }
+    }
+
+    void handleInput(const MatchInputPacket& packet, const sockaddr_in& from, uint64_t now)
+    {
+        auto& slot = mMatches[packet.matchId];
+        if (!slot)
+        {
+            // The first packet for an unknown match starts it, ticking from now
+            slot = std::make_unique<Match>(mTextures, packet.matchId, now);
+            mSchedule.emplace(slot->nextTickUs, packet.matchId);
+            mPending.matchesStarted++;
+        }
+        Match& match = *slot;
+        match.lastHeardUs = now;
+        match.clients[packet.player] = from;
+        match.joined[packet.player] = true;
+
+        // Out of order or duplicated
+        if (packet.sequence <= match.sequences[packet.player])
+        {
+            return;
+        }
+        match.sequences[packet.player] = packet.sequence;
+        match.held[packet.player] = packet.input & INPUT_HELD_MASK;
+        match.pressed[packet.player] |= static_cast<uint8_t>(packet.input & ~INPUT_HELD_MASK);
+    }
+
+    void runDueTicks()
+    {
+        uint64_t now = nowUs();
+        while (!mSchedule.empty() && mSchedule.top().first <= now)
+        {
+            auto [due, id] = mSchedule.top();
+            mSchedule.pop();
+
+            // Entries of dropped or rescheduled matches are left in the queue, skip them
+            auto found = mMatches.find(id);
+            if (found == mMatches.end() || found->second->nextTickUs != due)
+            {
+                continue;
+            }
+            Match& match = *found->second;
+            if (now - std::min(now, match.lastHeardUs) > uint64_t { mConfig.idleTimeoutMs } * 1000)
+            {
+                mMatches.erase(found);
+                mPending.matchesDropped++;
+                continue;
+            }
+
+            tickMatch(id, match);
+            mPending.tickLatencyUs.record(static_cast<uint32_t>(std::min<uint64_t>(nowUs() - due, UINT32_MAX)));
+
+            // A late match catches up a few ticks, after that it falls behind real time
+            match.nextTickUs += TICK_US;
+            if (now > match.nextTickUs + MATCH_MAX_CATCH_UP_TICKS * TICK_US)
+            {
+                match.nextTickUs = now + TICK_US;
+            }
+            mSchedule.emplace(match.nextTickUs, id);
+        }
+    }
+
+    void tickMatch(uint32_t id, Match& match)
+    {
+        for (size_t player = 0; player < 2; ++player)
+        {
+            TetrisSimulation& simulation = match.simulations[player];
+            if (simulation.isPlaying())
+            {
+                simulation.step(match.held[player] | match.pressed[player]);
+                mPending.ticks++;
+            }
+            match.pressed[player] = INPUT_NONE;
+        }
+
+        MatchStatePacket state {};
+        state.matchId = id;
+        for (size_t player = 0; player < 2; ++player)
+        {
+            state.scores[player] = match.simulations[player].getScore();
+            state.playing[player] = match.simulations[player].isPlaying();
+            state.tick = std::max(state.tick, match.simulations[player].getTick());
+        }
+        for (size_t player = 0; player < 2; ++player)
+        {
+            if (match.joined[player])
+            {
+                state.ackSequence = match.sequences[player];
+                queuePacket(state, match.clients[player]);
+            }
+        }
+    }
+
+    void queuePacket(const MatchStatePacket& state, const sockaddr_in& to)
+    {
+        encodeMatchState(state, mSendBuffers[mQueued].data());
+        mSendAddresses[mQueued] = to;
+        if (++mQueued == PACKET_BATCH)
+        {
+            flushPackets();
+        }
+    }
+
+    void flushPackets()
+    {
+        // A full socket buffer drops the rest, the next tick sends fresh state anyway
+        int sent = (mQueued > 0) ? sendmmsg(mSocket, mSendHeaders.data(), mQueued, 0) : 0;
+        mPending.packetsOut += static_cast<uint64_t>(std::max(sent, 0));
+        mQueued = 0;
+    }
+
+    // Wake up when the soonest match is due
+    void armTimer()
+    {
+        itimerspec spec {};
+        if (!mSchedule.empty())
+        {
+            uint64_t due = std::max<uint64_t>(mSchedule.top().first, 1);
+            spec.it_value.tv_sec = static_cast<time_t>(due / 1000000);
+            spec.it_value.tv_nsec = static_cast<long>(due % 1000000) * 1000;
+        }
+        timerfd_settime(mTimer, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+
+    void publishStats()
+    {
+        std::lock_guard<std::mutex> lock(mStatsMutex);
+        mergeStats(mStats, mPending);
+        mStats.matches = mMatches.size();
+        mPending = MatchServerStats {};
+    }
+
+    using ScheduleEntry = std::pair<uint64_t, uint32_t>; // due time, match id
+
+    const MatchServerConfig& mConfig;
+    size_t mIndex;
+    int mSocket;
+    int mEpoll;
+    int mTimer;
+    int mWake; // eventfd that stop() writes to
+    uint16_t mPort;
+    std::thread mThread;
+    std::atomic<bool> mStopping;
+
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>> mTextures;
+    std::unordered_map<uint32_t, std::unique_ptr<Match>> mMatches;
+    std::priority_queue<ScheduleEntry, std::vector<ScheduleEntry>, std::greater<ScheduleEntry>> mSchedule;
+
+    // Batches for recvmmsg and sendmmsg
+    std::array<mmsghdr, PACKET_BATCH> mReceiveHeaders;
+    std::array<iovec, PACKET_BATCH> mReceiveVectors;
+    std::array<sockaddr_in, PACKET_BATCH> mReceiveAddresses;
+    std::array<std::array<uint8_t, MATCH_INPUT_PACKET_SIZE>, PACKET_BATCH> mReceiveBuffers;
+    std::array<mmsghdr, PACKET_BATCH> mSendHeaders;
+    std::array<iovec, PACKET_BATCH> mSendVectors;
+    std::array<sockaddr_in, PACKET_BATCH> mSendAddresses;
+    std::array<std::array<uint8_t, MATCH_STATE_PACKET_SIZE>, PACKET_BATCH> mSendBuffers;
+    unsigned int mQueued;
+
+    // Counted by the shard thread, published to mStats after every wake up
+    MatchServerStats mPending;
+    std::mutex mStatsMutex;
+    MatchServerStats mStats;
+};
+
+bool MatchServer::start()
+{
+    size_t shards = (mConfig.shards > 0) ? mConfig.shards : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    for (size_t index = 0; index < shards; ++index)
+    {
+        mShards.push_back(std::make_unique<Shard>(mConfig, index));
+        if (!mShards.back()->open())
+        {
+            mShards.clear();
+            return false;
+        }
+    }
+    for (auto& shard : mShards)
+    {
+        shard->start();
+    }
+    return true;
+}
+#else
+class MatchServer::Shard
+{
+public:
+    void stop()
+    {
+    }
+
+    uint16_t getPort() const
+    {
+        return 0;
+    }
+
+    void takeStats(MatchServerStats&)
+    {
+    }
+};
+
+bool MatchServer::start()
+{
+    printf("The match server needs epoll, it only runs on Linux!\n");
+    return false;
+}
+#endif
+
+MatchServer::MatchServer(const MatchServerConfig& config)
+    : mConfig { config }
+    , mShards {}
+{
+}
+
+MatchServer::~MatchServer()
+{
+    stop();
+}
+
+void MatchServer::stop()
+{
+    for (auto& shard : mShards)
+    {
+        shard->stop();
+    }
+}
+
+size_t MatchServer::getShardCount() const
+{
+    return mShards.size();
+}
+
+uint16_t MatchServer::getPort(size_t shard) const
+{
+    return mShards[shard]->getPort();
+}
+
+MatchServerStats MatchServer::takeStats()
+{
+    MatchServerStats stats {};
+    for (auto& shard : mShards)
+    {
+        shard->takeStats(stats);
+    }
+    return stats;
+}
@@ -0,0 +1,94 @@
+#include "tetris/ParticleEffects.h"
+#include <array>
+
+namespace
+{
+constexpr std::array<SDL_Color, 4> SPARK_COLOURS {
+    SDL_Color { 0xFF, 0xFF, 0xFF, 0xFF }, // white
+    SDL_Color { 0xF0, 0xD0, 0x30, 0xFF }, // yellow
+    SDL_Color { 0xF0, 0x90, 0x30, 0xFF }, // orange
+    SDL_Color { 0x30, 0x90, 0xE0, 0xFF }, // blue
+};
+constexpr SDL_Color DUST_COLOUR { 0x80, 0x80, 0x80, 0xC0 };
+}
+
+ParticleEffects::ParticleEffects()
+    : mParticles { MAX_PARTICLES }
+    , mRandom {}
+{
+    mParticles.setGravity(PARTICLE_GRAVITY);
+}
+
+float ParticleEffects::random(float low, float high)
+{
+    float unit = static_cast<float>(mRandom() - std::minstd_rand::min())
+        / static_cast<float>(std::minstd_rand::max() - std::minstd_rand::min());
+    return low + unit * (high - low);
+}
+
+void ParticleEffects::lineCleared(const LineClear& clear, size_t cols, int offsetX)
+{
+    for (size_t offset = 0; offset < MAX_TETRONIMO_SIZE; ++offset)
+    {
+        if (((clear.rowMask >> offset) & 1u) == 0)
+        {
+            continue;
+        }
+        size_t row = clear.bottomRow - offset;
+        for (size_t col = 0; col < cols; ++col)
+        {
+            float x = static_cast<float>(offsetX + static_cast<int>(col) * BLOCK_SIZE + BLOCK_SIZE / 2);
+            float y = static_cast<float>(static_cast<int>(row) * BLOCK_SIZE + BLOCK_SIZE / 2);
+            for (int particle = 0; particle < LINE_CLEAR_PARTICLES_PER_BLOCK; ++particle)
+            {
+                SDL_Color colour = SPARK_COLOURS[mRandom() % SPARK_COLOURS.size()];
+                mParticles.emit(x + random(-16, 16), y + random(-16, 16),
+                    random(-240, 240), random(-420, -60), random(0.4f, 0.9f), colour);
+            }
+        }
+    }
+}
+
+void ParticleEffects::hardDropped(const HardDrop& drop, int offsetX)
+{
+    float left = static_cast<float>(offsetX + drop.col * BLOCK_SIZE);
+    float width = static_cast<float>(drop.cols * BLOCK_SIZE);
+    float floor = static_cast<float>((drop.bottomRow + 1) * BLOCK_SIZE);
+
+    // Kicked up sideways from under the piece
+    for (int particle = 0; particle < HARD_DROP_PARTICLES_PER_COLUMN * drop.cols; ++particle)
+    {
+        float x = left + random(0, width);
+        float away = (x < left + width / 2) ? -1.0f : 1.0f;
+        mParticles.emit(x, floor - random(0, 6), away * random(40, 200), random(-220, -60),
+            random(0.3f, 0.6f), DUST_COLOUR);
+    }
+
+    // Left hanging in the air the piece fell through
+    float top = floor - static_cast<float>(drop.rows * BLOCK_SIZE);
+    for (int particle = 0; particle < HARD_DROP_TRAIL_PER_ROW * drop.rows * drop.cols; ++particle)
+    {
+        mParticles.emit(left + random(0, width), random(top, floor), random(-20, 20), random(-260, -120),
+            random(0.15f, 0.35f), DUST_COLOUR);
+    }
+}
+
+void ParticleEffects::update(float seconds)
+{
+    mParticles.update(seconds);
+}
+
+void ParticleEffects::render(SDL_Renderer* renderer)
+{
+    mParticles.render(renderer, PARTICLE_SIZE);
+}
+
+void ParticleEffects::clear()
+{
+    mParticles.clear();
+}
+
+bool ParticleEffects::empty() const
+{
+    return mParticles.empty();
+}
@@ -0,0 +1,227 @@
+#include "tetris/ReplayCorpus.h"
+#include <cstring>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+ReplayCorpusWriter::ReplayCorpusWriter()
+    : mFile { nullptr }
+    , mOffset { 0 }
+    , mIndex {}
+{
+}
+
+ReplayCorpusWriter::~ReplayCorpusWriter()
+{
+    close();
+}
+
+bool ReplayCorpusWriter::open(const std::string& path)
+{
+    close();
+    mFile = std::fopen(path.c_str(), "wb");
+    if (mFile == nullptr)
+    {
+        printf("Unable to open replay corpus %s for writing!\n", path.c_str());
+        return false;
+    }
+
+    // Reserve space for the header, it is filled in once the index is known
+    ReplayCorpusHeader header {};
+    mOffset = 0;
+    mIndex.clear();
+    return write(&header, sizeof(header));
+}
+
+bool ReplayCorpusWriter::add(uint64_t seed, uint32_t score, uint32_t lines, const uint8_t* inputs, size_t length)
+{
+    if (mFile == nullptr || length > UINT32_MAX)
+    {
+        return false;
+    }
+
+    ReplayIndexEntry entry {};
+    entry.offset = mOffset;
+    entry.metadata.seed = seed;
+    entry.metadata.score = score;
+    entry.metadata.lines = lines;
+    entry.metadata.length = static_cast<uint32_t>(length);
+    if (!write(inputs, length))
+    {
+        return false;
+    }
+    mIndex.push_back(entry);
+    return true;
+}
+
+bool ReplayCorpusWriter::close()
+{
+    if (mFile == nullptr)
+    {
+        return true;
+    }
+
+    // Pad so the index is 8-byte aligned in the mapped file
+    bool success { true };
+    static constexpr uint8_t padding[alignof(ReplayIndexEntry)] {};
+    success = success && write(padding, (alignof(ReplayIndexEntry) - mOffset % alignof(ReplayIndexEntry)) % alignof(ReplayIndexEntry));
+
+    ReplayCorpusHeader header {};
+    std::memcpy(header.magic, REPLAY_CORPUS_MAGIC, sizeof(header.magic));
+    header.version = REPLAY_CORPUS_VERSION;
+    header.headerSize = sizeof(ReplayCorpusHeader);
+    header.replayCount = mIndex.size();
+    header.indexOffset = mOffset;
+    success = success && write(mIndex.data(), mIndex.size() * sizeof(ReplayIndexEntry));
+
+    // Go back and fill in the header
+    success = success && std::fseek(mFile, 0, SEEK_SET) == 0;
+    success = success && std::fwrite(&header, sizeof(header), 1, mFile) == 1;
+    success = (std::fclose(mFile) == 0) && success;
+    mFile = nullptr;
+    if (!success)
+    {
+        printf("Failed to finish writing replay corpus!\n");
+    }
+    return success;
+}
+
+bool ReplayCorpusWriter::write(const void* data, size_t size)
+{
+    if (size > 0 && std::fwrite(data, size, 1, mFile) != 1)
+    {
+        printf("Failed to write to replay corpus!\n");
+        return false;
+    }
+    mOffset += size;
+    return true;
+}
+
+ReplayCorpus::ReplayCorpus()
+    : mData { nullptr }
+    , mSize { 0 }
+    , mIndex { nullptr }
+    , mCount { 0 }
+{
+}
+
+ReplayCorpus::~ReplayCorpus()
+{
+    close();
+}
+
+bool ReplayCorpus::open(const std::string& path)
+{
+    close();
+
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        printf("Unable to open replay corpus %s!\n", path.c_str());
+        return false;
+    }
+    mBuffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(mBuffer.data()), static_cast<std::streamsize>(mBuffer.size()));
+    mData = mBuffer.data();
+    mSize = mBuffer.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        printf("Unable to open replay corpus %s!\n", path.c_str());
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size <= 0)
+    {
+        printf("Unable to read the size of replay corpus %s!\n", path.c_str());
+        ::close(fd);
+        return false;
+    }
+    mSize = static_cast<size_t>(status.st_size);
+    void* mapping = mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        printf("Unable to map replay corpus %s!\n", path.c_str());
+        mSize = 0;
+        return false;
+    }
+    mData = static_cast<const uint8_t*>(mapping);
+#endif
+
+    // Validate just the header and the index bounds so opening stays O(1)
+    ReplayCorpusHeader header;
+    if (mSize < sizeof(header))
+    {
+        printf("Replay corpus %s is truncated!\n", path.c_str());
+        close();
+        return false;
+    }
+    std::memcpy(&header, mData, sizeof(header));
+    if (std::memcmp(header.magic, REPLAY_CORPUS_MAGIC, sizeof(header.magic)) != 0
+        || header.version != REPLAY_CORPUS_VERSION
+        || header.headerSize != sizeof(ReplayCorpusHeader)
+        || header.indexOffset % alignof(ReplayIndexEntry) != 0
+        || header.indexOffset > mSize
+        || header.replayCount > (mSize - header.indexOffset) / sizeof(ReplayIndexEntry))
+    {
+        printf("%s is not a valid replay corpus!\n", path.c_str());
+        close();
+        return false;
+    }
+
+    mIndex = reinterpret_cast<const ReplayIndexEntry*>(mData + header.indexOffset);
+    mCount = static_cast<size_t>(header.replayCount);
+    return true;
+}
+
+void ReplayCorpus::close()
+{
+#ifdef _WIN32
+    mBuffer.clear();
+#else
+    if (mData != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(mData), mSize);
+    }
+#endif
+    mData = nullptr;
+    mSize = 0;
+    mIndex = nullptr;
+    mCount = 0;
+}
+
+size_t ReplayCorpus::size() const
+{
+    return mCount;
+}
+
+const ReplayMetadata& ReplayCorpus::getMetadata(size_t index) const
+{
+    return mIndex[index].metadata;
+}
+
+ReplayView ReplayCorpus::getReplay(size_t index) const
+{
+    const ReplayIndexEntry& entry = mIndex[index];
+
+    // Offsets are absolute and payloads live between the header and the index.
+    // A corrupt entry gives an empty replay
+    size_t indexOffset = static_cast<size_t>(reinterpret_cast<const uint8_t*>(mIndex) - mData);
+    if (entry.offset < sizeof(ReplayCorpusHeader)
+        || entry.offset > indexOffset
+        || entry.metadata.length > indexOffset - entry.offset)
+    {
+        return ReplayView { &entry.metadata, nullptr, 0 };
+    }
+    return ReplayView { &entry.metadata, mData + entry.offset, entry.metadata.length };
+}
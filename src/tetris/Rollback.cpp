@@ -0,0 +1,190 @@
+#include "tetris/Rollback.h"
+#include "engine/ByteOrder.h"
+#include "tetris/Input.h"
+#include <algorithm>
+
+namespace
+{
+// magic, first tick, ack, count
+constexpr size_t PACKET_HEADER_SIZE = 14;
+}
+
+RollbackSession::RollbackSession(std::unordered_map<std::string_view, std::unique_ptr<Texture>>& textures,
+    uint64_t seed,
+    size_t localPlayer,
+    UdpSocket& socket)
+    : mLocalPlayer { localPlayer }
+    , mSocket { socket }
+    , mSimulations { TetrisSimulation { textures, seed }, TetrisSimulation { textures, seed } }
+    , mSnapshots {}
+    , mLocalInputs {}
+    , mRemoteInputs {}
+    , mRemoteInputsUsed {}
+    , mTick { 0 }
+    , mRemoteConfirmed { 0 }
+    , mRemoteAcked { 0 }
+    , mRollbackFrom { UINT32_MAX }
+    , mLastRemoteInput { INPUT_NONE }
+    , mStats {}
+{
+}
+
+bool RollbackSession::advance(uint8_t localInput)
+{
+    receiveInputs();
+    rollback();
+
+    // Too far ahead - we would overwrite snapshots or inputs we may still need
+    if (mTick + 1 - mRemoteConfirmed >= ROLLBACK_WINDOW || mTick + 1 - mRemoteAcked > ROLLBACK_WINDOW)
+    {
+        mStats.stalls++;
+        sendInputs();
+        return false;
+    }
+
+    mLocalInputs[mTick % ROLLBACK_WINDOW] = localInput;
+    simulateTick(mTick);
+    mTick++;
+    sendInputs();
+    return true;
+}
+
+void RollbackSession::poll()
+{
+    receiveInputs();
+    rollback();
+    sendInputs();
+}
+
+TetrisSimulation& RollbackSession::getSimulation(size_t player)
+{
+    return mSimulations[player];
+}
+
+uint32_t RollbackSession::getTick()
+{
+    return mTick;
+}
+
+uint32_t RollbackSession::getConfirmedTick()
+{
+    return std::min(mTick, mRemoteConfirmed);
+}
+
+RollbackStats RollbackSession::getStats()
+{
+    return mStats;
+}
+
+void RollbackSession::simulateTick(uint32_t tick)
+{
+    size_t slot = tick % ROLLBACK_WINDOW;
+    mSnapshots[slot][0] = mSimulations[0].snapshot();
+    mSnapshots[slot][1] = mSimulations[1].snapshot();
+
+    // Use the real remote input if we have it, otherwise predict that held keys stay held
+    uint8_t remoteInput = (tick < mRemoteConfirmed)
+        ? mRemoteInputs[slot]
+        : static_cast<uint8_t>(mLastRemoteInput & INPUT_HELD_MASK);
+    mRemoteInputsUsed[slot] = remoteInput;
+
+    mSimulations[mLocalPlayer].step(mLocalInputs[slot]);
+    mSimulations[1 - mLocalPlayer].step(remoteInput);
+}
+
+void RollbackSession::rollback()
+{
+    if (mRollbackFrom >= mTick)
+    {
+        mRollbackFrom = UINT32_MAX;
+        return;
+    }
+
+    // Rewind to the first mispredicted tick and run forward again
+    size_t slot = mRollbackFrom % ROLLBACK_WINDOW;
+    mSimulations[0].restore(mSnapshots[slot][0]);
+    mSimulations[1].restore(mSnapshots[slot][1]);
+    for (uint32_t tick = mRollbackFrom; tick < mTick; ++tick)
+    {
+        simulateTick(tick);
+    }
+
+    uint32_t resimulated = mTick - mRollbackFrom;
+    mStats.rollbacks++;
+    mStats.resimulatedTicks += resimulated;
+    mStats.maxResimulatedTicks = std::max(mStats.maxResimulatedTicks, resimulated);
+    mRollbackFrom = UINT32_MAX;
+}
+
+void RollbackSession::receiveInputs()
+{
+    // Never accept so far ahead that we overwrite inputs a rollback could still need
+    uint32_t limit = mRemoteConfirmed + ROLLBACK_WINDOW;
+
+    uint8_t packet[ROLLBACK_MAX_PACKET_SIZE];
+    size_t size;
+    while ((size = mSocket.receive(packet, sizeof(packet))) > 0)
+    {
+        if (size < PACKET_HEADER_SIZE || readU32(packet) != ROLLBACK_PACKET_MAGIC)
+        {
+            continue;
+        }
+        uint32_t firstTick = readU32(packet + 4);
+        uint32_t ack = readU32(packet + 8);
+        size_t count = readU16(packet + 12);
+        if (size < PACKET_HEADER_SIZE + count)
+        {
+            continue;
+        }
+
+        mRemoteAcked = std::max(mRemoteAcked, std::min(ack, mTick));
+
+        // Packets always start at the oldest input we have not acknowledged,
+        // so anything starting later than that is out of order - wait for a resend
+        if (firstTick > mRemoteConfirmed)
+        {
+            continue;
+        }
+        for (size_t index = 0; index < count; ++index)
+        {
+            uint32_t tick = firstTick + static_cast<uint32_t>(index);
+            if (tick < mRemoteConfirmed)
+            {
+                continue;
+            }
+            if (tick >= limit)
+            {
+                break;
+            }
+
+            uint8_t input = packet[PACKET_HEADER_SIZE + index];
+            size_t slot = tick % ROLLBACK_WINDOW;
+            mRemoteInputs[slot] = input;
+            mLastRemoteInput = input;
+            mRemoteConfirmed++;
+
+            // We already simulated this tick with a guess. If the guess was wrong, roll back
+            if (tick < mTick && mRemoteInputsUsed[slot] != input)
+            {
+                mStats.mispredictions++;
+                mRollbackFrom = std::min(mRollbackFrom, tick);
+            }
+        }
+    }
+}
+
+void RollbackSession::sendInputs()
+{
+    // Resend every input the peer has not acknowledged yet, so lost packets don't matter
+    uint8_t packet[ROLLBACK_MAX_PACKET_SIZE];
+    uint32_t count = mTick - mRemoteAcked;
+    writeU32(packet, ROLLBACK_PACKET_MAGIC);
+    writeU32(packet + 4, mRemoteAcked);
+    writeU32(packet + 8, mRemoteConfirmed);
+    writeU16(packet + 12, static_cast<uint16_t>(count));
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        packet[PACKET_HEADER_SIZE + index] = mLocalInputs[(mRemoteAcked + index) % ROLLBACK_WINDOW];
+    }
+    mSocket.send(packet, PACKET_HEADER_SIZE + count);
+}
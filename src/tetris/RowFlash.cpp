@@ -0,0 +1,48 @@
+#include "tetris/RowFlash.h"
+
+RowFlash::RowFlash()
+    : mOffsetX { 0 }
+    , mCols { 0 }
+    , mClear {}
+    , mFlashesRemaining { 0 }
+    , mNextFlashTime { 0 }
+{
+}
+
+RowFlash::RowFlash(const LineClear& clear, size_t cols, int offsetX, Uint32 startTime)
+    : mOffsetX { offsetX }
+    , mCols { cols }
+    , mClear { clear }
+    , mFlashesRemaining { N_ROW_FLASHES }
+    , mNextFlashTime { startTime + COMPLETED_ROW_FLASH_INTERVAL_MS }
+{
+}
+
+bool RowFlash::advance(Uint32 now)
+{
+    // A long frame can skip flashes, but never makes the effect last longer
+    while (mFlashesRemaining > 0 && now >= mNextFlashTime)
+    {
+        mFlashesRemaining -= 1;
+        mNextFlashTime += COMPLETED_ROW_FLASH_INTERVAL_MS;
+    }
+    return mFlashesRemaining > 0;
+}
+
+void RowFlash::render(Texture* whiteFlashTexture, Texture* blackFlashTexture) const
+{
+    // Starts black, then alternates
+    Texture* texture = (mFlashesRemaining % 2 == 0) ? blackFlashTexture : whiteFlashTexture;
+    for (size_t offset = 0; offset < MAX_TETRONIMO_SIZE; ++offset)
+    {
+        if (((mClear.rowMask >> offset) & 1u) == 0)
+        {
+            continue;
+        }
+        size_t row = mClear.bottomRow - offset;
+        for (size_t col = 0; col < mCols; ++col)
+        {
+            texture->render(mOffsetX + static_cast<int>(col) * BLOCK_SIZE, static_cast<int>(row) * BLOCK_SIZE);
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#include "tetris/SharedStatePublisher.h"
+#include <cstdio>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+SharedStatePublisher::SharedStatePublisher()
+    : mName {}
+    , mState { nullptr }
+{
+}
+
+SharedStatePublisher::~SharedStatePublisher()
+{
+    close();
+}
+
+bool SharedStatePublisher::isOpen() const
+{
+    return mState != nullptr;
+}
+
+#ifndef _WIN32
+bool SharedStatePublisher::open(const std::string& name)
+{
+    close();
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+    if (fd < 0)
+    {
+        printf("Unable to create shared memory %s!\n", name.c_str());
+        return false;
+    }
+    if (ftruncate(fd, sizeof(TetrisSharedState)) != 0)
+    {
+        printf("Unable to size shared memory %s!\n", name.c_str());
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void* memory = mmap(nullptr, sizeof(TetrisSharedState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        printf("Unable to map shared memory %s!\n", name.c_str());
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // The magic is published last and readers check it first, so a half initialised segment is never trusted
+    mName = name;
+    mState = static_cast<TetrisSharedState*>(memory);
+    __atomic_store_n(&mState->magic, 0u, __ATOMIC_RELAXED);
+    mState->version = TETRIS_SHARED_STATE_VERSION;
+    mState->snapshotSize = sizeof(TetrisSharedSnapshot);
+    mState->sequence = 0;
+    mState->snapshot = TetrisSharedSnapshot {};
+    __atomic_store_n(&mState->magic, TETRIS_SHARED_STATE_MAGIC, __ATOMIC_RELEASE);
+    return true;
+}
+
+void SharedStatePublisher::close()
+{
+    if (mState == nullptr)
+    {
+        return;
+    }
+    munmap(mState, sizeof(TetrisSharedState));
+    shm_unlink(mName.c_str());
+    mState = nullptr;
+}
+
+void SharedStatePublisher::publish(const GameState& state, uint32_t stepTimeUs)
+{
+    if (mState == nullptr)
+    {
+        return;
+    }
+
+    // Odd while writing. The fence keeps the writes below from being seen before it
+    uint32_t sequence = __atomic_load_n(&mState->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&mState->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    TetrisSharedSnapshot& snapshot = mState->snapshot;
+    snapshot.tick = state.tick;
+    snapshot.score = state.score;
+    snapshot.playing = state.playing ? 1 : 0;
+    snapshot.rows = static_cast<uint8_t>(state.board.rows);
+    snapshot.cols = static_cast<uint8_t>(state.board.cols);
+    snapshot.tickMs = TICK_MS;
+    snapshot.publishTimeUs = nowUs();
+    snapshot.stepTimeUs = stepTimeUs;
+    snapshot.blockSize = BLOCK_SIZE;
+    for (size_t row = 0; row < MAX_STATE_ROWS; ++row)
+    {
+        uint32_t occupied = 0;
+        for (size_t col = 0; col < MAX_STATE_COLS; ++col)
+        {
+            uint8_t cell = state.board.cells[row][col];
+            snapshot.boardCells[row][col] = cell;
+            occupied |= (cell != 0) ? (1u << col) : 0u;
+        }
+        snapshot.boardRows[row] = occupied;
+    }
+    snapshot.pieceX = state.tetronimo.posX;
+    snapshot.pieceY = state.tetronimo.posY;
+    snapshot.pieceRows = static_cast<uint8_t>(state.tetronimo.rows);
+    snapshot.pieceCols = static_cast<uint8_t>(state.tetronimo.cols);
+    for (size_t row = 0; row < MAX_TETRONIMO_SIZE; ++row)
+    {
+        for (size_t col = 0; col < MAX_TETRONIMO_SIZE; ++col)
+        {
+            snapshot.pieceCells[row][col] = state.tetronimo.cells[row][col];
+        }
+    }
+
+    __atomic_store_n(&mState->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+uint64_t SharedStatePublisher::nowUs()
+{
+    timespec now {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000000 + static_cast<uint64_t>(now.tv_nsec) / 1000;
+}
+#else
+bool SharedStatePublisher::open(const std::string& name)
+{
+    printf("Unable to publish %s, shared memory needs POSIX!\n", name.c_str());
+    return false;
+}
+
+void SharedStatePublisher::close()
+{
+}
+
+void SharedStatePublisher::publish(const GameState&, uint32_t)
+{
+}
+
+uint64_t SharedStatePublisher::nowUs()
+{
+    return 0;
+}
+#endif
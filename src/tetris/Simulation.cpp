@@ -0,0 +1,111 @@
+#include "tetris/Simulation.h"
+#include <cstring>
+
+TetrisSimulation::TetrisSimulation(std::unordered_map<std::string_view, std::unique_ptr<Texture>>& textures,
+    uint64_t seed,
+    AutoShiftSettings autoShift,
+    BoardSize board)
+    : mPalette { textures }
+    , mGameBoard { 0, 0, board.rows, board.cols }
+    , mCurrentTetronimo { 0, 0, MAX_TETRONIMO_SIZE, MAX_TETRONIMO_SIZE } // room for any piece
+    , mFactory { textures, seed, tetronimoStartX(board.cols) }
+    , mCollisionHandler {}
+    , mAutoShift { autoShift }
+    , mListener { nullptr }
+    , mTick { 0 }
+    , mScore { 0 }
+    , mPlaying { true }
+{
+    mGameBoard.updatePositions();
+    mFactory.getNextTetronimo(mCurrentTetronimo);
+}
+
+void TetrisSimulation::step(uint8_t input)
+{
+    if (mPlaying)
+    {
+        // Handle movement and collisions
+        mCurrentTetronimo.applyInput(input, mAutoShift.update(input));
+        if (mCollisionHandler.handle(mCurrentTetronimo, mGameBoard))
+        {
+            mFactory.getNextTetronimo(mCurrentTetronimo);
+            mScore = mScore + SCORE_PER_TETRONIMO;
+            if (mListener != nullptr)
+            {
+                mListener->pieceSpawned();
+            }
+        }
+        mPlaying = mCollisionHandler.keepPlaying();
+    }
+    mTick++;
+}
+
+GameState TetrisSimulation::snapshot()
+{
+    // Zero the padding too, so snapshots can be compared with memcmp
+    GameState state;
+    std::memset(&state, 0, sizeof(state));
+    mGameBoard.snapshot(state.board, mPalette);
+    mCurrentTetronimo.snapshot(state.tetronimo, mPalette);
+    mCollisionHandler.snapshot(state);
+    state.autoShiftDirection = mAutoShift.getDirection();
+    state.autoShiftHeldTicks = mAutoShift.getHeldTicks();
+    state.generatorState = mFactory.getState();
+    state.tick = mTick;
+    state.score = mScore;
+    state.playing = mPlaying;
+    return state;
+}
+
+void TetrisSimulation::restore(const GameState& state)
+{
+    mGameBoard.restore(state.board, mPalette);
+    mCurrentTetronimo.restore(state.tetronimo, mPalette);
+    mCollisionHandler.restore(state);
+    mAutoShift.setState(state.autoShiftDirection, state.autoShiftHeldTicks);
+    mFactory.setState(state.generatorState);
+    mTick = state.tick;
+    mScore = state.score;
+    mPlaying = state.playing;
+}
+
+void TetrisSimulation::setCollisionListener(CollisionListener* listener)
+{
+    mListener = listener;
+    mCollisionHandler.setListener(listener);
+}
+
+const LineClear& TetrisSimulation::getLastClear() const
+{
+    return mCollisionHandler.getLastClear();
+}
+
+const HardDrop& TetrisSimulation::getLastDrop() const
+{
+    return mCollisionHandler.getLastDrop();
+}
+
+Grid& TetrisSimulation::getGameBoard()
+{
+    return mGameBoard;
+}
+
+Grid& TetrisSimulation::getCurrentTetronimo()
+{
+    return mCurrentTetronimo;
+}
+
+uint32_t TetrisSimulation::getTick()
+{
+    return mTick;
+}
+
+uint32_t TetrisSimulation::getScore()
+{
+    return mScore;
+}
+
+bool TetrisSimulation::isPlaying()
+{
+    return mPlaying;
+}
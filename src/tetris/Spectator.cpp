@@ -0,0 +1,281 @@
+#include "tetris/Spectator.h"
+#include <cmath>
+
+namespace
+{
+// Flat colours standing in for the block textures, by palette index
+constexpr std::array<SDL_Color, PALETTE_TEXTURES.size() + 1> PALETTE_COLOURS {
+    SDL_Color { 0, 0, 0, 0 }, // no block
+    SDL_Color { 0xE0, 0x30, 0x30, 0xFF }, // red
+    SDL_Color { 0x30, 0x90, 0xE0, 0xFF }, // blue
+    SDL_Color { 0xF0, 0xD0, 0x30, 0xFF }, // yellow
+    SDL_Color { 0x40, 0xC0, 0x40, 0xFF }, // green
+    SDL_Color { 0xA0, 0x40, 0xC0, 0xFF }, // purple
+    SDL_Color { 0xF0, 0x90, 0x30, 0xFF }, // orange
+    SDL_Color { 0x20, 0x30, 0x90, 0xFF }, // navy
+    SDL_Color { 0x80, 0x80, 0x80, 0xFF }, // grey
+    SDL_Color { 0xFF, 0xFF, 0xFF, 0xFF }, // white
+    SDL_Color { 0x00, 0x00, 0x00, 0xFF }, // black
+};
+constexpr SDL_Color BOARD_COLOUR { 0x20, 0x20, 0x28, 0xFF };
+constexpr SDL_Color START_LINE_COLOUR { 0x60, 0x60, 0x68, 0xFF };
+
+// Background, start line, the board and a piece
+constexpr size_t MAX_QUADS_PER_BOARD = 2 + N_ROWS * N_COLS + MAX_TETRONIMO_SIZE * MAX_TETRONIMO_SIZE;
+
+int tileWidth(int blockSize)
+{
+    return N_COLS * blockSize + SPECTATOR_GAP;
+}
+
+int tileHeight(int blockSize)
+{
+    return N_ROWS * blockSize + SPECTATOR_GAP;
+}
+
+// Enough columns of tiles to make the window roughly square
+size_t tileColumns(const SpectatorConfig& config)
+{
+    double ratio = static_cast<double>(tileHeight(config.blockSize)) / tileWidth(config.blockSize);
+    auto columns = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(config.boards) * ratio)));
+    return std::max<size_t>(1, std::min(columns, config.boards));
+}
+
+size_t tileRows(const SpectatorConfig& config)
+{
+    size_t columns = tileColumns(config);
+    return (config.boards + columns - 1) / columns;
+}
+}
+
+SpectatorGameEngine::SpectatorGameEngine(const SpectatorConfig& config)
+    : BaseEngine(static_cast<int>(tileRows(config)) * tileHeight(config.blockSize) + SPECTATOR_GAP + BOTTOM_BAR_HEIGHT,
+        static_cast<int>(tileColumns(config)) * tileWidth(config.blockSize) + SPECTATOR_GAP)
+    , mConfig { config }
+    , mColumns { tileColumns(config) }
+    , mReplays {}
+    , mNextReplay { 0 }
+    , mNextSeed { config.seed }
+    , mBoards {}
+    , mGamesFinished { 0 }
+    , mNextTickTime { 0 }
+    , mPalette {}
+    , mVertices {}
+    , mIndices {}
+    , mInfoBar {}
+    , mInfoBarText {}
+{
+}
+
+bool SpectatorGameEngine::loadMedia()
+{
+    // The blocks are drawn as flat colours, but the simulations still
+    // deal pieces by texture
+    bool success = true;
+    mTextures.clear();
+    for (auto textureName : PALETTE_TEXTURES)
+    {
+        success = success && loadTexture(textureName);
+    }
+    return success;
+}
+
+bool SpectatorGameEngine::create()
+{
+    if (!mConfig.replayPath.empty() && !mReplays.open(mConfig.replayPath))
+    {
+        mQuit = true;
+        return false;
+    }
+    printf("Spectating %zu boards played by %s\n", mConfig.boards, mReplays.size() > 0 ? "replays" : "bots");
+
+    mPalette = TexturePalette(mTextures);
+    mBoards.reserve(mConfig.boards);
+    for (size_t index = 0; index < mConfig.boards; ++index)
+    {
+        mBoards.push_back(Board { nullptr, Bot { 0 }, ReplayView {} });
+        restartBoard(index);
+    }
+    mNextTickTime = SDL_GetTicks();
+
+    // Two triangles per quad, the same pattern for every board
+    mVertices.reserve(4 * MAX_QUADS_PER_BOARD);
+    mIndices.reserve(6 * MAX_QUADS_PER_BOARD);
+    for (int quad = 0; quad < static_cast<int>(MAX_QUADS_PER_BOARD); ++quad)
+    {
+        for (int corner : { 0, 1, 2, 2, 1, 3 })
+        {
+            mIndices.push_back(4 * quad + corner);
+        }
+    }
+
+    // Finished games are replaced with new simulations, which allocate
+    mCheckFrameAllocations = false;
+
+    mInfoBar = std::make_unique<Texture>(mRenderer.get(), mFont.get());
+    mInfoBarText.reserve(INFO_TEXT_SIZE);
+    updateInformationBar();
+    return true;
+}
+
+void SpectatorGameEngine::restartBoard(size_t index)
+{
+    Board& board = mBoards[index];
+    uint64_t seed;
+    if (mReplays.size() > 0)
+    {
+        board.replay = mReplays.getReplay(mNextReplay++ % mReplays.size());
+        seed = board.replay.metadata->seed;
+    }
+    else
+    {
+        seed = mNextSeed++;
+        board.bot = Bot { seed };
+    }
+    board.simulation = std::make_unique<TetrisSimulation>(mTextures, seed);
+}
+
+void SpectatorGameEngine::updateInformationBar()
+{
+    uint32_t bestScore = 0;
+    for (auto& board : mBoards)
+    {
+        bestScore = std::max(bestScore, board.simulation->getScore());
+    }
+
+    char* text = mFrameArena.allocateArray<char>(INFO_TEXT_SIZE);
+    snprintf(text, INFO_TEXT_SIZE, "  fps  %d  |  boards  %zu  |  games  %u  |  best  %u",
+        mFps,
+        mBoards.size(),
+        mGamesFinished,
+        bestScore);
+
+    // Rasterizing text is not free, only do it when something changed
+    if (mInfoBarText == text)
+    {
+        return;
+    }
+    mInfoBarText = text;
+    if (!mInfoBar->loadFromRenderedText(mInfoBarText.c_str(), TEXT_COLOUR, BACKGROUND_COLOUR))
+    {
+        printf("Failed to load text texture\n");
+    }
+}
+
+bool SpectatorGameEngine::update()
+{
+    while (SDL_PollEvent(&mEvent) != 0)
+    {
+        if (mEvent.type == SDL_QUIT)
+        {
+            mQuit = true;
+        }
+        handleCaptureKeys(mEvent);
+    }
+
+    // Every board runs at the normal tick rate. If a frame runs long,
+    // catch up a little and then let the games fall behind real time
+    Uint32 now = SDL_GetTicks();
+    for (Uint32 ticks = 0; now >= mNextTickTime && ticks < SPECTATOR_MAX_CATCH_UP_TICKS; ++ticks)
+    {
+        for (size_t index = 0; index < mBoards.size(); ++index)
+        {
+            Board& board = mBoards[index];
+            TetrisSimulation& simulation = *board.simulation;
+            if (board.replay.inputs != nullptr && simulation.getTick() >= board.replay.length)
+            {
+                restartBoard(index);
+                continue;
+            }
+
+            uint8_t input = (board.replay.inputs != nullptr)
+                ? board.replay.inputs[simulation.getTick()]
+                : board.bot.nextInput(simulation);
+            simulation.step(input);
+            if (!simulation.isPlaying())
+            {
+                mGamesFinished++;
+                restartBoard(index);
+            }
+        }
+        mNextTickTime += TICK_MS;
+    }
+    if (now >= mNextTickTime)
+    {
+        mNextTickTime = now + TICK_MS;
+    }
+
+    updateInformationBar();
+    return true;
+}
+
+void SpectatorGameEngine::fontReloaded()
+{
+    mInfoBar->setFont(mFont.get());
+}
+
+void SpectatorGameEngine::addQuad(float x, float y, float width, float height, SDL_Color colour)
+{
+    mVertices.push_back(SDL_Vertex { SDL_FPoint { x, y }, colour, SDL_FPoint { 0, 0 } });
+    mVertices.push_back(SDL_Vertex { SDL_FPoint { x + width, y }, colour, SDL_FPoint { 0, 0 } });
+    mVertices.push_back(SDL_Vertex { SDL_FPoint { x, y + height }, colour, SDL_FPoint { 0, 0 } });
+    mVertices.push_back(SDL_Vertex { SDL_FPoint { x + width, y + height }, colour, SDL_FPoint { 0, 0 } });
+}
+
+void SpectatorGameEngine::addGrid(Grid& grid, float x, float y)
+{
+    // Simulation positions are in full size pixels
+    float blockSize = static_cast<float>(mConfig.blockSize);
+    float scale = blockSize / BLOCK_SIZE;
+    float originX = x + static_cast<float>(grid.getPosX()) * scale;
+    float originY = y + static_cast<float>(grid.getPosY()) * scale;
+
+    for (size_t row = 0; row < grid.getHeight(); ++row)
+    {
+        // Most rows of a board are empty, skip them without touching the Blocks
+        if (grid.getRowMask(row) == 0)
+        {
+            continue;
+        }
+        Block* blocks = grid.getRow(row);
+        for (size_t col = 0; col < grid.getWidth(); ++col)
+        {
+            if (blocks[col].exists())
+            {
+                // Leave a pixel between blocks so they stay readable
+                addQuad(originX + static_cast<float>(col) * blockSize,
+                    originY + static_cast<float>(row) * blockSize,
+                    blockSize - 1,
+                    blockSize - 1,
+                    PALETTE_COLOURS[mPalette.indexOf(blocks[col].getTexture())]);
+            }
+        }
+    }
+}
+
+bool SpectatorGameEngine::render()
+{
+    float blockSize = static_cast<float>(mConfig.blockSize);
+    float boardWidth = N_COLS * blockSize;
+    float startLine = static_cast<float>(START_LINE) * blockSize / BLOCK_SIZE;
+
+    for (size_t index = 0; index < mBoards.size(); ++index)
+    {
+        float x = static_cast<float>(SPECTATOR_GAP + static_cast<int>(index % mColumns) * tileWidth(mConfig.blockSize));
+        float y = static_cast<float>(SPECTATOR_GAP + static_cast<int>(index / mColumns) * tileHeight(mConfig.blockSize));
+        TetrisSimulation& simulation = *mBoards[index].simulation;
+
+        mVertices.clear();
+        addQuad(x, y, boardWidth, N_ROWS * blockSize, BOARD_COLOUR);
+        addQuad(x, y + startLine, boardWidth, 1, START_LINE_COLOUR);
+        addGrid(simulation.getGameBoard(), x, y);
+        addGrid(simulation.getCurrentTetronimo(), x, y);
+
+        // The whole board in one draw call
+        int vertices = static_cast<int>(mVertices.size());
+        SDL_RenderGeometry(mRenderer.get(), nullptr, mVertices.data(), vertices, mIndices.data(), vertices / 4 * 6);
+    }
+
+    mInfoBar->render(0, mScreenHeight - BOTTOM_BAR_HEIGHT);
+    return true;
+}
@@ -0,0 +1,529 @@
+#include "tetris/SpectatorStream.h"
+#include "engine/ByteOrder.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace
+{
+constexpr uint8_t HEADER_DY_MASK = 0x03;
+constexpr uint8_t HEADER_DY_SLOW = 1;
+constexpr uint8_t HEADER_DY_FAST = 2;
+constexpr uint8_t HEADER_DY_EXPLICIT = 3;
+constexpr uint8_t HEADER_DX_SHIFT = 2;
+constexpr uint8_t HEADER_DX_LEFT = 1;
+constexpr uint8_t HEADER_DX_RIGHT = 2;
+constexpr uint8_t HEADER_DX_EXPLICIT = 3;
+constexpr uint8_t HEADER_ROTATE = 1 << 4;
+constexpr uint8_t HEADER_EVENTS = 1 << 5;
+constexpr uint8_t HEADER_KEYFRAME = 1 << 6;
+constexpr uint8_t HEADER_GAME_OVER = 1 << 7;
+
+void appendU16(std::vector<uint8_t>& out, uint16_t value)
+{
+    uint8_t buffer[2];
+    writeU16(buffer, value);
+    out.insert(out.end(), buffer, buffer + 2);
+}
+
+void appendU32(std::vector<uint8_t>& out, uint32_t value)
+{
+    uint8_t buffer[4];
+    writeU32(buffer, value);
+    out.insert(out.end(), buffer, buffer + 4);
+}
+}
+
+SpectatorStreamEncoder::SpectatorStreamEncoder(TetrisSimulation& simulation,
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>>& textures,
+    uint32_t keyframeInterval)
+    : mSimulation { simulation }
+    , mPalette { textures }
+    , mKeyframeInterval { std::max<uint32_t>(keyframeInterval, 1) }
+    , mTicksSinceKeyframe { 0 }
+    , mCatchUp {}
+    , mStarted { false }
+    , mLastTick { 0 }
+    , mLastPosX { 0 }
+    , mLastPosY { 0 }
+    , mEvents {}
+    , mEventCount { 0 }
+    , mRotated { false }
+    , mLocked { false }
+    , mLockPosX { 0 }
+    , mLockPosY { 0 }
+{
+    mSimulation.setCollisionListener(this);
+}
+
+SpectatorStreamEncoder::~SpectatorStreamEncoder()
+{
+    mSimulation.setCollisionListener(nullptr);
+}
+
+void SpectatorStreamEncoder::pieceRotated()
+{
+    mRotated = true;
+}
+
+void SpectatorStreamEncoder::pieceLocked()
+{
+    // The next piece replaces this one before encodeTick sees it
+    mLocked = true;
+    mLockPosX = mSimulation.getCurrentTetronimo().getPosX();
+    mLockPosY = mSimulation.getCurrentTetronimo().getPosY();
+    mEvents.push_back(STREAM_EVENT_LOCK);
+    mEventCount++;
+}
+
+void SpectatorStreamEncoder::rowsCleared(size_t bottomRow, size_t count)
+{
+    mEvents.push_back(STREAM_EVENT_CLEAR);
+    appendU16(mEvents, static_cast<uint16_t>(bottomRow));
+    mEvents.push_back(static_cast<uint8_t>(count));
+    mEventCount++;
+}
+
+// Pieces are a single colour, so one palette index and a bit per cell:
+// uint8 rows << 4 | cols, uint16 cells row by row, uint8 palette index, int32 x, int32 y
+void SpectatorStreamEncoder::writePiece(std::vector<uint8_t>& out)
+{
+    Grid& piece = mSimulation.getCurrentTetronimo();
+    uint16_t cells = 0;
+    uint8_t colour = 0;
+    piece.forEachBlock(
+        [&cells, &colour, &piece, this](Block& block, size_t xIndex, size_t yIndex)
+        {
+            if (block.exists())
+            {
+                cells |= static_cast<uint16_t>(1 << (yIndex * piece.getWidth() + xIndex));
+                colour = mPalette.indexOf(block.getTexture());
+            }
+        });
+    out.push_back(static_cast<uint8_t>(piece.getHeight() << 4 | piece.getWidth()));
+    appendU16(out, cells);
+    out.push_back(colour);
+    appendU32(out, static_cast<uint32_t>(piece.getPosX()));
+    appendU32(out, static_cast<uint32_t>(piece.getPosY()));
+}
+
+// uint32 tick, uint32 score, uint16 rows, uint8 cols, uint16 first row with
+// blocks, then from that row down the row mask bytes followed by a palette
+// index for each block, then the piece
+void SpectatorStreamEncoder::writeKeyframe(std::vector<uint8_t>& out)
+{
+    Grid& board = mSimulation.getGameBoard();
+    size_t top = 0;
+    while (top < board.getHeight() && board.getRowMask(top) == 0)
+    {
+        top++;
+    }
+
+    out.push_back(static_cast<uint8_t>(HEADER_KEYFRAME | (mSimulation.isPlaying() ? 0 : HEADER_GAME_OVER)));
+    appendU32(out, mSimulation.getTick());
+    appendU32(out, mSimulation.getScore());
+    appendU16(out, static_cast<uint16_t>(board.getHeight()));
+    out.push_back(static_cast<uint8_t>(board.getWidth()));
+    appendU16(out, static_cast<uint16_t>(top));
+    size_t maskBytes = (board.getWidth() + 7) / 8;
+    for (size_t row = top; row < board.getHeight(); ++row)
+    {
+        uint64_t mask = board.getRowMask(row);
+        for (size_t byte = 0; byte < maskBytes; ++byte)
+        {
+            out.push_back(static_cast<uint8_t>(mask >> (8 * byte)));
+        }
+        Block* blocks = board.getRow(row);
+        for (size_t col = 0; col < board.getWidth(); ++col)
+        {
+            if ((mask >> col) & 1)
+            {
+                out.push_back(mPalette.indexOf(blocks[col].getTexture()));
+            }
+        }
+    }
+    writePiece(out);
+}
+
+void SpectatorStreamEncoder::rememberPiece()
+{
+    mLastPosX = mSimulation.getCurrentTetronimo().getPosX();
+    mLastPosY = mSimulation.getCurrentTetronimo().getPosY();
+    mLastTick = mSimulation.getTick();
+    mStarted = true;
+    mEvents.clear();
+    mEventCount = 0;
+    mRotated = false;
+    mLocked = false;
+}
+
+void SpectatorStreamEncoder::encodeTick(std::vector<uint8_t>& out)
+{
+    size_t start = out.size();
+    bool jumped = !mStarted || mSimulation.getTick() != mLastTick + 1;
+    if (jumped || ++mTicksSinceKeyframe >= mKeyframeInterval)
+    {
+        writeKeyframe(out);
+        mCatchUp.assign(out.begin() + static_cast<std::ptrdiff_t>(start), out.end());
+        mTicksSinceKeyframe = 0;
+        rememberPiece();
+        return;
+    }
+
+    // How the piece moved up to where it is now, or to where it locked
+    Grid& piece = mSimulation.getCurrentTetronimo();
+    int dx = ((mLocked ? mLockPosX : piece.getPosX()) - mLastPosX) / BLOCK_SIZE;
+    int dy = (mLocked ? mLockPosY : piece.getPosY()) - mLastPosY;
+    if (mLocked)
+    {
+        mEvents.push_back(STREAM_EVENT_SPAWN);
+        writePiece(mEvents);
+        mEventCount++;
+    }
+
+    uint8_t header = mSimulation.isPlaying() ? 0 : HEADER_GAME_OVER;
+    header |= (dy == 0) ? 0 : (dy == VERTICAL_VELOCITY) ? HEADER_DY_SLOW : (dy == VERTICAL_FAST_VELOCITY) ? HEADER_DY_FAST : HEADER_DY_EXPLICIT;
+    uint8_t dxCode = (dx == 0) ? 0 : (dx == -1) ? HEADER_DX_LEFT : (dx == 1) ? HEADER_DX_RIGHT : HEADER_DX_EXPLICIT;
+    header |= static_cast<uint8_t>(dxCode << HEADER_DX_SHIFT);
+    header |= mRotated ? HEADER_ROTATE : 0;
+    header |= (mEventCount > 0) ? HEADER_EVENTS : 0;
+
+    out.push_back(header);
+    if (dxCode == HEADER_DX_EXPLICIT)
+    {
+        out.push_back(static_cast<uint8_t>(static_cast<int8_t>(dx)));
+    }
+    if ((header & HEADER_DY_MASK) == HEADER_DY_EXPLICIT)
+    {
+        appendU16(out, static_cast<uint16_t>(static_cast<int16_t>(dy)));
+    }
+    if (mEventCount > 0)
+    {
+        out.push_back(mEventCount);
+        out.insert(out.end(), mEvents.begin(), mEvents.end());
+    }
+    mCatchUp.insert(mCatchUp.end(), out.begin() + static_cast<std::ptrdiff_t>(start), out.end());
+    rememberPiece();
+}
+
+const std::vector<uint8_t>& SpectatorStreamEncoder::getCatchUp() const
+{
+    return mCatchUp;
+}
+
+// Bounds checked reads. Reading past the end gives zeros and marks the reader bad
+class SpectatorStreamDecoder::Reader
+{
+public:
+    Reader(const uint8_t* data, size_t size)
+        : mData { data }
+        , mSize { size }
+        , mOffset { 0 }
+        , mOk { true }
+    {
+    }
+
+    uint8_t u8()
+    {
+        return has(1) ? mData[mOffset++] : 0;
+    }
+
+    uint16_t u16()
+    {
+        uint16_t value = has(2) ? readU16(mData + mOffset) : 0;
+        mOffset += mOk ? 2 : 0;
+        return value;
+    }
+
+    uint32_t u32()
+    {
+        uint32_t value = has(4) ? readU32(mData + mOffset) : 0;
+        mOffset += mOk ? 4 : 0;
+        return value;
+    }
+
+    bool ok() const
+    {
+        return mOk;
+    }
+
+    size_t used() const
+    {
+        return mOffset;
+    }
+
+private:
+    bool has(size_t bytes)
+    {
+        mOk = mOk && mOffset + bytes <= mSize;
+        return mOk;
+    }
+
+    const uint8_t* mData;
+    size_t mSize;
+    size_t mOffset;
+    bool mOk;
+};
+
+SpectatorStreamDecoder::SpectatorStreamDecoder(std::unordered_map<std::string_view, std::unique_ptr<Texture>>& textures)
+    : mPalette { textures }
+    , mBoard { 0, 0, 0, 0 }
+    , mPiece { 0, 0, 0, 0 }
+    , mSynced { false }
+    , mTick { 0 }
+    , mScore { 0 }
+    , mPlaying { true }
+    , mLastClear {}
+{
+}
+
+size_t SpectatorStreamDecoder::decode(const uint8_t* data, size_t size)
+{
+    // Check the whole record first, so a partial one changes nothing
+    Reader check { data, size };
+    if (!readRecord(check, false) || !check.ok())
+    {
+        return 0;
+    }
+    Reader reader { data, size };
+    readRecord(reader, true);
+    return reader.used();
+}
+
+size_t SpectatorStreamDecoder::decodeAll(const uint8_t* data, size_t size)
+{
+    size_t used = 0;
+    size_t record;
+    while (used < size && (record = decode(data + used, size - used)) > 0)
+    {
+        used += record;
+    }
+    return used;
+}
+
+bool SpectatorStreamDecoder::readPiece(Reader& reader, bool apply)
+{
+    uint8_t size = reader.u8();
+    uint16_t cells = reader.u16();
+    Texture* texture = mPalette.at(reader.u8());
+    auto posX = static_cast<int32_t>(reader.u32());
+    auto posY = static_cast<int32_t>(reader.u32());
+    size_t rows = size >> 4;
+    size_t cols = size & 0x0F;
+    if (rows > MAX_TETRONIMO_SIZE || cols > MAX_TETRONIMO_SIZE)
+    {
+        return false;
+    }
+    if (apply)
+    {
+        mPiece.reset(posX, posY, rows, cols);
+        for (size_t cell = 0; cell < rows * cols; ++cell)
+        {
+            if ((cells >> cell) & 1)
+            {
+                mPiece.createBlock(static_cast<int>(cell % cols), static_cast<int>(cell / cols), texture);
+            }
+        }
+    }
+    return true;
+}
+
+bool SpectatorStreamDecoder::readKeyframe(Reader& reader, bool apply)
+{
+    uint32_t tick = reader.u32();
+    uint32_t score = reader.u32();
+    size_t rows = reader.u16();
+    size_t cols = reader.u8();
+    size_t top = reader.u16();
+    if (cols > MAX_BOARD_COLS || top > rows)
+    {
+        return false;
+    }
+    if (apply)
+    {
+        mBoard.reset(0, 0, rows, cols);
+        mTick = tick;
+        mScore = score;
+    }
+
+    size_t maskBytes = (cols + 7) / 8;
+    for (size_t row = top; row < rows && reader.ok(); ++row)
+    {
+        uint64_t mask = 0;
+        for (size_t byte = 0; byte < maskBytes; ++byte)
+        {
+            mask |= uint64_t { reader.u8() } << (8 * byte);
+        }
+        for (size_t col = 0; col < cols; ++col)
+        {
+            if ((mask >> col) & 1)
+            {
+                Texture* texture = mPalette.at(reader.u8());
+                if (apply)
+                {
+                    mBoard.createBlock(static_cast<int>(col), static_cast<int>(row), texture);
+                }
+            }
+        }
+    }
+    return readPiece(reader, apply);
+}
+
+bool SpectatorStreamDecoder::readRecord(Reader& reader, bool apply)
+{
+    uint8_t header = reader.u8();
+    if (header & HEADER_KEYFRAME)
+    {
+        if (!readKeyframe(reader, apply))
+        {
+            return false;
+        }
+        if (apply)
+        {
+            mPlaying = (header & HEADER_GAME_OVER) == 0;
+            mSynced = true;
+        }
+        return true;
+    }
+
+    // Deltas only mean something on top of a keyframe
+    apply = apply && mSynced;
+
+    int dx = 0;
+    switch ((header >> HEADER_DX_SHIFT) & 0x03)
+    {
+    case HEADER_DX_LEFT:
+        dx = -1;
+        break;
+    case HEADER_DX_RIGHT:
+        dx = 1;
+        break;
+    case HEADER_DX_EXPLICIT:
+        dx = static_cast<int8_t>(reader.u8());
+        break;
+    }
+    int dy = 0;
+    switch (header & HEADER_DY_MASK)
+    {
+    case HEADER_DY_SLOW:
+        dy = VERTICAL_VELOCITY;
+        break;
+    case HEADER_DY_FAST:
+        dy = VERTICAL_FAST_VELOCITY;
+        break;
+    case HEADER_DY_EXPLICIT:
+        dy = static_cast<int16_t>(reader.u16());
+        break;
+    }
+
+    // The same order as CollisionHandler::handle
+    if (apply)
+    {
+        mPiece.setVelX(dx * BLOCK_SIZE);
+        mPiece.move(1, 0);
+        if (header & HEADER_ROTATE)
+        {
+            mPiece.rotateClockwise();
+        }
+        mPiece.setVelY(dy);
+        mPiece.move(0, 1);
+    }
+
+    // Every run of rows a piece cleared is an event, they make one LineClear
+    bool cleared = false;
+    size_t events = (header & HEADER_EVENTS) ? reader.u8() : 0;
+    for (size_t event = 0; event < events && reader.ok(); ++event)
+    {
+        switch (reader.u8())
+        {
+        case STREAM_EVENT_LOCK:
+            if (apply)
+            {
+                // Like CollisionHandler::freezeTetronimo
+                int rowOnBoard = mPiece.getPosY() / BLOCK_SIZE;
+                int colOnBoard = mPiece.getPosX() / BLOCK_SIZE;
+                mPiece.forEachBlock(
+                    [this, rowOnBoard, colOnBoard](Block& block, size_t xIndex, size_t yIndex)
+                    {
+                        int col = colOnBoard + static_cast<int>(xIndex);
+                        int row = rowOnBoard + static_cast<int>(yIndex);
+                        if (block.exists() && col >= 0 && row >= 0
+                            && static_cast<size_t>(col) < mBoard.getWidth() && static_cast<size_t>(row) < mBoard.getHeight())
+                        {
+                            mBoard.createBlock(col, row, block.getTexture());
+                        }
+                    });
+                mScore += SCORE_PER_TETRONIMO;
+            }
+            break;
+
+        case STREAM_EVENT_CLEAR:
+        {
+            size_t bottomRow = reader.u16();
+            size_t count = reader.u8();
+            if (apply && bottomRow < mBoard.getHeight() && count <= bottomRow + 1)
+            {
+                mBoard.moveRowsDown(bottomRow, count);
+                if (!cleared)
+                {
+                    mLastClear = LineClear { mLastClear.clears + 1, 0, 0, 0 };
+                    cleared = true;
+                }
+                mLastClear.addRows(bottomRow, count);
+            }
+            break;
+        }
+
+        case STREAM_EVENT_SPAWN:
+            if (!readPiece(reader, apply))
+            {
+                return false;
+            }
+            break;
+
+        default:
+            return false;
+        }
+    }
+
+    if (apply)
+    {
+        mTick++;
+        mPlaying = (header & HEADER_GAME_OVER) == 0;
+    }
+    return true;
+}
+
+bool SpectatorStreamDecoder::isSynced() const
+{
+    return mSynced;
+}
+
+Grid& SpectatorStreamDecoder::getBoard()
+{
+    return mBoard;
+}
+
+Grid& SpectatorStreamDecoder::getPiece()
+{
+    return mPiece;
+}
+
+uint32_t SpectatorStreamDecoder::getTick() const
+{
+    return mTick;
+}
+
+uint32_t SpectatorStreamDecoder::getScore() const
+{
+    return mScore;
+}
+
+bool SpectatorStreamDecoder::isPlaying() const
+{
+    return mPlaying;
+}
+
+const LineClear& SpectatorStreamDecoder::getLastClear() const
+{
+    return mLastClear;
+}
@@ -1,15 +1,41 @@
 #include "tetris/Tetris.h"
 #include <iostream>
 
-TetrisGameEngine::TetrisGameEngine()
-    : BaseEngine(SCREEN_HEIGHT, SCREEN_WIDTH)
-    , mCurrentTetronimo { 0, 0, 0, 0 }
-    , mGameBoard { 0, 0, 0, 0 }
-    , mFactory { mTextures }
-    , mCollisionHandler { nullptr, nullptr, 0 }
+TetrisGameEngine::TetrisGameEngine(AutoShiftSettings autoShift,
+    BoardSize board,
+    const std::string& sharedStateName,
+    const std::string& eventLogPath)
+    : BaseEngine(static_cast<int>(board.rows) * BLOCK_SIZE + BOTTOM_BAR_HEIGHT, static_cast<int>(board.cols) * BLOCK_SIZE)
+    , mAutoShift { autoShift }
+    , mBoardSize { board }
+    , mSimulation {}
+    , mKeyboard {}
+    , mSimulationMutex {}
+    , mInputQueue {}
+    , mConsumedInputs {}
+    , mNextConsumedInput {}
+    , mHasNextConsumedInput { false }
+    , mRenderStates {}
+    , mFinalStatePublished { false }
+    , mPalette {}
+    , mRowFlashes {}
+    , mLastClears { 0 }
+    , mWhiteFlashTexture { nullptr }
+    , mBlackFlashTexture { nullptr }
+    , mParticles {}
+    , mLastDrops { 0 }
+    , mLastParticleTicks { 0 }
+    , mSharedStateName { sharedStateName }
+    , mSharedState {}
+    , mEventLogPath { eventLogPath }
+    , mEventLog {}
+    , mEventLogger {}
+    , mLastFrameUs { 0 }
     , mInfoBar {}
-    , mInfoText {} {
-    };
+    , mInfoBarText {}
+{
+    mSimulationTickMs = TICK_MS;
+}
 
 bool TetrisGameEngine::loadMedia()
 {
@@ -32,75 +58,239 @@ bool TetrisGameEngine::loadMedia()
 
 bool TetrisGameEngine::create()
 {
-    mGameBoard = Grid(0, 0, N_ROWS, N_COLS);
-    mGameBoard.updatePositions();
-    mCollisionHandler = CollisionHandler(
-        mTextures.at(BLOCK_TEXTURE_WHITE).get(),
-        mTextures.at(BLOCK_TEXTURE_BLACK).get(),
-        mElapsedTime);
-    mCurrentTetronimo = mFactory.getNextTetronimo();
+    mSimulation = std::make_unique<TetrisSimulation>(mTextures, TetronimoFactory::randomSeed(), mAutoShift, mBoardSize);
+    mPalette = TexturePalette(mTextures);
+    mWhiteFlashTexture = mTextures.at(BLOCK_TEXTURE_WHITE).get();
+    mBlackFlashTexture = mTextures.at(BLOCK_TEXTURE_BLACK).get();
+    mLastParticleTicks = getTicks();
+
+    // Publish the starting state so there is something to draw before the first tick
+    mRenderStates.getWriteBuffer() = mSimulation->snapshot();
+    mRenderStates.publish();
+    if (!mSharedStateName.empty() && mSharedState.open(mSharedStateName))
+    {
+        printf("Publishing the game state to shared memory %s\n", mSharedStateName.c_str());
+        mSharedState.publish(mSimulation->snapshot(), 0);
+    }
+    if (!mEventLogPath.empty())
+    {
+        mEventLog = std::make_unique<EventLog>();
+        if (mEventLog->open(mEventLogPath))
+        {
+            printf("Logging gameplay events to %s\n", mEventLogPath.c_str());
+            mEventLogger = std::make_unique<GameEventLogger>(*mEventLog, *mSimulation, mTextures);
+        }
+    }
     
-    // Initialize the information bar text(ure)
+    // Initialize the information bar text(ure). Reserve up front so changing the text never allocates
+    mInfoBarText.reserve(INFO_TEXT_SIZE);
+    mInputsOnScreen.reserve(INPUT_QUEUE_SIZE);
     mInfoBar = std::make_unique<Texture>(mRenderer.get(), mFont.get());
     updateInformationBar();
     
     return true;
 }
 
-void TetrisGameEngine::updateInformationBar()
+GameState TetrisGameEngine::snapshot()
 {
-    mInfoText.str("");
-    mInfoText << "  fps  " << mFps << "  |  score  " << mScore;
+    std::lock_guard<std::mutex> lock(mSimulationMutex);
+    return mSimulation->snapshot();
+}
+
+void TetrisGameEngine::restore(const GameState& state)
+{
+    std::lock_guard<std::mutex> lock(mSimulationMutex);
+    mSimulation->restore(state);
+    mFinalStatePublished = false;
+
+    // Draw it straight away rather than from the next tick, which is all
+    // a headless engine gets. The lock keeps simulate() from publishing too
+    mRenderStates.getWriteBuffer() = mSimulation->snapshot();
+    mRenderStates.publish();
+}
+
+bool TetrisGameEngine::updateInformationBar()
+{
+    // Format into frame scratch memory, the heap stays out of the frame loop
+    char* text = mFrameArena.allocateArray<char>(INFO_TEXT_SIZE);
+    int length = snprintf(text, INFO_TEXT_SIZE, "  fps  %d  |  score  %u", mFps, mScore);
+    if (mMeasureLatency && length > 0 && static_cast<size_t>(length) < INFO_TEXT_SIZE)
+    {
+        LatencyPercentiles latency = mLatency.getPercentiles();
+        snprintf(text + length, INFO_TEXT_SIZE - static_cast<size_t>(length), "  |  lag  %u/%u ms", latency.p50, latency.p99);
+    }
+
+    // Rasterizing text is not free, only do it when something changed
+    if (mInfoBarText == text)
+    {
+        return false;
+    }
+    mInfoBarText = text;
     if (!mInfoBar->loadFromRenderedText(
-            mInfoText.str().c_str(), TEXT_COLOUR, BACKGROUND_COLOUR))
+            mInfoBarText.c_str(), TEXT_COLOUR, BACKGROUND_COLOUR))
     {
         printf("Failed to load text texture\n");
     }
+    return true;
 }
 
 bool TetrisGameEngine::update()
 {
-    updateInformationBar();
-    
-    // Handle events on queue
+    // Pick up the newest state from the simulation thread
+    bool changed = false;
+    if (mRenderStates.update())
+    {
+        changed = true;
+        mScore = mRenderStates.getReadBuffer().score;
+        mPlaying = mRenderStates.getReadBuffer().playing;
+        if (mMeasureLatency)
+        {
+            collectInputsOnScreen(mRenderStates.getReadBuffer().tick);
+        }
+
+        // The simulation has already cleared the rows, flash where they were
+        const LineClear& clear = mRenderStates.getReadBuffer().lastClear;
+        if (clear.clears != mLastClears && clear.rows > 0)
+        {
+            mRowFlashes.start(RowFlash { clear, mRenderStates.getReadBuffer().board.cols, 0, getTicks() });
+            mParticles.lineCleared(clear, mRenderStates.getReadBuffer().board.cols, 0);
+        }
+        mLastClears = clear.clears;
+
+        const HardDrop& drop = mRenderStates.getReadBuffer().lastDrop;
+        if (drop.drops != mLastDrops && drop.cols > 0)
+        {
+            mParticles.hardDropped(drop, 0);
+        }
+        mLastDrops = drop.drops;
+    }
+
+    // A running effect needs a redraw every frame until it is over
+    Uint32 now = getTicks();
+    changed = changed || !mRowFlashes.empty() || !mParticles.empty();
+    mRowFlashes.advance(now);
+    mParticles.update(static_cast<float>(now - mLastParticleTicks) / 1000.0f);
+    mLastParticleTicks = now;
+    changed = updateInformationBar() || changed;
+
+    // Frame pacing goes in the event log next to the gameplay, so a stutter
+    // can be lined up with what the game was doing
+    if (mEventLogger != nullptr)
+    {
+        uint64_t nowUs = mEventLog->nowUs();
+        mEventLog->log(GAME_EVENT_MAIN, GAME_EVENT_FRAME, mRenderStates.getReadBuffer().tick,
+            static_cast<int32_t>(nowUs - mLastFrameUs), mFps);
+        mLastFrameUs = nowUs;
+    }
+
+    // Handle events on queue. SDL only lets the main thread pump events,
+    // so hand the key presses over to the simulation thread. Any event,
+    // e.g. the window being uncovered, is reason enough to redraw
     while (SDL_PollEvent(&mEvent) != 0)
     {
+        changed = true;
         // User requests quit
         if (mEvent.type == SDL_QUIT)
         {
             mQuit = true;
         }
+        handleCaptureKeys(mEvent);
+
+        // Every press and release is queued with its timestamp, so the
+        // simulation sees taps that start and end between two ticks
+        InputEvent input {};
+        if (mPlaying && KeyboardInput::toInputEvent(mEvent, input))
+        {
+            if (!mInputQueue.push(input))
+            {
+                printf("Input queue is full, dropping key event\n");
+            }
+        }
+    }
+    return changed;
+}
 
-        if (mPlaying)
+bool TetrisGameEngine::simulate()
+{
+    std::lock_guard<std::mutex> lock(mSimulationMutex);
+    InputEvent event;
+    while (mInputQueue.pop(event))
+    {
+        mKeyboard.handleEvent(event);
+        if (mMeasureLatency && !mConsumedInputs.push(ConsumedInput { event.timestamp, mSimulation->getTick() }))
         {
-            // Handle input for the block
-            mCurrentTetronimo.handleEvent(mEvent);
+            printf("Latency queue is full, dropping sample\n");
         }
     }
 
-    if (mPlaying)
+    uint64_t stepStart = mSharedState.isOpen() ? SharedStatePublisher::nowUs() : 0;
+    if (mSimulation->isPlaying())
+    {
+        mSimulation->step(mKeyboard.getInput());
+        mKeyboard.clearPressed();
+    }
+    else if (mFinalStatePublished)
+    {
+        // Game over and nothing left to show, keep the main thread idle
+        return true;
+    }
+    else
     {
-        // Handle movement and collisions
-        if (mCollisionHandler.handle(mCurrentTetronimo, mGameBoard, SDL_GetTicks()))
+        mFinalStatePublished = true;
+        if (mEventLogger != nullptr)
         {
-            mCurrentTetronimo = mFactory.getNextTetronimo();
-            mScore = mScore + 4;
-            updateInformationBar();
-        };
-        mPlaying = mCollisionHandler.keepPlaying();
+            mEventLogger->gameOver();
+        }
+    }
+
+    // Hand a copy of the new state to the renderer
+    GameState& state = mRenderStates.getWriteBuffer();
+    state = mSimulation->snapshot();
+    if (mSharedState.isOpen())
+    {
+        mSharedState.publish(state, static_cast<uint32_t>(SharedStatePublisher::nowUs() - stepStart));
     }
+    mRenderStates.publish();
     return true;
 }
 
+void TetrisGameEngine::collectInputsOnScreen(uint32_t tick)
+{
+    // Inputs arrive in tick order, so stop at the first one that is still ahead
+    // of the state being drawn and keep it for next frame
+    while (mHasNextConsumedInput || mConsumedInputs.pop(mNextConsumedInput))
+    {
+        mHasNextConsumedInput = true;
+        if (mNextConsumedInput.tick >= tick)
+        {
+            return;
+        }
+        mInputsOnScreen.push_back(mNextConsumedInput.timestamp);
+        mHasNextConsumedInput = false;
+    }
+}
+
+void TetrisGameEngine::fontReloaded()
+{
+    mInfoBar->setFont(mFont.get());
+}
+
 bool TetrisGameEngine::render()
 {
     // Draw the start line
     SDL_SetRenderDrawColor(mRenderer.get(), 0xC8, 0xC8, 0xC8, 0xFF);
     SDL_RenderDrawLine(mRenderer.get(), 0, START_LINE, mScreenWidth, START_LINE);
 
-    // Render game state objects
-    mGameBoard.render();
-    mCurrentTetronimo.render();
+    // Render the latest state published by the simulation thread
+    const GameState& state = mRenderStates.getReadBuffer();
+    mPalette.render(state.board);
+    mPalette.render(state.tetronimo);
+    mRowFlashes.forEach(
+        [this](const RowFlash& flash)
+        {
+            flash.render(mWhiteFlashTexture, mBlackFlashTexture);
+        });
+    mParticles.render(mRenderer.get());
     mInfoBar->render(0, mScreenHeight - BOTTOM_BAR_HEIGHT);
     return true;
 }
\ No newline at end of file
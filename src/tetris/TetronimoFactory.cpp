@@ -1,27 +1,58 @@
 #include "tetris/TetronimoFactory.h"
 
 TetronimoFactory::TetronimoFactory(std::unordered_map<std::string_view, std::unique_ptr<Texture>>& textures)
-    : mTextures { textures }
+    : TetronimoFactory(textures, randomSeed())
 {
-    setup();
 }
 
-void TetronimoFactory::setup()
+TetronimoFactory::TetronimoFactory(std::unordered_map<std::string_view, std::unique_ptr<Texture>>& textures, uint64_t seed, int startX)
+    : mState { seed }
+    , mTetronimoStartX { startX }
+    , mTextures { textures }
+{
+}
+
+uint64_t TetronimoFactory::randomSeed()
 {
-    // Seed the random number generator
     std::random_device rd;
-    mGen = std::mt19937(rd());
-    mDis = std::uniform_int_distribution<>(0, 6);
+    return (uint64_t { rd() } << 32) | rd();
+}
+
+uint64_t TetronimoFactory::getState()
+{
+    return mState;
+}
+
+void TetronimoFactory::setState(uint64_t state)
+{
+    mState = state;
+}
+
+int TetronimoFactory::nextRandom(int n)
+{
+    // SplitMix64 - tiny state, good enough distribution for picking pieces
+    mState += 0x9E3779B97F4A7C15ull;
+    uint64_t z = mState;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z = z ^ (z >> 31);
+    return static_cast<int>((z >> 32) % static_cast<uint64_t>(n));
 }
 
 Grid TetronimoFactory::getNextTetronimo()
 {
-    int randomNumber { mDis(mGen) };
     Grid grid { mTetronimoStartX, mTetronimoStartY, 0, 0 };
+    getNextTetronimo(grid);
+    return grid;
+}
+
+void TetronimoFactory::getNextTetronimo(Grid& grid)
+{
+    int randomNumber { nextRandom(7) };
     switch (randomNumber)
     {
     case 0:
-        grid = Grid { mTetronimoStartX, mTetronimoStartY, 3, 3 };
+        grid.reset(mTetronimoStartX, mTetronimoStartY, 3, 3);
         grid.createBlock(0, 0, mTextures.at(BLOCK_TEXTURE_RED).get());
         grid.createBlock(1, 0, mTextures.at(BLOCK_TEXTURE_RED).get());
         grid.createBlock(1, 1, mTextures.at(BLOCK_TEXTURE_RED).get());
@@ -29,7 +60,7 @@ Grid TetronimoFactory::getNextTetronimo()
         break;
 
     case 1:
-        grid = Grid { mTetronimoStartX, mTetronimoStartY, 4, 4 };
+        grid.reset(mTetronimoStartX, mTetronimoStartY, 4, 4);
         grid.createBlock(1, 0, mTextures.at(BLOCK_TEXTURE_BLUE).get());
         grid.createBlock(1, 1, mTextures.at(BLOCK_TEXTURE_BLUE).get());
         grid.createBlock(1, 2, mTextures.at(BLOCK_TEXTURE_BLUE).get());
@@ -37,7 +68,7 @@ Grid TetronimoFactory::getNextTetronimo()
         break;
 
     case 2:
-        grid = Grid { mTetronimoStartX, mTetronimoStartY, 2, 2 };
+        grid.reset(mTetronimoStartX, mTetronimoStartY, 2, 2);
         grid.createBlock(0, 0, mTextures.at(BLOCK_TEXTURE_YELLOW).get());
         grid.createBlock(1, 0, mTextures.at(BLOCK_TEXTURE_YELLOW).get());
         grid.createBlock(0, 1, mTextures.at(BLOCK_TEXTURE_YELLOW).get());
@@ -45,7 +76,7 @@ Grid TetronimoFactory::getNextTetronimo()
         break;
 
     case 3:
-        grid = Grid { mTetronimoStartX, mTetronimoStartY, 3, 3 };
+        grid.reset(mTetronimoStartX, mTetronimoStartY, 3, 3);
         grid.createBlock(1, 0, mTextures.at(BLOCK_TEXTURE_GREEN).get());
         grid.createBlock(2, 0, mTextures.at(BLOCK_TEXTURE_GREEN).get());
         grid.createBlock(0, 1, mTextures.at(BLOCK_TEXTURE_GREEN).get());
@@ -53,7 +84,7 @@ Grid TetronimoFactory::getNextTetronimo()
         break;
 
     case 4:
-        grid = Grid { mTetronimoStartX, mTetronimoStartY, 3, 3 };
+        grid.reset(mTetronimoStartX, mTetronimoStartY, 3, 3);
         grid.createBlock(1, 0, mTextures.at(BLOCK_TEXTURE_PURPLE).get());
         grid.createBlock(0, 1, mTextures.at(BLOCK_TEXTURE_PURPLE).get());
         grid.createBlock(1, 1, mTextures.at(BLOCK_TEXTURE_PURPLE).get());
@@ -61,7 +92,7 @@ Grid TetronimoFactory::getNextTetronimo()
         break;
 
     case 5:
-        grid = Grid { mTetronimoStartX, mTetronimoStartY, 3, 3 };
+        grid.reset(mTetronimoStartX, mTetronimoStartY, 3, 3);
         grid.createBlock(2, 0, mTextures.at(BLOCK_TEXTURE_ORANGE).get());
         grid.createBlock(0, 1, mTextures.at(BLOCK_TEXTURE_ORANGE).get());
         grid.createBlock(1, 1, mTextures.at(BLOCK_TEXTURE_ORANGE).get());
@@ -69,7 +100,7 @@ Grid TetronimoFactory::getNextTetronimo()
         break;
 
     case 6:
-        grid = Grid { mTetronimoStartX, mTetronimoStartY, 3, 3 };
+        grid.reset(mTetronimoStartX, mTetronimoStartY, 3, 3);
         grid.createBlock(0, 0, mTextures.at(BLOCK_TEXTURE_NAVY).get());
         grid.createBlock(0, 1, mTextures.at(BLOCK_TEXTURE_NAVY).get());
         grid.createBlock(1, 1, mTextures.at(BLOCK_TEXTURE_NAVY).get());
@@ -77,9 +108,7 @@ Grid TetronimoFactory::getNextTetronimo()
         break;
 
     default:
-        Grid grid {mTetronimoStartX, mTetronimoStartY, 0, 0}; // Default initialization
+        grid.reset(mTetronimoStartX, mTetronimoStartY, 0, 0);
         break;
     }
-
-    return grid;
 }
\ No newline at end of file
@@ -0,0 +1,51 @@
+#include "tetris/TexturePalette.h"
+
+std::unordered_map<std::string_view, std::unique_ptr<Texture>> makeHeadlessTextures()
+{
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>> textures;
+    for (auto name : PALETTE_TEXTURES)
+    {
+        textures[name] = std::make_unique<Texture>();
+    }
+    return textures;
+}
+
+TexturePalette::TexturePalette()
+    : mTextures {}
+{
+}
+
+TexturePalette::TexturePalette(std::unordered_map<std::string_view, std::unique_ptr<Texture>>& textures)
+    : mTextures {}
+{
+    for (size_t index = 0; index < PALETTE_TEXTURES.size(); ++index)
+    {
+        auto it = textures.find(PALETTE_TEXTURES[index]);
+        if (it != textures.end())
+        {
+            mTextures[index + 1] = it->second.get();
+        }
+    }
+}
+
+uint8_t TexturePalette::indexOf(Texture* texture) const
+{
+    if (texture == nullptr)
+    {
+        return 0;
+    }
+    for (size_t index = 1; index < mTextures.size(); ++index)
+    {
+        if (mTextures[index] == texture)
+        {
+            return static_cast<uint8_t>(index);
+        }
+    }
+    printf("Texture is missing from the palette!\n");
+    return 0;
+}
+
+Texture* TexturePalette::at(uint8_t index) const
+{
+    return (index < mTextures.size()) ? mTextures[index] : nullptr;
+}
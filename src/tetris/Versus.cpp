@@ -0,0 +1,180 @@
+#include "tetris/Versus.h"
+
+VersusGameEngine::VersusGameEngine(const VersusConfig& config)
+    : BaseEngine(SCREEN_HEIGHT, 2 * SCREEN_WIDTH + VERSUS_GAP)
+    , mConfig { config }
+    , mSocket {}
+    , mSession {}
+    , mKeyboard {}
+    , mPendingInputs {}
+    , mNextTickTime { 0 }
+    , mRowFlashes {}
+    , mLastClears {}
+    , mInfoBar {}
+    , mInfoBarText {}
+{
+}
+
+bool VersusGameEngine::loadMedia()
+{
+    bool success = true;
+    mTextures.clear();
+    for (auto textureName : PALETTE_TEXTURES)
+    {
+        success = success && loadTexture(textureName);
+    }
+    return success;
+}
+
+bool VersusGameEngine::create()
+{
+    printf("Player %zu listening on %u, peer %s:%u\n",
+        mConfig.localPlayer, mConfig.localPort, mConfig.remoteAddress.c_str(), mConfig.remotePort);
+    if (!mSocket.open(mConfig.localPort) || !mSocket.setPeer(mConfig.remoteAddress, mConfig.remotePort))
+    {
+        mQuit = true;
+        return false;
+    }
+    mSocket.setImpairment(mConfig.latencyMs, mConfig.jitterMs, mConfig.lossRate);
+
+    // Both peers must use the same seed so they deal the same pieces
+    mSession = std::make_unique<RollbackSession>(mTextures, mConfig.seed, mConfig.localPlayer, mSocket);
+    mNextTickTime = SDL_GetTicks();
+
+    // The rollback session runs on this thread, and the socket still
+    // allocates when it queues delayed packets
+    mCheckFrameAllocations = false;
+
+    mInfoBar = std::make_unique<Texture>(mRenderer.get(), mFont.get());
+    mInfoBarText.reserve(INFO_TEXT_SIZE);
+    updateInformationBar();
+    return true;
+}
+
+void VersusGameEngine::updateInformationBar()
+{
+    RollbackStats stats = mSession->getStats();
+    char* text = mFrameArena.allocateArray<char>(INFO_TEXT_SIZE);
+    int length = snprintf(text, INFO_TEXT_SIZE, "  fps  %d  |  you  %u  |  them  %u  |  rollbacks  %u  max  %u",
+        mFps,
+        mSession->getSimulation(mConfig.localPlayer).getScore(),
+        mSession->getSimulation(1 - mConfig.localPlayer).getScore(),
+        stats.rollbacks,
+        stats.maxResimulatedTicks);
+    if (mMeasureLatency && length > 0 && static_cast<size_t>(length) < INFO_TEXT_SIZE)
+    {
+        LatencyPercentiles latency = mLatency.getPercentiles();
+        snprintf(text + length, INFO_TEXT_SIZE - static_cast<size_t>(length), "  |  lag  %u/%u ms", latency.p50, latency.p99);
+    }
+
+    // Rasterizing text is not free, only do it when something changed
+    if (mInfoBarText == text)
+    {
+        return;
+    }
+    mInfoBarText = text;
+    if (!mInfoBar->loadFromRenderedText(
+            mInfoBarText.c_str(), TEXT_COLOUR, BACKGROUND_COLOUR))
+    {
+        printf("Failed to load text texture\n");
+    }
+}
+
+bool VersusGameEngine::update()
+{
+    // Handle events on queue
+    while (SDL_PollEvent(&mEvent) != 0)
+    {
+        // User requests quit
+        if (mEvent.type == SDL_QUIT)
+        {
+            mQuit = true;
+        }
+        handleCaptureKeys(mEvent);
+        InputEvent input {};
+        if (KeyboardInput::toInputEvent(mEvent, input))
+        {
+            mKeyboard.handleEvent(input);
+            if (mMeasureLatency)
+            {
+                mPendingInputs.push_back(input.timestamp);
+            }
+        }
+    }
+
+    // Run as many fixed ticks as real time calls for. If the session stalls
+    // waiting on the peer, just service the network and try again next frame
+    Uint32 now = SDL_GetTicks();
+    bool ticked = false;
+    while (now >= mNextTickTime)
+    {
+        if (!mSession->advance(mKeyboard.getInput()))
+        {
+            mNextTickTime = now;
+            break;
+        }
+        mKeyboard.clearPressed();
+        mInputsOnScreen.insert(mInputsOnScreen.end(), mPendingInputs.begin(), mPendingInputs.end());
+        mPendingInputs.clear();
+        mNextTickTime += TICK_MS;
+        ticked = true;
+    }
+    if (!ticked)
+    {
+        mSession->poll();
+    }
+
+    // A rollback can take a clear back or redo it, a flash is only pixels
+    for (size_t player = 0; player < 2; ++player)
+    {
+        const LineClear& clear = mSession->getSimulation(player).getLastClear();
+        if (clear.clears != mLastClears[player] && clear.rows > 0)
+        {
+            int offsetX = (player == mConfig.localPlayer) ? 0 : SCREEN_WIDTH + VERSUS_GAP;
+            mRowFlashes.start(RowFlash { clear, N_COLS, offsetX, now });
+        }
+        mLastClears[player] = clear.clears;
+    }
+    mRowFlashes.advance(now);
+
+    updateInformationBar();
+    return true;
+}
+
+void VersusGameEngine::fontReloaded()
+{
+    mInfoBar->setFont(mFont.get());
+}
+
+bool VersusGameEngine::render()
+{
+    SDL_SetRenderDrawColor(mRenderer.get(), 0xC8, 0xC8, 0xC8, 0xFF);
+    for (size_t player = 0; player < 2; ++player)
+    {
+        // Local player always on the left
+        int offsetX = (player == mConfig.localPlayer) ? 0 : SCREEN_WIDTH + VERSUS_GAP;
+        TetrisSimulation& simulation = mSession->getSimulation(player);
+        SDL_RenderDrawLine(mRenderer.get(), offsetX, START_LINE, offsetX + SCREEN_WIDTH, START_LINE);
+        simulation.getGameBoard().render(offsetX);
+        simulation.getCurrentTetronimo().render(offsetX);
+    }
+    Texture* whiteFlashTexture = mTextures.at(BLOCK_TEXTURE_WHITE).get();
+    Texture* blackFlashTexture = mTextures.at(BLOCK_TEXTURE_BLACK).get();
+    mRowFlashes.forEach(
+        [whiteFlashTexture, blackFlashTexture](const RowFlash& flash)
+        {
+            flash.render(whiteFlashTexture, blackFlashTexture);
+        });
+
+    // Divider between the boards
+    SDL_Rect divider { SCREEN_WIDTH, 0, VERSUS_GAP, mScreenHeight - BOTTOM_BAR_HEIGHT };
+    SDL_SetRenderDrawColor(mRenderer.get(),
+        BACKGROUND_COLOUR.r,
+        BACKGROUND_COLOUR.g,
+        BACKGROUND_COLOUR.b,
+        BACKGROUND_COLOUR.a);
+    SDL_RenderFillRect(mRenderer.get(), &divider);
+
+    mInfoBar->render(0, mScreenHeight - BOTTOM_BAR_HEIGHT);
+    return true;
+}
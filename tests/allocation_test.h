@@ -0,0 +1,57 @@
+#ifndef ALLOCATION_TEST_H
+#define ALLOCATION_TEST_H
+
+#include "engine/AllocationCounter.h"
+#include <gtest/gtest.h>
+
+// Counts the heap allocations the current thread makes while it is alive.
+// The tests link src/engine/AllocationCounter.cpp, which replaces the
+// global operator new and delete to keep the counts
+class AllocationScope
+{
+public:
+    AllocationScope()
+        : mStart { AllocationCounter::thisThread() }
+    {
+    }
+
+    uint64_t allocations() const
+    {
+        return AllocationCounter::thisThread().allocations - mStart.allocations;
+    }
+
+    uint64_t bytes() const
+    {
+        return AllocationCounter::thisThread().bytes - mStart.bytes;
+    }
+
+private:
+    AllocationCounts mStart;
+};
+
+// Base fixture for tests that check a code path stays off the heap
+class AllocationTest : public ::testing::Test
+{
+protected:
+    // Allocations made by running func once
+    template <typename Func>
+    static uint64_t countAllocations(Func&& func)
+    {
+        AllocationScope scope;
+        func();
+        return scope.allocations();
+    }
+};
+
+#define EXPECT_NO_ALLOCATIONS(statement)                                   \
+    do                                                                     \
+    {                                                                      \
+        AllocationScope allocationScope;                                   \
+        statement;                                                         \
+        uint64_t allocationCount = allocationScope.allocations();          \
+        uint64_t allocationBytes = allocationScope.bytes();                \
+        EXPECT_EQ(allocationCount, 0u) << #statement << " allocated "      \
+                                       << allocationBytes << " bytes";     \
+    } while (0)
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef TEMP_PATH_H
+#define TEMP_PATH_H
+
+#include <gtest/gtest.h>
+#include <string>
+
+// A path in the gtest temporary directory that belongs to the running
+// test. ctest runs every test in its own process, in parallel with -j,
+// so tests that shared a fixed name would race on the file
+inline std::string tempPath(const std::string& name)
+{
+    const ::testing::TestInfo* test = ::testing::UnitTest::GetInstance()->current_test_info();
+    return ::testing::TempDir() + test->test_suite_name() + "_" + test->name() + "_" + name;
+}
+
+#endif
@@ -0,0 +1,108 @@
+#include "allocation_test.h"
+#include "tetris/CollisionHandler.h"
+#include "tetris/Input.h"
+#include "tetris/Simulation.h"
+#include "tetris/TetronimoFactory.h"
+#include "engine/Texture.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class AllocationsTest : public AllocationTest
+{
+protected:
+    void SetUp() override
+    {
+        textures = makeHeadlessTextures();
+    }
+
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>> textures;
+};
+
+TEST_F(AllocationsTest, ScopeSeesAllocations)
+{
+    uint64_t allocations = countAllocations([]()
+        {
+            std::vector<int> values(100);
+            values[0] = 1;
+        });
+    EXPECT_EQ(allocations, 1u);
+}
+
+TEST_F(AllocationsTest, GridMove)
+{
+    Grid tetronimo { 120, 0, 4, 4 };
+    tetronimo.createBlock(1, 0, textures.at(BLOCK_TEXTURE_BLUE).get());
+    tetronimo.setVelX(BLOCK_SIZE);
+
+    EXPECT_NO_ALLOCATIONS(tetronimo.move(1, 1));
+}
+
+TEST_F(AllocationsTest, GridRotate)
+{
+    Grid tetronimo { 120, 0, 3, 3 };
+    tetronimo.createBlock(1, 0, textures.at(BLOCK_TEXTURE_PURPLE).get());
+    tetronimo.createBlock(0, 1, textures.at(BLOCK_TEXTURE_PURPLE).get());
+
+    EXPECT_NO_ALLOCATIONS(tetronimo.rotateClockwise());
+    EXPECT_NO_ALLOCATIONS(tetronimo.rotateAntiClockwise());
+}
+
+TEST_F(AllocationsTest, CollisionHandlerHandle)
+{
+    Texture* block = textures.at(BLOCK_TEXTURE_RED).get();
+    CollisionHandler handler {};
+    Grid gameBoard { 0, 0, N_ROWS, N_COLS };
+    gameBoard.updatePositions();
+
+    // Nearly full bottom row, so the drop below freezes the piece and completes it
+    for (int xIndex = 1; xIndex < N_COLS; ++xIndex)
+    {
+        gameBoard.createBlock(xIndex, N_ROWS - 2, block);
+    }
+    Grid tetronimo { 0, 0, 1, 1 };
+    auto spawn = [&tetronimo, block]()
+    {
+        tetronimo.reset(0, START_LINE, 1, 1);
+        tetronimo.createBlock(0, 0, block);
+        tetronimo.setVelY(BLOCK_SIZE);
+    };
+    spawn();
+
+    // Falls, freezes, completes the row and clears it
+    EXPECT_NO_ALLOCATIONS(
+        for (uint32_t tick = 1; tick < 100; ++tick)
+        {
+            if (handler.handle(tetronimo, gameBoard))
+            {
+                spawn();
+            }
+        });
+}
+
+TEST_F(AllocationsTest, PieceSpawning)
+{
+    TetronimoFactory factory { textures, 7 };
+    Grid tetronimo { 0, 0, MAX_TETRONIMO_SIZE, MAX_TETRONIMO_SIZE };
+
+    EXPECT_NO_ALLOCATIONS(
+        for (int piece = 0; piece < 100; ++piece)
+        {
+            factory.getNextTetronimo(tetronimo);
+        });
+}
+
+TEST_F(AllocationsTest, SimulationStepsAndRollback)
+{
+    TetrisSimulation simulation { textures, 3 };
+    GameState state = simulation.snapshot();
+
+    // A full game: moves, rotations, spawns, frozen pieces and game over
+    EXPECT_NO_ALLOCATIONS(
+        for (uint32_t tick = 0; tick < 5000 && simulation.isPlaying(); ++tick)
+        {
+            simulation.step((tick % 7 == 0) ? INPUT_ROTATE : ((tick / 30) % 2 == 0) ? INPUT_LEFT : INPUT_RIGHT);
+        });
+    EXPECT_NO_ALLOCATIONS(state = simulation.snapshot());
+    EXPECT_NO_ALLOCATIONS(simulation.restore(state));
+}
@@ -0,0 +1,74 @@
+#include "tetris/RowFlash.h"
+#include "engine/AnimationScheduler.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+// Finishes after a set number of advances
+struct Countdown
+{
+    int remaining { 0 };
+
+    bool advance(Uint32)
+    {
+        return --remaining > 0;
+    }
+};
+}
+
+TEST(AnimationSchedulerTest, DropsEffectsAsTheyFinish)
+{
+    AnimationScheduler<Countdown, 4> scheduler;
+    EXPECT_TRUE(scheduler.empty());
+    EXPECT_TRUE(scheduler.start(Countdown { 1 }));
+    EXPECT_TRUE(scheduler.start(Countdown { 3 }));
+    EXPECT_TRUE(scheduler.start(Countdown { 2 }));
+    EXPECT_EQ(scheduler.size(), 3u);
+
+    scheduler.advance(0);
+    EXPECT_EQ(scheduler.size(), 2u);
+    scheduler.advance(0);
+    EXPECT_EQ(scheduler.size(), 1u);
+    int left = 0;
+    scheduler.forEach(
+        [&left](const Countdown& countdown)
+        {
+            left = countdown.remaining;
+        });
+    EXPECT_EQ(left, 1);
+    scheduler.advance(0);
+    EXPECT_TRUE(scheduler.empty());
+}
+
+TEST(AnimationSchedulerTest, SkipsEffectsWhenFull)
+{
+    AnimationScheduler<Countdown, 2> scheduler;
+    EXPECT_TRUE(scheduler.start(Countdown { 5 }));
+    EXPECT_TRUE(scheduler.start(Countdown { 5 }));
+    EXPECT_FALSE(scheduler.start(Countdown { 5 }));
+    EXPECT_EQ(scheduler.size(), 2u);
+    scheduler.clear();
+    EXPECT_TRUE(scheduler.empty());
+}
+
+TEST(AnimationSchedulerTest, RowFlashLastsItsFlashes)
+{
+    RowFlashes flashes;
+    ASSERT_TRUE(flashes.start(RowFlash { LineClear { 1, N_ROWS - 1, 2, 0b11 }, N_COLS, 0, 1000 }));
+
+    Uint32 end = 1000 + N_ROW_FLASHES * COMPLETED_ROW_FLASH_INTERVAL_MS;
+    for (Uint32 now = 1000; now < end; now += TICK_MS)
+    {
+        flashes.advance(now);
+        ASSERT_FALSE(flashes.empty()) << "ended early at " << now;
+    }
+    flashes.advance(end);
+    EXPECT_TRUE(flashes.empty());
+}
+
+TEST(AnimationSchedulerTest, RowFlashCatchesUpAfterALongFrame)
+{
+    RowFlash flash { LineClear { 1, N_ROWS - 1, 1, 0b1 }, N_COLS, 0, 0 };
+    EXPECT_TRUE(flash.advance(COMPLETED_ROW_FLASH_INTERVAL_MS));
+    EXPECT_FALSE(flash.advance(10000));
+}
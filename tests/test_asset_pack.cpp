@@ -0,0 +1,49 @@
+#include "engine/AssetPack.h"
+#include "engine/Texture.h"
+#include "tetris/Constants.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+TEST(AssetPackTest, EmbeddedBytesMatchTheFiles)
+{
+    for (auto name : { BLOCK_TEXTURE_RED, BLOCK_TEXTURE_WHITE, BLOCK_TEXTURE_YELLOW })
+    {
+        const void* data { nullptr };
+        size_t size { 0 };
+        ASSERT_TRUE(AssetPack::find(name, data, size));
+
+        std::ifstream file(std::string(ASSETS_DIR) + "/" + std::string(name), std::ios::binary);
+        std::vector<char> expected { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        ASSERT_EQ(size, expected.size());
+        EXPECT_EQ(std::memcmp(data, expected.data(), size), 0);
+    }
+}
+
+TEST(AssetPackTest, FontIsEmbedded)
+{
+    const void* data { nullptr };
+    size_t size { 0 };
+    EXPECT_TRUE(AssetPack::find("Arial.ttf", data, size));
+    EXPECT_GT(size, 0u);
+}
+
+TEST(AssetPackTest, UnknownNameIsNotFound)
+{
+    const void* data { nullptr };
+    size_t size { 0 };
+    EXPECT_FALSE(AssetPack::find("missing.bmp", data, size));
+    EXPECT_EQ(data, nullptr);
+}
+
+TEST(AssetPackTest, TextureLoadsFromMemory)
+{
+    const void* data { nullptr };
+    size_t size { 0 };
+    ASSERT_TRUE(AssetPack::find(BLOCK_TEXTURE_BLUE, data, size));
+
+    Texture texture {};
+    EXPECT_TRUE(texture.loadFromMemory(data, size, std::string(BLOCK_TEXTURE_BLUE)));
+}
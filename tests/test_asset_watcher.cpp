@@ -0,0 +1,71 @@
+#include "engine/AssetWatcher.h"
+#include "temp_path.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+
+#ifdef __linux__
+#include <sys/stat.h>
+#include <unistd.h>
+
+class AssetWatcherTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        directory = tempPath("asset_watcher");
+        mkdir(directory.c_str(), 0755);
+        ASSERT_TRUE(watcher.open(directory));
+    }
+
+    void TearDown() override
+    {
+        watcher.close();
+        std::remove((directory + "/red.bmp").c_str());
+        std::remove((directory + "/red.tmp").c_str());
+        rmdir(directory.c_str());
+    }
+
+    void writeFile(const std::string& name)
+    {
+        FILE* file = fopen((directory + "/" + name).c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        fputs("pixels", file);
+        fclose(file);
+    }
+
+    std::string directory;
+    AssetWatcher watcher;
+};
+
+TEST_F(AssetWatcherTest, NothingChanged)
+{
+    std::vector<std::string> changed;
+    watcher.poll(changed);
+    EXPECT_TRUE(changed.empty());
+}
+
+TEST_F(AssetWatcherTest, ReportsWrittenFile)
+{
+    writeFile("red.bmp");
+
+    std::vector<std::string> changed;
+    watcher.poll(changed);
+    EXPECT_EQ(changed, std::vector<std::string> { "red.bmp" });
+
+    // Only reported once
+    changed.clear();
+    watcher.poll(changed);
+    EXPECT_TRUE(changed.empty());
+}
+
+TEST_F(AssetWatcherTest, ReportsFileRenamedIntoPlace)
+{
+    writeFile("red.tmp");
+    std::rename((directory + "/red.tmp").c_str(), (directory + "/red.bmp").c_str());
+
+    std::vector<std::string> changed;
+    watcher.poll(changed);
+    EXPECT_NE(std::find(changed.begin(), changed.end(), "red.bmp"), changed.end());
+}
+#endif
@@ -0,0 +1,58 @@
+#include "tetris/Bot.h"
+#include "engine/Texture.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <unordered_map>
+
+class BotTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        textures = makeHeadlessTextures();
+    }
+
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>> textures;
+};
+
+TEST_F(BotTest, PlaysDeterministically)
+{
+    TetrisSimulation first(textures, 9);
+    TetrisSimulation second(textures, 9);
+    Bot firstBot { 5 };
+    Bot secondBot { 5 };
+    for (int tick = 0; tick < 3000; ++tick)
+    {
+        first.step(firstBot.nextInput(first));
+        second.step(secondBot.nextInput(second));
+    }
+    GameState a = first.snapshot();
+    GameState b = second.snapshot();
+    EXPECT_EQ(std::memcmp(&a, &b, sizeof(GameState)), 0);
+}
+
+TEST_F(BotTest, SpreadsPiecesAcrossTheBoard)
+{
+    TetrisSimulation simulation(textures, 3);
+    Bot bot { 3 };
+    std::set<int> landingColumns;
+    int lastPosY = 0;
+    int lastPosX = 0;
+    for (int tick = 0; tick < 20000 && simulation.isPlaying(); ++tick)
+    {
+        Grid& piece = simulation.getCurrentTetronimo();
+        if (piece.getPosY() < lastPosY)
+        {
+            landingColumns.insert(lastPosX / BLOCK_SIZE);
+        }
+        lastPosY = piece.getPosY();
+        lastPosX = piece.getPosX();
+        simulation.step(bot.nextInput(simulation));
+    }
+
+    // Pieces went to several places, not just straight down the middle
+    EXPECT_GE(landingColumns.size(), 4u);
+    EXPECT_GT(simulation.getScore(), 0u);
+}
@@ -1,5 +1,6 @@
 #include "tetris/CollisionHandler.h"
 #include "engine/Texture.h"
+#include "tetris/Input.h"
 #include <gtest/gtest.h>
 #include <memory>
 
@@ -8,12 +9,9 @@ class CollisionHandlerTest : public ::testing::Test
 protected:
     void SetUp() override
     {
-        whiteTexture = std::make_unique<Texture>();
-        blackTexture = std::make_unique<Texture>();
         blockTexture = std::make_unique<Texture>();
         
-        currentTime = 0;
-        handler = std::make_unique<CollisionHandler>(whiteTexture.get(), blackTexture.get(), currentTime);
+        handler = std::make_unique<CollisionHandler>();
         
         // Create empty game board
         gameBoard = std::make_unique<Grid>(0, 0, N_ROWS, N_COLS);
@@ -26,13 +24,10 @@ protected:
         tetromino->createBlock(1, 1, blockTexture.get());
     }
     
-    std::unique_ptr<Texture> whiteTexture;
-    std::unique_ptr<Texture> blackTexture;
     std::unique_ptr<Texture> blockTexture;
     std::unique_ptr<CollisionHandler> handler;
     std::unique_ptr<Grid> gameBoard;
     std::unique_ptr<Grid> tetromino;
-    uint32_t currentTime;
 };
 
 TEST_F(CollisionHandlerTest, InitialState)
@@ -43,7 +38,7 @@ TEST_F(CollisionHandlerTest, InitialState)
 TEST_F(CollisionHandlerTest, NoCollisionReturnsFalse)
 {
     // Tetromino in open space should not trigger new tetromino
-    bool needNewTetromino = handler->handle(*tetromino, *gameBoard, currentTime);
+    bool needNewTetromino = handler->handle(*tetromino, *gameBoard);
     EXPECT_FALSE(needNewTetromino);
     EXPECT_TRUE(handler->keepPlaying());
 }
@@ -52,7 +47,7 @@ TEST_F(CollisionHandlerTest, TetrominoMovesDown)
 {
     int startY = tetromino->getPosY();
     
-    handler->handle(*tetromino, *gameBoard, currentTime);
+    handler->handle(*tetromino, *gameBoard);
     
     // Tetromino should have moved down
     EXPECT_GT(tetromino->getPosY(), startY);
@@ -67,7 +62,7 @@ TEST_F(CollisionHandlerTest, CollisionAtBottom)
     tetromino->createBlock(0, 1, blockTexture.get());
     tetromino->createBlock(1, 1, blockTexture.get());
     
-    bool needNewTetromino = handler->handle(*tetromino, *gameBoard, currentTime);
+    bool needNewTetromino = handler->handle(*tetromino, *gameBoard);
     
     // Should detect collision and request new tetromino
     EXPECT_TRUE(needNewTetromino);
@@ -78,11 +73,8 @@ TEST_F(CollisionHandlerTest, HorizontalMovement)
     // Set horizontal velocity
     tetromino->setVelX(BLOCK_SIZE);
     
-    // Wait enough time for input to be processed
-    currentTime = INPUT_INTERVAL_MS + 1;
-    
     int startX = tetromino->getPosX();
-    handler->handle(*tetromino, *gameBoard, currentTime);
+    handler->handle(*tetromino, *gameBoard);
     
     // Should have moved right
     EXPECT_GT(tetromino->getPosX(), startX);
@@ -98,9 +90,7 @@ TEST_F(CollisionHandlerTest, WallCollisionLeft)
     tetromino->createBlock(1, 1, blockTexture.get());
     tetromino->setVelX(-BLOCK_SIZE);
     
-    currentTime = INPUT_INTERVAL_MS + 1;
-    
-    handler->handle(*tetromino, *gameBoard, currentTime);
+    handler->handle(*tetromino, *gameBoard);
     
     // Should not move past left wall
     EXPECT_EQ(tetromino->getPosX(), 0);
@@ -117,9 +107,7 @@ TEST_F(CollisionHandlerTest, WallCollisionRight)
     tetromino->createBlock(1, 1, blockTexture.get());
     tetromino->setVelX(BLOCK_SIZE);
     
-    currentTime = INPUT_INTERVAL_MS + 1;
-    
-    handler->handle(*tetromino, *gameBoard, currentTime);
+    handler->handle(*tetromino, *gameBoard);
     
     // Should not move past right wall
     EXPECT_EQ(tetromino->getPosX(), rightEdge);
@@ -134,7 +122,7 @@ TEST_F(CollisionHandlerTest, GameOverWhenBlocksReachTop)
     tetromino = std::make_unique<Grid>(5 * BLOCK_SIZE, 0, 1, 1);
     tetromino->createBlock(0, 0, blockTexture.get());
     
-    handler->handle(*tetromino, *gameBoard, currentTime);
+    handler->handle(*tetromino, *gameBoard);
     
     // Game should end
     EXPECT_FALSE(handler->keepPlaying());
@@ -153,7 +141,7 @@ TEST_F(CollisionHandlerTest, CollisionWithExistingBlocks)
     tetromino->createBlock(0, 1, blockTexture.get());
     tetromino->createBlock(1, 1, blockTexture.get());
     
-    bool needNewTetromino = handler->handle(*tetromino, *gameBoard, currentTime);
+    bool needNewTetromino = handler->handle(*tetromino, *gameBoard);
     
     // Should eventually collide and freeze
     EXPECT_TRUE(needNewTetromino);
@@ -161,4 +149,138 @@ TEST_F(CollisionHandlerTest, CollisionWithExistingBlocks)
     // Check that blocks were added to game board
     EXPECT_TRUE(gameBoard->getBlock(4, 8).exists());
     EXPECT_TRUE(gameBoard->getBlock(5, 8).exists());
-}
\ No newline at end of file
+}
+
+TEST_F(CollisionHandlerTest, WallCollisionRightOnWideBoard)
+{
+    gameBoard = std::make_unique<Grid>(0, 0, N_ROWS, MAX_BOARD_COLS);
+    int rightEdge = static_cast<int>(MAX_BOARD_COLS - 2) * BLOCK_SIZE;
+    tetromino = std::make_unique<Grid>(rightEdge - BLOCK_SIZE, 100, 2, 2);
+    tetromino->createBlock(0, 0, blockTexture.get());
+    tetromino->createBlock(1, 0, blockTexture.get());
+    tetromino->createBlock(0, 1, blockTexture.get());
+    tetromino->createBlock(1, 1, blockTexture.get());
+    tetromino->setVelX(BLOCK_SIZE);
+
+    // One step reaches the last column, the next is blocked by the wall
+    handler->handle(*tetromino, *gameBoard);
+    EXPECT_EQ(tetromino->getPosX(), rightEdge);
+    handler->handle(*tetromino, *gameBoard);
+    EXPECT_EQ(tetromino->getPosX(), rightEdge);
+}
+
+TEST_F(CollisionHandlerTest, CollisionAtBottomOfTallBoard)
+{
+    constexpr size_t rows = 2000;
+    gameBoard = std::make_unique<Grid>(0, 0, rows, N_COLS);
+    tetromino = std::make_unique<Grid>(160, (N_ROWS - 2) * BLOCK_SIZE - 1, 2, 2);
+    tetromino->createBlock(0, 0, blockTexture.get());
+    tetromino->createBlock(1, 0, blockTexture.get());
+
+    // The bottom of the default board is open space here
+    EXPECT_FALSE(handler->handle(*tetromino, *gameBoard));
+
+    tetromino = std::make_unique<Grid>(160, (static_cast<int>(rows) - 1) * BLOCK_SIZE - 1, 2, 2);
+    tetromino->createBlock(0, 0, blockTexture.get());
+    tetromino->createBlock(1, 0, blockTexture.get());
+    EXPECT_TRUE(handler->handle(*tetromino, *gameBoard));
+    EXPECT_TRUE(gameBoard->getBlock(4, rows - 1).exists());
+}
+
+TEST_F(CollisionHandlerTest, CompletedRowsClearStraightAway)
+{
+    // Everything but the two columns the square lands in
+    for (int col = 0; col < N_COLS; ++col)
+    {
+        if (col != 4 && col != 5)
+        {
+            gameBoard->createBlock(col, N_ROWS - 1, blockTexture.get());
+            gameBoard->createBlock(col, N_ROWS - 2, blockTexture.get());
+        }
+    }
+    gameBoard->createBlock(0, N_ROWS - 3, blockTexture.get());
+    tetromino = std::make_unique<Grid>(4 * BLOCK_SIZE, (N_ROWS - 2) * BLOCK_SIZE - 1, 2, 2);
+    tetromino->createBlock(0, 0, blockTexture.get());
+    tetromino->createBlock(1, 0, blockTexture.get());
+    tetromino->createBlock(0, 1, blockTexture.get());
+    tetromino->createBlock(1, 1, blockTexture.get());
+
+    EXPECT_TRUE(handler->handle(*tetromino, *gameBoard));
+
+    // No flashing first, the rows are gone and the board dropped by two
+    EXPECT_EQ(handler->getLastClear().clears, 1u);
+    EXPECT_EQ(handler->getLastClear().bottomRow, N_ROWS - 1);
+    EXPECT_EQ(handler->getLastClear().rows, 2);
+    EXPECT_TRUE(gameBoard->getBlock(0, N_ROWS - 1).exists());
+    for (size_t col = 1; col < N_COLS; ++col)
+    {
+        EXPECT_FALSE(gameBoard->getBlock(col, N_ROWS - 1).exists());
+        EXPECT_FALSE(gameBoard->getBlock(col, N_ROWS - 2).exists());
+    }
+
+    // The next piece moves on the very next tick
+    tetromino = std::make_unique<Grid>(160, 0, 2, 2);
+    tetromino->createBlock(0, 0, blockTexture.get());
+    EXPECT_FALSE(handler->handle(*tetromino, *gameBoard));
+    EXPECT_GT(tetromino->getPosY(), 0);
+}
+
+TEST_F(CollisionHandlerTest, CompletedRowsWithAGapClearOnTheirOwn)
+{
+    // An upright bar completes the bottom row and the one two above it,
+    // but not the row between them
+    for (int col = 0; col < N_COLS; ++col)
+    {
+        if (col != 4)
+        {
+            gameBoard->createBlock(col, N_ROWS - 1, blockTexture.get());
+            gameBoard->createBlock(col, N_ROWS - 3, blockTexture.get());
+        }
+        if (col != 4 && col != 5)
+        {
+            gameBoard->createBlock(col, N_ROWS - 2, blockTexture.get());
+        }
+    }
+    gameBoard->createBlock(0, N_ROWS - 4, blockTexture.get());
+    tetromino = std::make_unique<Grid>(4 * BLOCK_SIZE, (N_ROWS - 3) * BLOCK_SIZE - 1, 3, 1);
+    tetromino->createBlock(0, 0, blockTexture.get());
+    tetromino->createBlock(0, 1, blockTexture.get());
+    tetromino->createBlock(0, 2, blockTexture.get());
+
+    EXPECT_TRUE(handler->handle(*tetromino, *gameBoard));
+
+    EXPECT_EQ(handler->getLastClear().clears, 1u);
+    EXPECT_EQ(handler->getLastClear().bottomRow, N_ROWS - 1);
+    EXPECT_EQ(handler->getLastClear().rows, 2);
+    EXPECT_EQ(handler->getLastClear().rowMask, 0b101);
+
+    // The incomplete row is kept and lands on the floor, with the bar's
+    // middle block still in it
+    EXPECT_EQ(gameBoard->getRowMask(N_ROWS - 1), Grid::fullRowMask(N_COLS) & ~(uint64_t { 1 } << 5));
+    EXPECT_EQ(gameBoard->getRowMask(N_ROWS - 2), 1u);
+    EXPECT_EQ(gameBoard->getRowMask(N_ROWS - 3), 0u);
+}
+
+TEST_F(CollisionHandlerTest, HardDropLandsAndLocksInOneTick)
+{
+    gameBoard->createBlock(4, N_ROWS - 1, blockTexture.get());
+    tetromino = std::make_unique<Grid>(4 * BLOCK_SIZE, 0, 2, 2);
+    tetromino->createBlock(0, 0, blockTexture.get());
+    tetromino->createBlock(1, 0, blockTexture.get());
+    tetromino->createBlock(0, 1, blockTexture.get());
+    tetromino->createBlock(1, 1, blockTexture.get());
+    tetromino->applyInput(INPUT_HARD_DROP, 0);
+
+    // Straight onto the block below, as if it had fallen there
+    EXPECT_TRUE(handler->handle(*tetromino, *gameBoard));
+    EXPECT_TRUE(gameBoard->getBlock(4, N_ROWS - 3).exists());
+    EXPECT_TRUE(gameBoard->getBlock(5, N_ROWS - 2).exists());
+    EXPECT_FALSE(gameBoard->getBlock(5, N_ROWS - 1).exists());
+
+    const HardDrop& drop = handler->getLastDrop();
+    EXPECT_EQ(drop.drops, 1u);
+    EXPECT_EQ(drop.col, 4);
+    EXPECT_EQ(drop.cols, 2);
+    EXPECT_EQ(drop.bottomRow, N_ROWS - 2);
+    EXPECT_EQ(drop.rows, N_ROWS - 3);
+}
@@ -0,0 +1,25 @@
+#include "engine/CpuMeter.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(CpuMeterTest, SleepingUsesLittleCpu)
+{
+    CpuMeter meter;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_LT(meter.sample(), 50.0);
+}
+
+TEST(CpuMeterTest, SpinningUsesCpu)
+{
+    // Spin for a fixed amount of CPU time rather than wall time. On a busy
+    // machine this thread may get only a sliver of a core, but whatever it
+    // gets has to show up
+    CpuMeter meter;
+    std::clock_t end = std::clock() + CLOCKS_PER_SEC / 10;
+    volatile unsigned long spins = 0;
+    while (std::clock() < end)
+    {
+        spins = spins + 1;
+    }
+    EXPECT_GT(meter.sample(), 0.0);
+}
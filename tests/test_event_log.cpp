@@ -0,0 +1,211 @@
+#include "tetris/Bot.h"
+#include "tetris/GameEventLog.h"
+#include "engine/EventLog.h"
+#include "engine/Texture.h"
+#include "temp_path.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class EventLogTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path = tempPath("event_log.tev");
+    }
+
+    void TearDown() override
+    {
+        std::remove(path.c_str());
+    }
+
+    std::vector<LogEvent> readAll()
+    {
+        std::vector<LogEvent> events;
+        EventLogReader reader;
+        EXPECT_TRUE(reader.open(path));
+        LogEvent event;
+        while (reader.next(event))
+        {
+            events.push_back(event);
+        }
+        return events;
+    }
+
+    std::string path;
+};
+
+TEST_F(EventLogTest, RoundTripsEvents)
+{
+    EventLog log;
+    ASSERT_TRUE(log.open(path));
+    EXPECT_TRUE(log.isOpen());
+    EXPECT_TRUE(log.log(0, 3, 7, -5, 1000000));
+    EXPECT_TRUE(log.log(1, 4, 0));
+    EXPECT_TRUE(log.log(0, 9, 4000000000u, INT32_MIN, INT32_MAX));
+    log.close();
+    EXPECT_FALSE(log.isOpen());
+    EXPECT_FALSE(log.log(0, 1, 1));
+
+    // The writer may drain the producers in any order, but each one's
+    // events stay in the order they were logged
+    std::vector<LogEvent> events = readAll();
+    ASSERT_EQ(events.size(), 3u);
+    std::vector<LogEvent> first;
+    for (const LogEvent& event : events)
+    {
+        if (event.type == 4)
+        {
+            EXPECT_EQ(event.tick, 0u);
+            EXPECT_EQ(event.args[0], 0);
+        }
+        else
+        {
+            first.push_back(event);
+        }
+    }
+    ASSERT_EQ(first.size(), 2u);
+    EXPECT_EQ(first[0].type, 3);
+    EXPECT_EQ(first[0].tick, 7u);
+    EXPECT_EQ(first[0].args[0], -5);
+    EXPECT_EQ(first[0].args[1], 1000000);
+    EXPECT_EQ(first[1].type, 9);
+    EXPECT_EQ(first[1].tick, 4000000000u);
+    EXPECT_EQ(first[1].args[0], INT32_MIN);
+    EXPECT_EQ(first[1].args[1], INT32_MAX);
+    EXPECT_LE(first[0].timeUs, first[1].timeUs);
+}
+
+TEST_F(EventLogTest, EveryEventIsWrittenOrCountedAsDropped)
+{
+    // Two producers flooding faster than the writer drains, so some events
+    // are dropped, but none may go missing without being counted
+    constexpr uint32_t EVENTS = 100000;
+    EventLog log;
+    ASSERT_TRUE(log.open(path));
+    std::array<uint64_t, EVENT_LOG_PRODUCERS> accepted {};
+    std::vector<std::thread> producers;
+    for (size_t producer = 0; producer < EVENT_LOG_PRODUCERS; ++producer)
+    {
+        producers.emplace_back(
+            [&log, &accepted, producer]()
+            {
+                for (uint32_t tick = 0; tick < EVENTS; ++tick)
+                {
+                    accepted[producer] += log.log(producer, static_cast<uint8_t>(producer), tick) ? 1u : 0u;
+                }
+            });
+    }
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+    uint64_t dropped = log.getDropped();
+    log.close();
+    EXPECT_EQ(accepted[0] + accepted[1] + dropped, 2u * EVENTS);
+
+    std::array<uint64_t, EVENT_LOG_PRODUCERS> written {};
+    std::array<int64_t, EVENT_LOG_PRODUCERS> lastTick { -1, -1 };
+    uint64_t droppedWritten = 0;
+    for (const LogEvent& event : readAll())
+    {
+        if (event.type == EVENT_LOG_DROPPED)
+        {
+            droppedWritten += static_cast<uint64_t>(event.args[1]);
+            continue;
+        }
+        ASSERT_LT(event.type, EVENT_LOG_PRODUCERS);
+        // Each producer's events stay in order
+        EXPECT_GT(static_cast<int64_t>(event.tick), lastTick[event.type]);
+        lastTick[event.type] = event.tick;
+        written[event.type]++;
+    }
+    EXPECT_EQ(written[0], accepted[0]);
+    EXPECT_EQ(written[1], accepted[1]);
+    EXPECT_EQ(droppedWritten, dropped);
+}
+
+TEST_F(EventLogTest, RejectsOtherFiles)
+{
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::fputs("not an event log", file);
+    std::fclose(file);
+
+    EventLogReader reader;
+    EXPECT_FALSE(reader.open(path));
+    EXPECT_FALSE(reader.open(path + ".missing"));
+}
+
+TEST_F(EventLogTest, LogsAGame)
+{
+    auto textures = makeHeadlessTextures();
+
+    // Narrow boards, so the bots clear rows now and then
+    EventLog log;
+    ASSERT_TRUE(log.open(path));
+    std::vector<uint32_t> scores;
+    for (uint64_t seed = 1; seed <= 5; ++seed)
+    {
+        TetrisSimulation simulation(textures, seed, AutoShiftSettings {}, BoardSize { N_ROWS, MIN_BOARD_COLS });
+        GameEventLogger logger(log, simulation, textures);
+        Bot bot { seed };
+        while (simulation.isPlaying())
+        {
+            simulation.step(bot.nextInput(simulation));
+
+            // Play at a few times real speed rather than flat out, so the
+            // writer keeps up and nothing is dropped
+            if (simulation.getTick() % 256 == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        logger.gameOver();
+        scores.push_back(simulation.getScore());
+    }
+    EXPECT_EQ(log.getDropped(), 0u);
+    log.close();
+
+    std::array<uint32_t, GAME_EVENT_FRAME + 1> counts {};
+    size_t games = 0;
+    for (const LogEvent& event : readAll())
+    {
+        ASSERT_LE(event.type, GAME_EVENT_FRAME);
+        counts[event.type]++;
+        if (event.type == GAME_EVENT_SPAWN)
+        {
+            EXPECT_GT(event.args[0], 0) << "a piece without a texture";
+        }
+        if (event.type == GAME_EVENT_LINE_CLEAR)
+        {
+            EXPECT_GE(event.args[0], 1);
+            EXPECT_LE(event.args[0], static_cast<int32_t>(MAX_COMPLETED_ROWS));
+        }
+        if (event.type == GAME_EVENT_GAME_OVER)
+        {
+            ASSERT_LT(games, scores.size());
+            EXPECT_EQ(event.args[0], static_cast<int32_t>(scores[games++]));
+        }
+    }
+
+    // Every lock deals the next piece, on top of the first one
+    uint32_t locks = 0;
+    for (uint32_t score : scores)
+    {
+        locks += score / SCORE_PER_TETRONIMO;
+    }
+    EXPECT_EQ(games, scores.size());
+    EXPECT_EQ(counts[GAME_EVENT_LOCK], locks);
+    EXPECT_EQ(counts[GAME_EVENT_SPAWN], locks + scores.size());
+    EXPECT_GT(counts[GAME_EVENT_MOVE], 0u);
+    EXPECT_GT(counts[GAME_EVENT_ROTATE], 0u);
+    EXPECT_GT(counts[GAME_EVENT_LINE_CLEAR], 0u);
+}
@@ -0,0 +1,39 @@
+#include "engine/FrameArena.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+
+TEST(FrameArenaTest, AllocationsAreAlignedAndDistinct)
+{
+    FrameArena arena(1024);
+    auto* a = static_cast<char*>(arena.allocate(3, 1));
+    auto* b = arena.allocateArray<uint64_t>(4);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % alignof(uint64_t), 0u);
+    EXPECT_GE(reinterpret_cast<char*>(b), a + 3);
+    EXPECT_EQ(b[3], 0u);
+}
+
+TEST(FrameArenaTest, ResetReusesMemory)
+{
+    FrameArena arena(256);
+    void* first = arena.allocate(100);
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+    EXPECT_EQ(arena.allocate(100), first);
+    EXPECT_EQ(arena.highWaterMark(), 100u);
+}
+
+TEST(FrameArenaTest, CreateConstructsInPlace)
+{
+    struct Point
+    {
+        int x;
+        int y;
+    };
+    FrameArena arena(256);
+    Point* point = arena.create<Point>(3, 4);
+    ASSERT_NE(point, nullptr);
+    EXPECT_EQ(point->x, 3);
+    EXPECT_EQ(point->y, 4);
+}
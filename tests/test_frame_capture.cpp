@@ -0,0 +1,137 @@
+#include "engine/FrameCapture.h"
+#include "temp_path.h"
+#include <cstdio>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+namespace
+{
+constexpr int WIDTH = 8;
+constexpr int HEIGHT = 4;
+
+long fileSize(const std::string& path)
+{
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+    {
+        return -1;
+    }
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fclose(file);
+    return size;
+}
+}
+
+class FrameCaptureTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // Captures go in a directory of their own, removed with everything in it
+        directory = tempPath("captures");
+        std::filesystem::create_directory(directory);
+        target = Framebuffer::create(WIDTH, HEIGHT);
+        renderer = SDL_CreateSoftwareRenderer(target.get());
+        ASSERT_NE(renderer, nullptr);
+    }
+
+    void TearDown() override
+    {
+        SDL_DestroyRenderer(renderer);
+        std::filesystem::remove_all(directory);
+    }
+
+    std::string directory;
+    SurfacePtr target;
+    SDL_Renderer* renderer { nullptr };
+};
+
+TEST_F(FrameCaptureTest, OnlyReadsBackWhenAsked)
+{
+    FrameCapture capture;
+    EXPECT_FALSE(capture.capture(renderer, 0));
+    ASSERT_TRUE(capture.open(WIDTH, HEIGHT, 0, directory));
+    EXPECT_FALSE(capture.isRecording());
+    EXPECT_FALSE(capture.capture(renderer, 0));
+
+    capture.requestScreenshot();
+    EXPECT_TRUE(capture.capture(renderer, 16));
+    EXPECT_FALSE(capture.capture(renderer, 32));
+    capture.close();
+    EXPECT_EQ(capture.getFilesWritten(), 1u);
+}
+
+TEST_F(FrameCaptureTest, PendingUntilTheFrameIsCaptured)
+{
+    FrameCapture capture;
+    EXPECT_FALSE(capture.isPending(0));
+    ASSERT_TRUE(capture.open(WIDTH, HEIGHT, 0, directory));
+    EXPECT_FALSE(capture.isPending(0));
+    capture.requestScreenshot();
+    EXPECT_TRUE(capture.isPending(0));
+    EXPECT_TRUE(capture.capture(renderer, 0));
+    EXPECT_FALSE(capture.isPending(1000));
+    capture.close();
+
+    // Recording wants a frame whenever the next one is due
+    ASSERT_TRUE(capture.open(WIDTH, HEIGHT, 1, directory));
+    EXPECT_TRUE(capture.isPending(0));
+    EXPECT_TRUE(capture.capture(renderer, 100));
+    EXPECT_FALSE(capture.isPending(101));
+    EXPECT_TRUE(capture.isPending(100 + 1000 / RECORD_FPS));
+    capture.close();
+}
+
+TEST_F(FrameCaptureTest, ClipHoldsTheLastSecondsAtTheRecordRate)
+{
+    FrameCapture capture;
+    ASSERT_TRUE(capture.open(WIDTH, HEIGHT, 1, directory));
+    EXPECT_TRUE(capture.isRecording());
+
+    // Two seconds of frames into a one second ring, with a stall in the
+    // middle that gets filled with repeats. Each frame read back is waited
+    // on, so none are dropped for want of a buffer
+    Uint32 now = 0;
+    size_t captured = 0;
+    for (int frame = 0; frame < 120; ++frame)
+    {
+        now += (frame == 60) ? 200 : 17;
+        if (capture.capture(renderer, now))
+        {
+            captured++;
+        }
+        while (capture.getFramesProcessed() < captured)
+        {
+            std::this_thread::yield();
+        }
+    }
+    EXPECT_EQ(capture.getDroppedFrames(), 0u);
+    capture.requestClip();
+    capture.capture(renderer, now + 1);
+    capture.close();
+    ASSERT_EQ(capture.getFilesWritten(), 1u);
+
+    // Just the newest RECORD_FPS frames make it into the file
+    std::string clip;
+    for (const auto& entry : std::filesystem::directory_iterator(directory))
+    {
+        clip = entry.path().string();
+    }
+    ASSERT_FALSE(clip.empty());
+    std::string header { "YUV4MPEG2 W8 H4 F30:1 Ip A1:1 C420jpeg\n" };
+    long frameSize = 6 + WIDTH * HEIGHT + 2 * (WIDTH / 2) * (HEIGHT / 2);
+    EXPECT_EQ(fileSize(clip), static_cast<long>(header.size()) + RECORD_FPS * frameSize);
+}
+
+TEST_F(FrameCaptureTest, ClipsNeedRecording)
+{
+    FrameCapture capture;
+    ASSERT_TRUE(capture.open(WIDTH, HEIGHT, 0, directory));
+    capture.requestClip();
+    EXPECT_FALSE(capture.capture(renderer, 0));
+    capture.close();
+    EXPECT_EQ(capture.getFilesWritten(), 0u);
+}
@@ -0,0 +1,90 @@
+#include "engine/FrameExporter.h"
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <string>
+
+namespace
+{
+SurfacePtr solidFrame(int width, int height, uint32_t colour)
+{
+    SurfacePtr frame = Framebuffer::create(width, height);
+    for (int y = 0; y < height; ++y)
+    {
+        uint32_t* row = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(frame->pixels) + y * frame->pitch);
+        std::fill(row, row + width, colour);
+    }
+    return frame;
+}
+
+std::string readFile(const std::string& path)
+{
+    std::string contents;
+    if (FILE* file = std::fopen(path.c_str(), "rb"))
+    {
+        char buffer[4096];
+        size_t read;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            contents.append(buffer, read);
+        }
+        std::fclose(file);
+    }
+    return contents;
+}
+}
+
+TEST(FrameExporterTest, ConvertsToStudioRangeI420)
+{
+    std::vector<uint8_t> planes;
+    FrameExporter::toI420(solidFrame(4, 2, 0xFFFFFFFF).get(), planes);
+    ASSERT_EQ(planes.size(), 8u + 2u + 2u);
+    EXPECT_EQ(planes[0], 235);
+    EXPECT_EQ(planes[8], 128);
+    EXPECT_EQ(planes[10], 128);
+
+    // Odd sizes round the chroma planes up
+    FrameExporter::toI420(solidFrame(3, 3, 0xFF000000).get(), planes);
+    ASSERT_EQ(planes.size(), 9u + 4u + 4u);
+    EXPECT_EQ(planes[0], 16);
+    EXPECT_EQ(planes[16], 128);
+
+    // Pure red has a high V and a low U
+    FrameExporter::toI420(solidFrame(2, 2, 0xFFFF0000).get(), planes);
+    EXPECT_LT(planes[4], 128);
+    EXPECT_GT(planes[5], 128);
+}
+
+TEST(FrameExporterTest, Y4MKeepsFramesInOrder)
+{
+    std::string path { testing::TempDir() + "export_test.y4m" };
+    constexpr int FRAMES = 40;
+    FrameExporter exporter;
+    ASSERT_TRUE(exporter.open(ExportFormat::Y4M, path, 4, 2, 1000, 16, 4));
+
+    // Each frame a different grey, so the order can be read back from Y
+    for (int frame = 0; frame < FRAMES; ++frame)
+    {
+        uint32_t grey = static_cast<uint32_t>(frame * 6);
+        ASSERT_TRUE(exporter.push(solidFrame(4, 2, 0xFF000000 | grey << 16 | grey << 8 | grey).get()));
+    }
+    EXPECT_FALSE(exporter.push(solidFrame(2, 2, 0).get()));
+    ASSERT_TRUE(exporter.close());
+    EXPECT_EQ(exporter.getFramesWritten(), static_cast<size_t>(FRAMES));
+
+    std::string contents = readFile(path);
+    std::remove(path.c_str());
+    std::string header { "YUV4MPEG2 W4 H2 F1000:16 Ip A1:1 C420jpeg\n" };
+    ASSERT_EQ(contents.compare(0, header.size(), header), 0);
+
+    size_t frameSize = 6 + 8 + 2 + 2;
+    ASSERT_EQ(contents.size(), header.size() + FRAMES * frameSize);
+    int lastLuma = -1;
+    for (size_t frame = 0; frame < FRAMES; ++frame)
+    {
+        size_t offset = header.size() + frame * frameSize;
+        ASSERT_EQ(contents.compare(offset, 6, "FRAME\n"), 0);
+        int luma = static_cast<uint8_t>(contents[offset + 6]);
+        EXPECT_GT(luma, lastLuma) << "frame " << frame;
+        lastLuma = luma;
+    }
+}
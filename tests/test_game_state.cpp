@@ -0,0 +1,152 @@
+#include "tetris/CollisionHandler.h"
+#include "tetris/GameState.h"
+#include "tetris/TetronimoFactory.h"
+#include "engine/Texture.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+class GameStateTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        textures = makeHeadlessTextures();
+        palette = TexturePalette(textures);
+    }
+
+    Texture* texture(std::string_view name)
+    {
+        return textures.at(name).get();
+    }
+
+    // Lands 2x2 squares along the bottom row until the row is complete
+    void completeBottomRows(CollisionHandler& handler, Grid& gameBoard)
+    {
+        for (int col = 0; col < N_COLS; col += 2)
+        {
+            Grid square((col * BLOCK_SIZE), (N_ROWS - 2) * BLOCK_SIZE - 1, 2, 2);
+            square.createBlock(0, 0, texture(BLOCK_TEXTURE_YELLOW));
+            square.createBlock(1, 0, texture(BLOCK_TEXTURE_YELLOW));
+            square.createBlock(0, 1, texture(BLOCK_TEXTURE_YELLOW));
+            square.createBlock(1, 1, texture(BLOCK_TEXTURE_YELLOW));
+            handler.handle(square, gameBoard);
+        }
+    }
+
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>> textures;
+    TexturePalette palette;
+};
+
+TEST_F(GameStateTest, PaletteRoundTrip)
+{
+    EXPECT_EQ(palette.indexOf(nullptr), 0);
+    EXPECT_EQ(palette.at(0), nullptr);
+    for (auto name : PALETTE_TEXTURES)
+    {
+        uint8_t index = palette.indexOf(texture(name));
+        EXPECT_NE(index, 0);
+        EXPECT_EQ(palette.at(index), texture(name));
+    }
+}
+
+TEST_F(GameStateTest, GridRoundTrip)
+{
+    Grid grid(120, 80, 3, 3);
+    grid.createBlock(1, 0, texture(BLOCK_TEXTURE_PURPLE));
+    grid.createBlock(0, 1, texture(BLOCK_TEXTURE_PURPLE));
+    grid.createBlock(2, 1, texture(BLOCK_TEXTURE_RED));
+    grid.setVelX(BLOCK_SIZE);
+
+    GridState<MAX_TETRONIMO_SIZE, MAX_TETRONIMO_SIZE> state {};
+    grid.snapshot(state, palette);
+
+    Grid restored(0, 0, 0, 0);
+    restored.restore(state, palette);
+
+    EXPECT_EQ(restored.getHeight(), 3u);
+    EXPECT_EQ(restored.getWidth(), 3u);
+    EXPECT_EQ(restored.getPosX(), 120);
+    EXPECT_EQ(restored.getPosY(), 80);
+    grid.forEachBlock(
+        [&restored](Block& block, size_t xIndex, size_t yIndex)
+        {
+            Block& other = restored.getBlock(xIndex, yIndex);
+            EXPECT_EQ(other.getTexture(), block.getTexture());
+            if (block.exists())
+            {
+                EXPECT_EQ(other.getPosX(), block.getPosX());
+                EXPECT_EQ(other.getPosY(), block.getPosY());
+            }
+        });
+
+    // Velocity is restored too
+    restored.move(1, 0);
+    EXPECT_EQ(restored.getPosX(), 120 + BLOCK_SIZE);
+}
+
+TEST_F(GameStateTest, RestoreRollsBackBoard)
+{
+    Grid gameBoard(0, 0, N_ROWS, N_COLS);
+    gameBoard.updatePositions();
+
+    GameState before {};
+    gameBoard.snapshot(before.board, palette);
+
+    gameBoard.createBlock(3, 20, texture(BLOCK_TEXTURE_GREEN));
+    gameBoard.restore(before.board, palette);
+
+    EXPECT_FALSE(gameBoard.getBlock(3, 20).exists());
+}
+
+TEST_F(GameStateTest, CollisionHandlerRestoresLastClear)
+{
+    CollisionHandler handler;
+    Grid gameBoard(0, 0, N_ROWS, N_COLS);
+    gameBoard.updatePositions();
+    completeBottomRows(handler, gameBoard);
+
+    // Copy the state after the clear, through memcpy to prove it is flat
+    GameState live {};
+    gameBoard.snapshot(live.board, palette);
+    handler.snapshot(live);
+    GameState copy;
+    std::memcpy(&copy, &live, sizeof(GameState));
+    EXPECT_EQ(copy.lastClear.clears, 1u);
+    EXPECT_EQ(copy.lastClear.bottomRow, N_ROWS - 1);
+    EXPECT_EQ(copy.lastClear.rows, 2);
+
+    CollisionHandler restoredHandler;
+    Grid restoredBoard(0, 0, 0, 0);
+    restoredBoard.restore(copy.board, palette);
+    restoredHandler.restore(copy);
+
+    // The rows were deleted before the snapshot was taken
+    for (size_t col = 0; col < N_COLS; ++col)
+    {
+        EXPECT_FALSE(restoredBoard.getBlock(col, N_ROWS - 1).exists());
+    }
+    EXPECT_EQ(restoredHandler.getLastClear().clears, 1u);
+    EXPECT_TRUE(restoredHandler.keepPlaying());
+}
+
+TEST_F(GameStateTest, FactoryStateReplaysSameSequence)
+{
+    TetronimoFactory factory(textures, 1234);
+    uint64_t state = factory.getState();
+
+    std::vector<uint8_t> first;
+    for (int i = 0; i < 20; ++i)
+    {
+        Grid tetronimo = factory.getNextTetronimo();
+        first.push_back(palette.indexOf(tetronimo.getBlock(1, 1).getTexture()));
+    }
+
+    factory.setState(state);
+    for (size_t i = 0; i < first.size(); ++i)
+    {
+        Grid tetronimo = factory.getNextTetronimo();
+        EXPECT_EQ(palette.indexOf(tetronimo.getBlock(1, 1).getTexture()), first[i]);
+    }
+}
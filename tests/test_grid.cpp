@@ -414,4 +414,77 @@ TEST_F(GridTest, EmptyGridOperations)
     ASSERT_NO_THROW(emptyGrid.render());
     
     EXPECT_EQ(countExistingBlocks(emptyGrid), 0);
-}
\ No newline at end of file
+}
+
+TEST_F(GridTest, RowMasksFollowBlocks)
+{
+    Grid grid(0, 0, 4, 4);
+    grid.createBlock(0, 1, mockTexture1.get());
+    grid.createBlock(3, 1, mockTexture1.get());
+    EXPECT_EQ(grid.getRowMask(0), 0u);
+    EXPECT_EQ(grid.getRowMask(1), 0b1001u);
+
+    // Rotating clockwise turns row 1 into column 2
+    grid.rotateClockwise();
+    EXPECT_EQ(grid.getRowMask(0), 0b0100u);
+    EXPECT_EQ(grid.getRowMask(1), 0u);
+    EXPECT_EQ(grid.getRowMask(3), 0b0100u);
+
+    grid.reset(0, 0, 4, 4);
+    EXPECT_EQ(grid.getRowMask(0), 0u);
+    EXPECT_EQ(grid.getRowMask(3), 0u);
+}
+
+TEST_F(GridTest, FullRowOnWidestBoard)
+{
+    Grid grid(0, 0, 2, MAX_BOARD_COLS);
+    for (size_t col = 0; col + 1 < MAX_BOARD_COLS; ++col)
+    {
+        grid.createBlock(static_cast<int>(col), 1, mockTexture1.get());
+    }
+    EXPECT_FALSE(grid.isRowFull(1));
+    grid.createBlock(MAX_BOARD_COLS - 1, 1, mockTexture1.get());
+    EXPECT_TRUE(grid.isRowFull(1));
+    EXPECT_FALSE(grid.isRowFull(0));
+}
+
+TEST_F(GridTest, MoveRowsDownOnTallBoard)
+{
+    constexpr size_t rows = 4000;
+    Grid grid(0, 0, rows, 8);
+    grid.createBlock(2, 10, mockTexture1.get());
+    grid.createBlock(0, rows - 1, mockTexture2.get());
+
+    grid.moveRowsDown(rows - 1, 1);
+
+    EXPECT_FALSE(grid.getBlock(0, rows - 1).exists());
+    EXPECT_EQ(grid.getRowMask(rows - 1), 0u);
+    EXPECT_EQ(grid.getRowMask(11), 0b100u);
+    EXPECT_EQ(grid.getBlock(2, 11).getTexture(), mockTexture1.get());
+    EXPECT_EQ(grid.getBlock(2, 11).getPosY(), 11 * BLOCK_SIZE);
+}
+
+TEST_F(GridTest, FlatRowMajorStorage)
+{
+    Grid grid(0, 0, 3, 4);
+    grid.createBlock(3, 0, mockTexture1.get());
+    grid.createBlock(0, 1, mockTexture2.get());
+
+    // Rows are contiguous and follow each other
+    EXPECT_EQ(grid.getRow(1), grid.getRow(0) + 4);
+    EXPECT_EQ(&grid.getBlock(0, 1), grid.getRow(0) + 4);
+    EXPECT_EQ(grid.end() - grid.begin(), 12);
+
+    // Iteration visits rows in order
+    std::vector<Texture*> seen;
+    for (Block& block : grid)
+    {
+        if (block.exists())
+        {
+            seen.push_back(block.getTexture());
+        }
+    }
+    ASSERT_EQ(seen.size(), 2u);
+    EXPECT_EQ(seen[0], mockTexture1.get());
+    EXPECT_EQ(seen[1], mockTexture2.get());
+}
@@ -0,0 +1,94 @@
+#include "engine/Framebuffer.h"
+#include "tetris/Tetris.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+void setPixel(SDL_Surface* frame, int x, int y, uint32_t colour)
+{
+    static_cast<uint32_t*>(frame->pixels)[y * (frame->pitch / 4) + x] = colour;
+}
+
+uint32_t getPixel(const SDL_Surface* frame, int x, int y)
+{
+    return static_cast<const uint32_t*>(frame->pixels)[y * (frame->pitch / 4) + x];
+}
+
+// The middle of a board cell in the frame
+uint32_t cellPixel(const SDL_Surface* frame, int row, int col)
+{
+    return getPixel(frame, col * BLOCK_SIZE + BLOCK_SIZE / 2, row * BLOCK_SIZE + BLOCK_SIZE / 2);
+}
+}
+
+TEST(FramebufferTest, HashAndDiffSeeEveryPixel)
+{
+    SurfacePtr first = Framebuffer::create(8, 4);
+    SurfacePtr second = Framebuffer::create(8, 4);
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(Framebuffer::hash(first.get()), Framebuffer::hash(second.get()));
+    EXPECT_EQ(Framebuffer::countDifferentPixels(first.get(), second.get()), 0);
+
+    setPixel(second.get(), 7, 3, 0xFF102030);
+    setPixel(second.get(), 0, 1, 0xFF102030);
+    EXPECT_NE(Framebuffer::hash(first.get()), Framebuffer::hash(second.get()));
+    EXPECT_EQ(Framebuffer::countDifferentPixels(first.get(), second.get()), 2);
+
+    SurfacePtr other = Framebuffer::create(4, 8);
+    EXPECT_EQ(Framebuffer::countDifferentPixels(first.get(), other.get()), -1);
+}
+
+TEST(HeadlessRenderTest, DrawsTheSameFrameForTheSameState)
+{
+    TetrisGameEngine tetris {};
+    ASSERT_TRUE(tetris.startHeadless());
+    ASSERT_NE(tetris.getFrame(), nullptr);
+    EXPECT_EQ(tetris.getFrame()->w, N_COLS * BLOCK_SIZE);
+    EXPECT_EQ(tetris.getFrame()->h, N_ROWS * BLOCK_SIZE + BOTTOM_BAR_HEIGHT);
+
+    GameState state = tetris.snapshot();
+    state.board.cells[N_ROWS - 1][0] = 1;
+    tetris.restore(state);
+    ASSERT_TRUE(tetris.drawHeadlessFrame());
+    SurfacePtr golden = Framebuffer::copy(tetris.getFrame());
+    uint64_t hash = Framebuffer::hash(tetris.getFrame());
+
+    // Nothing moves without the simulation thread
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        ASSERT_TRUE(tetris.drawHeadlessFrame());
+        EXPECT_EQ(Framebuffer::hash(tetris.getFrame()), hash);
+    }
+    EXPECT_EQ(Framebuffer::countDifferentPixels(tetris.getFrame(), golden.get()), 0);
+}
+
+TEST(HeadlessRenderTest, DrawsTheBlocksOnTheBoard)
+{
+    TetrisGameEngine tetris {};
+    ASSERT_TRUE(tetris.startHeadless());
+    const SDL_Surface* frame = tetris.getFrame();
+    GameState empty = tetris.snapshot();
+    tetris.restore(empty);
+    ASSERT_TRUE(tetris.drawHeadlessFrame());
+    SurfacePtr before = Framebuffer::copy(frame);
+
+    // Even the background is drawn opaque, so an untouched frame means an
+    // SDL without a working software renderer
+    SurfacePtr blank = Framebuffer::create(frame->w, frame->h);
+    if (Framebuffer::countDifferentPixels(frame, blank.get()) == 0)
+    {
+        GTEST_SKIP() << "This SDL's software renderer doesn't draw";
+    }
+
+    GameState state = empty;
+    state.board.cells[N_ROWS - 1][0] = 1;
+    tetris.restore(state);
+    ASSERT_TRUE(tetris.drawHeadlessFrame());
+
+    // The block covers its own cell and nothing else
+    EXPECT_NE(cellPixel(frame, N_ROWS - 1, 0), cellPixel(before.get(), N_ROWS - 1, 0));
+    EXPECT_NE(cellPixel(frame, N_ROWS - 1, 0), cellPixel(frame, N_ROWS - 1, N_COLS - 1));
+    long changed = Framebuffer::countDifferentPixels(frame, before.get());
+    EXPECT_GT(changed, 0);
+    EXPECT_LE(changed, BLOCK_SIZE * BLOCK_SIZE);
+}
@@ -0,0 +1,148 @@
+#include "tetris/Input.h"
+#include "tetris/Simulation.h"
+#include "engine/Texture.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class KeyboardInputTest : public ::testing::Test
+{
+protected:
+    static InputEvent event(uint32_t timestamp, uint8_t flag, bool pressed)
+    {
+        return InputEvent { timestamp, flag, pressed };
+    }
+
+    KeyboardInput keyboard;
+};
+
+TEST_F(KeyboardInputTest, HeldKeyStaysHeld)
+{
+    keyboard.handleEvent(event(10, INPUT_DOWN, true));
+    EXPECT_EQ(keyboard.getInput(), INPUT_DOWN);
+    keyboard.clearPressed();
+    EXPECT_EQ(keyboard.getInput(), INPUT_DOWN);
+
+    keyboard.handleEvent(event(20, INPUT_DOWN, false));
+    EXPECT_EQ(keyboard.getInput(), INPUT_NONE);
+}
+
+TEST_F(KeyboardInputTest, TapBetweenTicksIsNotLost)
+{
+    keyboard.handleEvent(event(10, INPUT_LEFT, true));
+    keyboard.handleEvent(event(12, INPUT_LEFT, false));
+
+    uint8_t input = keyboard.getInput();
+    EXPECT_TRUE(input & INPUT_LEFT_PRESSED);
+    EXPECT_FALSE(input & INPUT_LEFT);
+
+    keyboard.clearPressed();
+    EXPECT_EQ(keyboard.getInput(), INPUT_NONE);
+}
+
+TEST_F(KeyboardInputTest, OldestTimestampIsKept)
+{
+    EXPECT_EQ(keyboard.getOldestTimestamp(), 0u);
+    keyboard.handleEvent(event(10, INPUT_RIGHT, true));
+    keyboard.handleEvent(event(14, INPUT_ROTATE, true));
+    EXPECT_EQ(keyboard.getOldestTimestamp(), 10u);
+
+    keyboard.clearPressed();
+    EXPECT_EQ(keyboard.getOldestTimestamp(), 0u);
+}
+
+TEST_F(KeyboardInputTest, HardDropOnlyCountsForOneTick)
+{
+    SDL_Event up {};
+    up.type = SDL_KEYDOWN;
+    up.key.keysym.sym = SDLK_UP;
+    InputEvent input {};
+    ASSERT_TRUE(KeyboardInput::toInputEvent(up, input));
+    EXPECT_EQ(input.flag, INPUT_HARD_DROP);
+
+    // Holding it down doesn't drop the next piece as well, even once the
+    // OS starts repeating the key
+    keyboard.handleEvent(input);
+    EXPECT_EQ(keyboard.getInput(), INPUT_HARD_DROP);
+    keyboard.clearPressed();
+    EXPECT_EQ(keyboard.getInput(), INPUT_NONE);
+    up.key.repeat = 1;
+    keyboard.handleEvent(up);
+    EXPECT_EQ(keyboard.getInput(), INPUT_NONE);
+}
+
+TEST(AutoShiftTest, MovesOnPressThenAfterDelayThenEveryRepeat)
+{
+    AutoShift autoShift { AutoShiftSettings { 4, 2 } };
+
+    EXPECT_EQ(autoShift.update(INPUT_RIGHT | INPUT_RIGHT_PRESSED), 1);
+    std::vector<int> shifts;
+    for (int tick = 0; tick < 8; ++tick)
+    {
+        shifts.push_back(autoShift.update(INPUT_RIGHT));
+    }
+    EXPECT_EQ(shifts, (std::vector<int> { 0, 0, 0, 1, 0, 1, 0, 1 }));
+
+    EXPECT_EQ(autoShift.update(INPUT_NONE), 0);
+    EXPECT_EQ(autoShift.getDirection(), 0);
+}
+
+TEST(AutoShiftTest, TapMovesExactlyOnce)
+{
+    AutoShift autoShift {};
+    EXPECT_EQ(autoShift.update(INPUT_LEFT_PRESSED), -1);
+    EXPECT_EQ(autoShift.update(INPUT_NONE), 0);
+}
+
+TEST(AutoShiftTest, LatestPressWinsAndReleaseFallsBack)
+{
+    AutoShift autoShift { AutoShiftSettings { 3, 1 } };
+    EXPECT_EQ(autoShift.update(INPUT_LEFT | INPUT_LEFT_PRESSED), -1);
+    EXPECT_EQ(autoShift.update(INPUT_LEFT | INPUT_RIGHT | INPUT_RIGHT_PRESSED), 1);
+    EXPECT_EQ(autoShift.update(INPUT_LEFT | INPUT_RIGHT), 0);
+
+    // Letting go of right goes back to left, charging from scratch
+    EXPECT_EQ(autoShift.update(INPUT_LEFT), -1);
+    EXPECT_EQ(autoShift.getHeldTicks(), 0u);
+}
+
+TEST(AutoShiftTest, KeyRepeatDoesNotRestartTheDelay)
+{
+    SDL_Event right {};
+    right.type = SDL_KEYDOWN;
+    right.key.keysym.sym = SDLK_RIGHT;
+    KeyboardInput keyboard;
+    AutoShift autoShift { AutoShiftSettings { 10, 2 } };
+    InputEvent input {};
+    ASSERT_TRUE(KeyboardInput::toInputEvent(right, input));
+    keyboard.handleEvent(input);
+    EXPECT_EQ(autoShift.update(keyboard.getInput()), 1);
+    keyboard.clearPressed();
+    for (int tick = 0; tick < 3; ++tick)
+    {
+        autoShift.update(keyboard.getInput());
+        keyboard.clearPressed();
+    }
+
+    // The OS starts repeating the key while it is still charging
+    right.key.repeat = 1;
+    EXPECT_FALSE(KeyboardInput::toInputEvent(right, input));
+    keyboard.handleEvent(right);
+    EXPECT_EQ(autoShift.update(keyboard.getInput()), 0);
+    EXPECT_EQ(autoShift.getHeldTicks(), 4u);
+}
+
+TEST(AutoShiftTest, ActsWithinOneTickInTheSimulation)
+{
+    auto textures = makeHeadlessTextures();
+    TetrisSimulation simulation(textures, 1);
+
+    // The tick that sees the tap is the tick that moves the piece
+    KeyboardInput keyboard;
+    keyboard.handleEvent(InputEvent { 5, INPUT_RIGHT, true });
+    keyboard.handleEvent(InputEvent { 6, INPUT_RIGHT, false });
+    int startX = simulation.getCurrentTetronimo().getPosX();
+    simulation.step(keyboard.getInput());
+    EXPECT_EQ(simulation.getCurrentTetronimo().getPosX(), startX + BLOCK_SIZE);
+}
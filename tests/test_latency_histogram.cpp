@@ -0,0 +1,74 @@
+#include "engine/LatencyHistogram.h"
+#include <gtest/gtest.h>
+
+TEST(LatencyHistogramTest, EmptyHistogramReportsZero)
+{
+    LatencyHistogram histogram;
+    LatencyPercentiles percentiles = histogram.getPercentiles();
+    EXPECT_EQ(percentiles.samples, 0u);
+    EXPECT_EQ(percentiles.p99, 0u);
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact)
+{
+    LatencyHistogram histogram;
+    for (uint32_t value = 1; value <= 30; ++value)
+    {
+        histogram.record(value);
+    }
+
+    LatencyPercentiles percentiles = histogram.getPercentiles();
+    EXPECT_EQ(percentiles.samples, 30u);
+    EXPECT_EQ(percentiles.p50, 15u);
+    EXPECT_EQ(percentiles.max, 30u);
+}
+
+TEST(LatencyHistogramTest, LargeValuesAreClose)
+{
+    LatencyHistogram histogram;
+    for (uint32_t value = 1; value <= 100000; ++value)
+    {
+        histogram.record(value);
+    }
+
+    LatencyPercentiles percentiles = histogram.getPercentiles();
+    EXPECT_NEAR(percentiles.p50, 50000, 50000 / 16);
+    EXPECT_NEAR(percentiles.p99, 99000, 99000 / 16);
+    EXPECT_LE(percentiles.p99, 99000u);
+    EXPECT_EQ(percentiles.max, 100000u);
+}
+
+TEST(LatencyHistogramTest, KeepsTheTailOfManySamples)
+{
+    // A window of recent samples would have forgotten the spike
+    LatencyHistogram histogram;
+    for (int index = 0; index < 50; ++index)
+    {
+        histogram.record(5000);
+    }
+    for (int index = 0; index < 100000; ++index)
+    {
+        histogram.record(10);
+    }
+
+    LatencyPercentiles percentiles = histogram.getPercentiles();
+    EXPECT_EQ(percentiles.p99, 10u);
+    EXPECT_EQ(percentiles.max, 5000u);
+}
+
+TEST(LatencyHistogramTest, Merge)
+{
+    LatencyHistogram first;
+    LatencyHistogram second;
+    first.record(uint32_t { 1 } << 31);
+    second.record(3);
+    second.record(4);
+
+    first.merge(second);
+    EXPECT_EQ(first.getCount(), 3u);
+    EXPECT_EQ(first.getPercentiles().p50, 4u);
+    EXPECT_EQ(first.getPercentiles().max, uint32_t { 1 } << 31);
+
+    first.clear();
+    EXPECT_EQ(first.getCount(), 0u);
+}
@@ -0,0 +1,44 @@
+#include "engine/LatencyTracker.h"
+#include <gtest/gtest.h>
+
+TEST(LatencyTrackerTest, EmptyTrackerReportsZero)
+{
+    LatencyTracker tracker;
+    LatencyPercentiles percentiles = tracker.getPercentiles();
+    EXPECT_EQ(percentiles.samples, 0u);
+    EXPECT_EQ(percentiles.p99, 0u);
+}
+
+TEST(LatencyTrackerTest, Percentiles)
+{
+    LatencyTracker tracker;
+    for (uint32_t latency = 100; latency >= 1; --latency)
+    {
+        tracker.record(latency);
+    }
+
+    LatencyPercentiles percentiles = tracker.getPercentiles();
+    EXPECT_EQ(percentiles.samples, 100u);
+    EXPECT_EQ(percentiles.p50, 50u);
+    EXPECT_EQ(percentiles.p90, 90u);
+    EXPECT_EQ(percentiles.p99, 99u);
+    EXPECT_EQ(percentiles.max, 100u);
+}
+
+TEST(LatencyTrackerTest, OnlyRecentSamplesCount)
+{
+    LatencyTracker tracker;
+    for (size_t index = 0; index < LATENCY_WINDOW; ++index)
+    {
+        tracker.record(1000);
+    }
+    for (size_t index = 0; index < LATENCY_WINDOW; ++index)
+    {
+        tracker.record(5);
+    }
+
+    LatencyPercentiles percentiles = tracker.getPercentiles();
+    EXPECT_EQ(percentiles.samples, LATENCY_WINDOW);
+    EXPECT_EQ(percentiles.max, 5u);
+    EXPECT_EQ(tracker.getTotalSamples(), 2 * LATENCY_WINDOW);
+}
@@ -0,0 +1,174 @@
+#include "engine/UdpSocket.h"
+#include "tetris/Constants.h"
+#include "tetris/Input.h"
+#include "tetris/MatchServer.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+TEST(MatchProtocolTest, InputRoundTrip)
+{
+    MatchInputPacket packet {};
+    packet.matchId = 0x01020304;
+    packet.player = 1;
+    packet.sequence = 77;
+    packet.input = INPUT_LEFT | INPUT_ROTATE;
+    uint8_t buffer[MATCH_INPUT_PACKET_SIZE];
+    encodeMatchInput(packet, buffer);
+
+    MatchInputPacket decoded {};
+    ASSERT_TRUE(decodeMatchInput(buffer, sizeof(buffer), decoded));
+    EXPECT_EQ(decoded.matchId, packet.matchId);
+    EXPECT_EQ(decoded.player, 1);
+    EXPECT_EQ(decoded.sequence, 77u);
+    EXPECT_EQ(decoded.input, packet.input);
+
+    // Little endian on the wire
+    EXPECT_EQ(buffer[4], 0x04);
+    EXPECT_EQ(buffer[7], 0x01);
+}
+
+TEST(MatchProtocolTest, RejectsBadInputs)
+{
+    MatchInputPacket packet {};
+    uint8_t buffer[MATCH_INPUT_PACKET_SIZE];
+    encodeMatchInput(packet, buffer);
+    MatchInputPacket decoded {};
+    EXPECT_FALSE(decodeMatchInput(buffer, sizeof(buffer) - 1, decoded));
+
+    buffer[8] = 2; // there are only two players
+    EXPECT_FALSE(decodeMatchInput(buffer, sizeof(buffer), decoded));
+
+    encodeMatchInput(packet, buffer);
+    buffer[0] ^= 0xFF;
+    EXPECT_FALSE(decodeMatchInput(buffer, sizeof(buffer), decoded));
+}
+
+TEST(MatchProtocolTest, StateRoundTrip)
+{
+    MatchStatePacket packet {};
+    packet.matchId = 9;
+    packet.tick = 1234;
+    packet.ackSequence = 1200;
+    packet.scores = { 5, 70000 };
+    packet.playing = { true, false };
+    uint8_t buffer[MATCH_STATE_PACKET_SIZE];
+    encodeMatchState(packet, buffer);
+
+    MatchStatePacket decoded {};
+    ASSERT_TRUE(decodeMatchState(buffer, sizeof(buffer), decoded));
+    EXPECT_EQ(decoded.matchId, 9u);
+    EXPECT_EQ(decoded.tick, 1234u);
+    EXPECT_EQ(decoded.ackSequence, 1200u);
+    EXPECT_EQ(decoded.scores[1], 70000u);
+    EXPECT_TRUE(decoded.playing[0]);
+    EXPECT_FALSE(decoded.playing[1]);
+}
+
+TEST(MatchProtocolTest, MatchesAreSpreadOverShards)
+{
+    EXPECT_EQ(matchServerPort(7100, 0, 4), 7100);
+    EXPECT_EQ(matchServerPort(7100, 6, 4), 7102);
+}
+
+#ifdef __linux__
+class MatchServerTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        config.basePort = 0;
+        config.shards = 2;
+        config.pinThreads = false;
+    }
+
+    void connect(MatchServer& server, uint32_t matchId)
+    {
+        for (auto& player : players)
+        {
+            ASSERT_TRUE(player.open(0));
+            ASSERT_TRUE(player.setPeer("127.0.0.1", server.getPort(matchId % server.getShardCount())));
+        }
+    }
+
+    void sendInput(size_t player, uint32_t matchId, uint32_t sequence, uint8_t input)
+    {
+        MatchInputPacket packet {};
+        packet.matchId = matchId;
+        packet.player = static_cast<uint8_t>(player);
+        packet.sequence = sequence;
+        packet.input = input;
+        uint8_t buffer[MATCH_INPUT_PACKET_SIZE];
+        encodeMatchInput(packet, buffer);
+        ASSERT_TRUE(players[player].send(buffer, sizeof(buffer)));
+    }
+
+    MatchServerConfig config;
+    std::array<UdpSocket, 2> players;
+};
+
+TEST_F(MatchServerTest, PlaysAMatchOverLoopback)
+{
+    MatchServer server { config };
+    ASSERT_TRUE(server.start());
+    ASSERT_EQ(server.getShardCount(), 2u);
+    constexpr uint32_t MATCH_ID = 3;
+    connect(server, MATCH_ID);
+
+    std::array<MatchStatePacket, 2> latest {};
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    for (uint32_t sequence = 1; latest[0].tick < 30 || latest[1].ackSequence < 10; ++sequence)
+    {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline) << "the match never ticked";
+        sendInput(0, MATCH_ID, sequence, INPUT_DOWN);
+        sendInput(1, MATCH_ID, sequence, INPUT_LEFT);
+        std::this_thread::sleep_for(std::chrono::milliseconds(TICK_MS));
+
+        for (size_t player = 0; player < 2; ++player)
+        {
+            uint8_t buffer[MATCH_STATE_PACKET_SIZE];
+            MatchStatePacket state {};
+            while (players[player].receive(buffer, sizeof(buffer)) > 0)
+            {
+                ASSERT_TRUE(decodeMatchState(buffer, sizeof(buffer), state));
+                EXPECT_EQ(state.matchId, MATCH_ID);
+                EXPECT_GE(state.tick, latest[player].tick);
+                latest[player] = state;
+            }
+        }
+    }
+    EXPECT_TRUE(latest[0].playing[0]);
+    EXPECT_TRUE(latest[0].playing[1]);
+
+    MatchServerStats stats = server.takeStats();
+    EXPECT_EQ(stats.matches, 1u);
+    EXPECT_EQ(stats.matchesStarted, 1u);
+    EXPECT_GE(stats.ticks, 60u);
+    EXPECT_GT(stats.packetsOut, 0u);
+    EXPECT_GT(stats.tickLatencyUs.getCount(), 0u);
+
+    // Taking the stats resets the counters, but not the running matches
+    stats = server.takeStats();
+    EXPECT_EQ(stats.matches, 1u);
+    EXPECT_EQ(stats.matchesStarted, 0u);
+}
+
+TEST_F(MatchServerTest, DropsIdleMatches)
+{
+    config.idleTimeoutMs = 50;
+    MatchServer server { config };
+    ASSERT_TRUE(server.start());
+    connect(server, 0);
+    sendInput(0, 0, 1, INPUT_NONE);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    uint64_t dropped = 0;
+    while (dropped == 0)
+    {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline) << "the match was never dropped";
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        dropped += server.takeStats().matchesDropped;
+    }
+    EXPECT_EQ(server.takeStats().matches, 0u);
+}
+#endif
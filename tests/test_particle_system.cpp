@@ -0,0 +1,79 @@
+#include "engine/ParticleSystem.h"
+#include "tetris/ParticleEffects.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+constexpr SDL_Color WHITE { 0xFF, 0xFF, 0xFF, 0xFF };
+}
+
+TEST(ParticleSystemTest, DropsParticlesPastCapacity)
+{
+    ParticleSystem particles { 3 };
+    EXPECT_TRUE(particles.empty());
+    EXPECT_TRUE(particles.emit(0, 0, 0, 0, 1, WHITE));
+    EXPECT_TRUE(particles.emit(0, 0, 0, 0, 1, WHITE));
+    EXPECT_TRUE(particles.emit(0, 0, 0, 0, 1, WHITE));
+    EXPECT_FALSE(particles.emit(0, 0, 0, 0, 1, WHITE));
+    EXPECT_FALSE(ParticleSystem { 3 }.emit(0, 0, 0, 0, 0, WHITE));
+    EXPECT_EQ(particles.size(), 3u);
+    EXPECT_EQ(particles.capacity(), 3u);
+
+    particles.clear();
+    EXPECT_TRUE(particles.empty());
+}
+
+TEST(ParticleSystemTest, EveryParticleMovesTheSame)
+{
+    // Not a multiple of four, so both the vector loop and the tail run
+    ParticleSystem particles { 16 };
+    particles.setGravity(100);
+    for (int index = 0; index < 7; ++index)
+    {
+        particles.emit(static_cast<float>(index), 0, 10, -20, 5, WHITE);
+    }
+
+    particles.update(0.5f);
+    ASSERT_EQ(particles.size(), 7u);
+    for (size_t index = 0; index < particles.size(); ++index)
+    {
+        // Gravity first, then the new velocity moves it: -20 + 50 = 30
+        EXPECT_FLOAT_EQ(particles.getPosX(index), static_cast<float>(index) + 5);
+        EXPECT_FLOAT_EQ(particles.getPosY(index), 15);
+    }
+}
+
+TEST(ParticleSystemTest, ExpiredParticlesAreRemoved)
+{
+    ParticleSystem particles { 16 };
+    for (int index = 0; index < 9; ++index)
+    {
+        // Every other one lives past the first update
+        float life = (index % 2 == 0) ? 0.1f : 1.0f;
+        particles.emit(static_cast<float>(index), 0, 0, 0, life, WHITE);
+    }
+
+    particles.update(0.5f);
+    ASSERT_EQ(particles.size(), 4u);
+    for (size_t index = 0; index < particles.size(); ++index)
+    {
+        EXPECT_EQ(static_cast<int>(particles.getPosX(index)) % 2, 1);
+    }
+    particles.update(0.5f);
+    EXPECT_TRUE(particles.empty());
+}
+
+TEST(ParticleEffectsTest, BurstsFadeAway)
+{
+    ParticleEffects effects;
+    EXPECT_TRUE(effects.empty());
+    effects.lineCleared(LineClear { 1, N_ROWS - 1, 2, 0b11 }, N_COLS, 0);
+    effects.hardDropped(HardDrop { 1, 4, 2, N_ROWS - 1, 10 }, 0);
+    EXPECT_FALSE(effects.empty());
+
+    for (int frame = 0; frame < 60; ++frame)
+    {
+        effects.update(1.0f / 60.0f);
+    }
+    EXPECT_TRUE(effects.empty());
+}
@@ -0,0 +1,126 @@
+#include "tetris/ReplayCorpus.h"
+#include "temp_path.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <numeric>
+
+class ReplayCorpusTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        path = tempPath("replay_corpus.trc");
+
+        // Replay i has i + 1 ticks, each input byte equal to i
+        ReplayCorpusWriter writer;
+        ASSERT_TRUE(writer.open(path));
+        for (uint32_t i = 0; i < nReplays; ++i)
+        {
+            std::vector<uint8_t> inputs(i + 1, static_cast<uint8_t>(i));
+            ASSERT_TRUE(writer.add(1000 + i, i * 10, i % 4, inputs.data(), inputs.size()));
+        }
+        ASSERT_TRUE(writer.close());
+    }
+
+    void TearDown() override
+    {
+        std::remove(path.c_str());
+    }
+
+    static constexpr uint32_t nReplays = 50;
+    std::string path;
+};
+
+TEST_F(ReplayCorpusTest, OpenReadsIndex)
+{
+    ReplayCorpus corpus;
+    ASSERT_TRUE(corpus.open(path));
+    EXPECT_EQ(corpus.size(), nReplays);
+}
+
+TEST_F(ReplayCorpusTest, MetadataRoundTrips)
+{
+    ReplayCorpus corpus;
+    ASSERT_TRUE(corpus.open(path));
+
+    const ReplayMetadata& metadata = corpus.getMetadata(7);
+    EXPECT_EQ(metadata.seed, 1007u);
+    EXPECT_EQ(metadata.score, 70u);
+    EXPECT_EQ(metadata.lines, 3u);
+    EXPECT_EQ(metadata.length, 8u);
+}
+
+TEST_F(ReplayCorpusTest, SeekToReplay)
+{
+    ReplayCorpus corpus;
+    ASSERT_TRUE(corpus.open(path));
+
+    ReplayView replay = corpus.getReplay(42);
+    ASSERT_NE(replay.inputs, nullptr);
+    ASSERT_EQ(replay.length, 43u);
+    for (size_t tick = 0; tick < replay.length; ++tick)
+    {
+        EXPECT_EQ(replay.inputs[tick], 42);
+    }
+}
+
+TEST_F(ReplayCorpusTest, FilterByMetadata)
+{
+    ReplayCorpus corpus;
+    ASSERT_TRUE(corpus.open(path));
+
+    std::vector<size_t> matches = corpus.filter(
+        [](const ReplayMetadata& metadata)
+        {
+            return metadata.lines == 2 && metadata.score >= 200;
+        });
+
+    std::vector<size_t> expected { 22, 26, 30, 34, 38, 42, 46 };
+    EXPECT_EQ(matches, expected);
+}
+
+TEST_F(ReplayCorpusTest, ForEachParallelVisitsEveryReplayOnce)
+{
+    ReplayCorpus corpus;
+    ASSERT_TRUE(corpus.open(path));
+
+    std::vector<size_t> all(corpus.size());
+    std::iota(all.begin(), all.end(), 0);
+
+    std::vector<std::atomic<int>> visits(corpus.size());
+    std::atomic<size_t> totalTicks { 0 };
+    corpus.forEachParallel(all, 4,
+        [&](size_t index, ReplayView replay)
+        {
+            visits[index]++;
+            totalTicks += replay.length;
+        });
+
+    for (auto& count : visits)
+    {
+        EXPECT_EQ(count, 1);
+    }
+    EXPECT_EQ(totalTicks, nReplays * (nReplays + 1) / 2);
+}
+
+TEST_F(ReplayCorpusTest, RejectsInvalidFile)
+{
+    std::string badPath = tempPath("not_a_corpus.trc");
+    std::FILE* file = std::fopen(badPath.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    std::vector<uint8_t> junk(128, 0xAB);
+    std::fwrite(junk.data(), 1, junk.size(), file);
+    std::fclose(file);
+
+    ReplayCorpus corpus;
+    EXPECT_FALSE(corpus.open(badPath));
+    EXPECT_EQ(corpus.size(), 0u);
+    std::remove(badPath.c_str());
+}
+
+TEST_F(ReplayCorpusTest, MissingFile)
+{
+    ReplayCorpus corpus;
+    EXPECT_FALSE(corpus.open(::testing::TempDir() + "does_not_exist.trc"));
+}
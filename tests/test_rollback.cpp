@@ -0,0 +1,149 @@
+#include "tetris/Input.h"
+#include "tetris/Rollback.h"
+#include "engine/Texture.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+class RollbackTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        textures = makeHeadlessTextures();
+        ASSERT_TRUE(socketA.open(0));
+        ASSERT_TRUE(socketB.open(0));
+        ASSERT_TRUE(socketA.setPeer("127.0.0.1", socketB.getLocalPort()));
+        ASSERT_TRUE(socketB.setPeer("127.0.0.1", socketA.getLocalPort()));
+        socketA.useManualClock();
+        socketB.useManualClock();
+    }
+
+    // Each player changes what they are doing every few ticks, so prediction keeps missing
+    static uint8_t scriptedInput(size_t player, uint32_t tick)
+    {
+        switch ((tick / 6 + player * 2) % 5)
+        {
+        case 0:
+            return INPUT_LEFT;
+        case 1:
+            return (tick % 6 == 0) ? INPUT_ROTATE : INPUT_NONE;
+        case 2:
+            return INPUT_RIGHT;
+        case 3:
+            return INPUT_DOWN | INPUT_LEFT;
+        default:
+            return INPUT_DOWN;
+        }
+    }
+
+    // Runs both peers until each has confirmed every input up to nTicks.
+    // Each pass is half a millisecond on the sockets' clocks, however long
+    // it really took, so a busy machine plays the same game
+    void play(RollbackSession& a, RollbackSession& b, uint32_t nTicks)
+    {
+        constexpr auto PASS_TIME = std::chrono::microseconds(500);
+        constexpr int MAX_PASSES = 60000; // 30 s of network time
+        for (int pass = 0; a.getConfirmedTick() < nTicks || b.getConfirmedTick() < nTicks; ++pass)
+        {
+            ASSERT_LT(pass, MAX_PASSES) << "peers never converged";
+            if (a.getTick() < nTicks)
+            {
+                a.advance(scriptedInput(0, a.getTick()));
+            }
+            else
+            {
+                a.poll();
+            }
+            if (b.getTick() < nTicks)
+            {
+                b.advance(scriptedInput(1, b.getTick()));
+            }
+            else
+            {
+                b.poll();
+            }
+            socketA.advanceClock(PASS_TIME);
+            socketB.advanceClock(PASS_TIME);
+        }
+    }
+
+    // What both boards should look like, simulated without any network
+    std::array<GameState, 2> reference(uint64_t seed, uint32_t nTicks)
+    {
+        TetrisSimulation player0(textures, seed);
+        TetrisSimulation player1(textures, seed);
+        for (uint32_t tick = 0; tick < nTicks; ++tick)
+        {
+            player0.step(scriptedInput(0, tick));
+            player1.step(scriptedInput(1, tick));
+        }
+        return { player0.snapshot(), player1.snapshot() };
+    }
+
+    void expectMatchesReference(RollbackSession& session, const std::array<GameState, 2>& expected)
+    {
+        for (size_t player = 0; player < 2; ++player)
+        {
+            GameState actual = session.getSimulation(player).snapshot();
+            EXPECT_EQ(actual.score, expected[player].score);
+            EXPECT_EQ(std::memcmp(&actual, &expected[player], sizeof(GameState)), 0) << "player " << player;
+        }
+    }
+
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>> textures;
+    UdpSocket socketA;
+    UdpSocket socketB;
+};
+
+TEST_F(RollbackTest, PerfectNetworkMatchesLocalSimulation)
+{
+    constexpr uint32_t nTicks = 600;
+    RollbackSession a(textures, 99, 0, socketA);
+    RollbackSession b(textures, 99, 1, socketB);
+
+    play(a, b, nTicks);
+
+    auto expected = reference(99, nTicks);
+    expectMatchesReference(a, expected);
+    expectMatchesReference(b, expected);
+}
+
+TEST_F(RollbackTest, LatencyAndLossConvergeThroughRollback)
+{
+    constexpr uint32_t nTicks = 600;
+    socketA.setImpairment(20, 10, 0.2, 1);
+    socketB.setImpairment(30, 10, 0.2, 2);
+    RollbackSession a(textures, 1234, 0, socketA);
+    RollbackSession b(textures, 1234, 1, socketB);
+
+    play(a, b, nTicks);
+
+    auto expected = reference(1234, nTicks);
+    expectMatchesReference(a, expected);
+    expectMatchesReference(b, expected);
+
+    // Late inputs really did force rollbacks of several ticks
+    RollbackStats stats = a.getStats();
+    EXPECT_GT(stats.mispredictions, 0u);
+    EXPECT_GT(stats.rollbacks, 0u);
+    EXPECT_GE(stats.maxResimulatedTicks, 10u);
+    EXPECT_LT(stats.maxResimulatedTicks, ROLLBACK_WINDOW);
+}
+
+TEST_F(RollbackTest, StallsWhenPeerIsSilent)
+{
+    RollbackSession a(textures, 5, 0, socketA);
+
+    // Nobody is answering, so we can only predict so far
+    uint32_t simulated = 0;
+    for (uint32_t attempt = 0; attempt < 2 * ROLLBACK_WINDOW; ++attempt)
+    {
+        simulated += a.advance(INPUT_NONE) ? 1u : 0u;
+    }
+    EXPECT_EQ(simulated, ROLLBACK_WINDOW - 1);
+    EXPECT_EQ(a.getConfirmedTick(), 0u);
+    EXPECT_GT(a.getStats().stalls, 0u);
+}
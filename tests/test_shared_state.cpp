@@ -0,0 +1,139 @@
+#include "tetris/SharedStatePublisher.h"
+#include "tetris/Simulation.h"
+#include "engine/Texture.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+class SharedStateTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        name = "/tetris_test_" + std::to_string(getpid());
+        ASSERT_TRUE(publisher.open(name));
+    }
+
+    void TearDown() override
+    {
+        if (reader != nullptr)
+        {
+            munmap(const_cast<TetrisSharedState*>(reader), sizeof(TetrisSharedState));
+        }
+    }
+
+    // Map the segment the way an external tool would
+    void openReader()
+    {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        ASSERT_GE(fd, 0);
+        void* memory = mmap(nullptr, sizeof(TetrisSharedState), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        ASSERT_NE(memory, MAP_FAILED);
+        reader = static_cast<const TetrisSharedState*>(memory);
+    }
+
+    std::string name;
+    SharedStatePublisher publisher;
+    const TetrisSharedState* reader { nullptr };
+};
+
+TEST_F(SharedStateTest, ReadsThePublishedGame)
+{
+    auto textures = makeHeadlessTextures();
+    TetrisSimulation simulation(textures, 12);
+    for (int tick = 0; tick < 2000 && simulation.isPlaying(); ++tick)
+    {
+        simulation.step(INPUT_DOWN);
+    }
+    GameState state = simulation.snapshot();
+    publisher.publish(state, 42);
+
+    openReader();
+    EXPECT_EQ(reader->magic, TETRIS_SHARED_STATE_MAGIC);
+    EXPECT_EQ(reader->version, TETRIS_SHARED_STATE_VERSION);
+    EXPECT_EQ(reader->snapshotSize, sizeof(TetrisSharedSnapshot));
+
+    TetrisSharedSnapshot snapshot;
+    ASSERT_TRUE(tetris_shared_state_read(reader, &snapshot, 1));
+    EXPECT_EQ(snapshot.tick, simulation.getTick());
+    EXPECT_EQ(snapshot.score, simulation.getScore());
+    EXPECT_EQ(snapshot.rows, N_ROWS);
+    EXPECT_EQ(snapshot.cols, N_COLS);
+    EXPECT_EQ(snapshot.stepTimeUs, 42u);
+    EXPECT_EQ(snapshot.pieceX, simulation.getCurrentTetronimo().getPosX());
+    EXPECT_EQ(snapshot.pieceY, simulation.getCurrentTetronimo().getPosY());
+    Grid& board = simulation.getGameBoard();
+    for (size_t row = 0; row < N_ROWS; ++row)
+    {
+        EXPECT_EQ(snapshot.boardRows[row], board.getRowMask(row)) << "row " << row;
+        EXPECT_EQ(std::memcmp(snapshot.boardCells[row], state.board.cells[row], N_COLS), 0) << "row " << row;
+    }
+}
+
+TEST_F(SharedStateTest, ReadersNeverSeeTornSnapshots)
+{
+    openReader();
+    std::atomic<bool> done { false };
+    std::atomic<bool> torn { false };
+    std::atomic<size_t> reads { 0 };
+    std::thread writer(
+        [this, &done, &torn, &reads]()
+        {
+            // Every cell of a snapshot holds the same value, derived from the
+            // tick. On one core the reader may not get a turn for a while, so
+            // keep writing until it has read a few, for up to a few seconds
+            GameState state {};
+            state.board.rows = N_ROWS;
+            state.board.cols = N_COLS;
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+            for (uint32_t tick = 1; !torn && (tick <= 20000 || (reads < 100 && std::chrono::steady_clock::now() < deadline)); ++tick)
+            {
+                state.tick = tick;
+                std::memset(state.board.cells, static_cast<int>(tick % 250 + 1), sizeof(state.board.cells));
+                publisher.publish(state, 0);
+            }
+            done = true;
+        });
+
+    // Only EXPECT while the writer is running, so a failure still joins it
+    while (!done && !torn)
+    {
+        TetrisSharedSnapshot snapshot;
+        if (!tetris_shared_state_read(reader, &snapshot, 10) || snapshot.tick == 0)
+        {
+            continue;
+        }
+        reads++;
+        auto expected = static_cast<uint8_t>(snapshot.tick % 250 + 1);
+        for (size_t row = 0; row < MAX_STATE_ROWS && !torn; ++row)
+        {
+            for (size_t col = 0; col < MAX_STATE_COLS && !torn; ++col)
+            {
+                EXPECT_EQ(snapshot.boardCells[row][col], expected) << "torn read at tick " << snapshot.tick;
+                torn = snapshot.boardCells[row][col] != expected;
+            }
+        }
+    }
+    writer.join();
+    EXPECT_FALSE(torn);
+    EXPECT_GT(reads, 0u);
+}
+
+TEST_F(SharedStateTest, CloseRemovesTheSegment)
+{
+    publisher.close();
+    EXPECT_FALSE(publisher.isOpen());
+    EXPECT_LT(shm_open(name.c_str(), O_RDONLY, 0), 0);
+}
+#endif
@@ -0,0 +1,152 @@
+#include "tetris/Input.h"
+#include "tetris/Simulation.h"
+#include "engine/Texture.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+class SimulationTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        textures = makeHeadlessTextures();
+    }
+
+    // Some busy but deterministic play
+    static uint8_t scriptedInput(uint32_t tick)
+    {
+        switch ((tick / 5) % 5)
+        {
+        case 0:
+            return INPUT_LEFT;
+        case 1:
+            return (tick % 5 == 0) ? INPUT_ROTATE : INPUT_NONE;
+        case 2:
+            return INPUT_RIGHT | INPUT_DOWN;
+        case 3:
+            return INPUT_DOWN;
+        default:
+            return INPUT_NONE;
+        }
+    }
+
+    static bool sameState(const GameState& a, const GameState& b)
+    {
+        return std::memcmp(&a, &b, sizeof(GameState)) == 0;
+    }
+
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>> textures;
+};
+
+TEST_F(SimulationTest, InitialState)
+{
+    TetrisSimulation simulation(textures, 1);
+    EXPECT_TRUE(simulation.isPlaying());
+    EXPECT_EQ(simulation.getTick(), 0u);
+    EXPECT_EQ(simulation.getScore(), 0u);
+    EXPECT_EQ(simulation.getCurrentTetronimo().getPosX(), TETRONIMO_START_X);
+}
+
+TEST_F(SimulationTest, StepAppliesInput)
+{
+    TetrisSimulation simulation(textures, 1);
+    int startY = simulation.getCurrentTetronimo().getPosY();
+
+    simulation.step(INPUT_DOWN);
+
+    EXPECT_EQ(simulation.getTick(), 1u);
+    EXPECT_EQ(simulation.getCurrentTetronimo().getPosY(), startY + VERTICAL_FAST_VELOCITY);
+}
+
+TEST_F(SimulationTest, SameSeedAndInputsAreDeterministic)
+{
+    TetrisSimulation first(textures, 42);
+    TetrisSimulation second(textures, 42);
+    for (uint32_t tick = 0; tick < 3000; ++tick)
+    {
+        first.step(scriptedInput(tick));
+        second.step(scriptedInput(tick));
+    }
+    EXPECT_GT(first.getScore(), 0u);
+    EXPECT_TRUE(sameState(first.snapshot(), second.snapshot()));
+}
+
+TEST_F(SimulationTest, RestoreAndReplayMatches)
+{
+    TetrisSimulation simulation(textures, 7);
+    for (uint32_t tick = 0; tick < 500; ++tick)
+    {
+        simulation.step(scriptedInput(tick));
+    }
+    GameState saved = simulation.snapshot();
+
+    for (uint32_t tick = 500; tick < 1000; ++tick)
+    {
+        simulation.step(scriptedInput(tick));
+    }
+    GameState expected = simulation.snapshot();
+
+    // Rewind and run the same ticks again
+    simulation.restore(saved);
+    EXPECT_TRUE(sameState(simulation.snapshot(), saved));
+    for (uint32_t tick = 500; tick < 1000; ++tick)
+    {
+        simulation.step(scriptedInput(tick));
+    }
+    EXPECT_TRUE(sameState(simulation.snapshot(), expected));
+}
+
+TEST_F(SimulationTest, RollbackOfTenTicksFitsInAFrame)
+{
+    TetrisSimulation simulation(textures, 3);
+    for (uint32_t tick = 0; tick < 200; ++tick)
+    {
+        simulation.step(scriptedInput(tick));
+    }
+
+    // Restore and resimulate 10 ticks, snapshotting every tick like a RollbackSession does
+    constexpr int repeats = 100;
+    GameState saved = simulation.snapshot();
+    auto start = std::chrono::steady_clock::now();
+    for (int repeat = 0; repeat < repeats; ++repeat)
+    {
+        simulation.restore(saved);
+        for (uint32_t tick = 200; tick < 210; ++tick)
+        {
+            GameState state = simulation.snapshot();
+            EXPECT_EQ(state.tick, tick);
+            simulation.step(scriptedInput(tick));
+        }
+    }
+    auto perRollback = (std::chrono::steady_clock::now() - start) / repeats;
+    RecordProperty("ten_tick_rollback_us", static_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(perRollback).count()));
+    EXPECT_LT(perRollback, std::chrono::milliseconds(TICK_MS));
+}
+
+TEST_F(SimulationTest, HugeBoardPlaysHeadless)
+{
+    BoardSize board { 4000, MAX_BOARD_COLS };
+    TetrisSimulation simulation(textures, 4, AutoShiftSettings {}, board);
+    EXPECT_EQ(simulation.getGameBoard().getHeight(), board.rows);
+    EXPECT_EQ(simulation.getGameBoard().getWidth(), board.cols);
+    EXPECT_EQ(simulation.getCurrentTetronimo().getPosX(), tetronimoStartX(board.cols));
+
+    // Pieces fall through thousands of rows and land at the bottom
+    uint32_t fallTicks = static_cast<uint32_t>(board.rows) * BLOCK_SIZE / VERTICAL_FAST_VELOCITY;
+    for (uint32_t tick = 0; tick < 2 * fallTicks && simulation.getScore() == 0; ++tick)
+    {
+        simulation.step(INPUT_DOWN);
+    }
+    EXPECT_GT(simulation.getScore(), 0u);
+    EXPECT_TRUE(simulation.isPlaying());
+    EXPECT_NE(simulation.getGameBoard().getRowMask(board.rows - 1), 0u);
+
+    // Too big for a GameState, so a snapshot comes back without the board
+    // instead of overrunning it
+    GameState state = simulation.snapshot();
+    EXPECT_EQ(state.board.rows, 0u);
+    EXPECT_EQ(state.board.cols, 0u);
+}
@@ -0,0 +1,158 @@
+#include "tetris/Bot.h"
+#include "tetris/SpectatorStream.h"
+#include "engine/Texture.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <unordered_map>
+
+class SpectatorStreamTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        textures = makeHeadlessTextures();
+    }
+
+    // Every block and every position must match, flashing rows included
+    static void expectSameGrid(Grid& expected, Grid& actual, uint32_t tick)
+    {
+        ASSERT_EQ(expected.getHeight(), actual.getHeight()) << "tick " << tick;
+        ASSERT_EQ(expected.getWidth(), actual.getWidth()) << "tick " << tick;
+        ASSERT_EQ(expected.getPosX(), actual.getPosX()) << "tick " << tick;
+        ASSERT_EQ(expected.getPosY(), actual.getPosY()) << "tick " << tick;
+        expected.forEachBlock(
+            [&actual, tick](Block& block, size_t xIndex, size_t yIndex)
+            {
+                Block& other = actual.getBlock(xIndex, yIndex);
+                ASSERT_EQ(block.getTexture(), other.getTexture()) << "tick " << tick << " at " << xIndex << "," << yIndex;
+                if (block.exists())
+                {
+                    ASSERT_EQ(block.getPosX(), other.getPosX()) << "tick " << tick;
+                    ASSERT_EQ(block.getPosY(), other.getPosY()) << "tick " << tick;
+                }
+            });
+    }
+
+    static size_t countBlocks(Grid& grid)
+    {
+        size_t count = 0;
+        grid.forEachBlock(
+            [&count](Block& block, size_t, size_t)
+            {
+                count += block.exists() ? 1u : 0u;
+            });
+        return count;
+    }
+
+    std::unordered_map<std::string_view, std::unique_ptr<Texture>> textures;
+};
+
+TEST_F(SpectatorStreamTest, DecoderFollowsTheGame)
+{
+    // Narrow boards, so the bots clear rows now and then
+    size_t clears = 0;
+    size_t bytes = 0;
+    uint32_t ticks = 0;
+    for (uint64_t seed = 1; seed <= 20; ++seed)
+    {
+        TetrisSimulation simulation(textures, seed, AutoShiftSettings {}, BoardSize { N_ROWS, MIN_BOARD_COLS });
+        SpectatorStreamEncoder encoder(simulation, textures, 200);
+        SpectatorStreamDecoder decoder(textures);
+        Bot bot { seed };
+
+        std::vector<uint8_t> stream;
+        size_t decoded = 0;
+        size_t lastBlocks = 0;
+        while (simulation.isPlaying())
+        {
+            simulation.step(bot.nextInput(simulation));
+            encoder.encodeTick(stream);
+            decoded += decoder.decodeAll(stream.data() + decoded, stream.size() - decoded);
+            ASSERT_EQ(decoded, stream.size());
+
+            ASSERT_TRUE(decoder.isSynced());
+            ASSERT_EQ(decoder.getTick(), simulation.getTick());
+            ASSERT_EQ(decoder.getScore(), simulation.getScore());
+            ASSERT_EQ(decoder.isPlaying(), simulation.isPlaying());
+            expectSameGrid(simulation.getGameBoard(), decoder.getBoard(), simulation.getTick());
+            expectSameGrid(simulation.getCurrentTetronimo(), decoder.getPiece(), simulation.getTick());
+
+            size_t blocks = countBlocks(simulation.getGameBoard());
+            clears += (blocks < lastBlocks) ? 1u : 0u;
+            lastBlocks = blocks;
+        }
+        bytes += stream.size();
+        ticks += simulation.getTick();
+    }
+    EXPECT_GT(clears, 0u) << "the games never cleared a row";
+
+    // A few bytes per tick, keyframes included
+    EXPECT_LT(static_cast<double>(bytes) / ticks, 3.0);
+}
+
+TEST_F(SpectatorStreamTest, JoinMidGame)
+{
+    TetrisSimulation simulation(textures, 5);
+    SpectatorStreamEncoder encoder(simulation, textures, 100);
+    Bot bot { 5 };
+    std::vector<uint8_t> stream;
+    for (int tick = 0; tick < 1250; ++tick)
+    {
+        simulation.step(bot.nextInput(simulation));
+        encoder.encodeTick(stream);
+    }
+
+    // Only the latest keyframe and the records since, not the whole game
+    const std::vector<uint8_t>& catchUp = encoder.getCatchUp();
+    EXPECT_LT(catchUp.size(), stream.size() / 5);
+    SpectatorStreamDecoder decoder(textures);
+    EXPECT_EQ(decoder.decodeAll(catchUp.data(), catchUp.size()), catchUp.size());
+    ASSERT_TRUE(decoder.isSynced());
+    EXPECT_EQ(decoder.getTick(), simulation.getTick());
+    expectSameGrid(simulation.getGameBoard(), decoder.getBoard(), simulation.getTick());
+    expectSameGrid(simulation.getCurrentTetronimo(), decoder.getPiece(), simulation.getTick());
+}
+
+TEST_F(SpectatorStreamTest, DeltasBeforeTheFirstKeyframeAreSkipped)
+{
+    TetrisSimulation simulation(textures, 8);
+    SpectatorStreamEncoder encoder(simulation, textures, 50);
+    Bot bot { 8 };
+    std::vector<uint8_t> stream;
+    size_t joinAt = 0;
+    for (int tick = 0; tick < 80; ++tick)
+    {
+        if (tick == 20)
+        {
+            joinAt = stream.size();
+        }
+        simulation.step(bot.nextInput(simulation));
+        encoder.encodeTick(stream);
+    }
+
+    // Tune in part way through, between two keyframes
+    SpectatorStreamDecoder decoder(textures);
+    size_t used = decoder.decode(stream.data() + joinAt, stream.size() - joinAt);
+    EXPECT_GT(used, 0u);
+    EXPECT_FALSE(decoder.isSynced());
+    used += decoder.decodeAll(stream.data() + joinAt + used, stream.size() - joinAt - used);
+    EXPECT_EQ(used, stream.size() - joinAt);
+    ASSERT_TRUE(decoder.isSynced());
+    EXPECT_EQ(decoder.getTick(), simulation.getTick());
+    expectSameGrid(simulation.getCurrentTetronimo(), decoder.getPiece(), simulation.getTick());
+}
+
+TEST_F(SpectatorStreamTest, PartialRecordChangesNothing)
+{
+    TetrisSimulation simulation(textures, 3);
+    SpectatorStreamEncoder encoder(simulation, textures);
+    std::vector<uint8_t> stream;
+    simulation.step(INPUT_NONE);
+    encoder.encodeTick(stream);
+
+    SpectatorStreamDecoder decoder(textures);
+    EXPECT_EQ(decoder.decode(stream.data(), stream.size() - 1), 0u);
+    EXPECT_FALSE(decoder.isSynced());
+    EXPECT_EQ(decoder.decode(stream.data(), stream.size()), stream.size());
+    EXPECT_TRUE(decoder.isSynced());
+}
@@ -0,0 +1,81 @@
+#include "engine/SpscQueue.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+TEST(SpscQueueTest, StartsEmpty)
+{
+    SpscQueue<int, 4> queue;
+    int value;
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(SpscQueueTest, FirstInFirstOut)
+{
+    SpscQueue<int, 4> queue;
+    EXPECT_TRUE(queue.push(1));
+    EXPECT_TRUE(queue.push(2));
+    EXPECT_TRUE(queue.push(3));
+
+    int value;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_EQ(value, 3);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, PushFailsWhenFull)
+{
+    SpscQueue<int, 4> queue;
+    for (int value = 0; value < 4; ++value)
+    {
+        EXPECT_TRUE(queue.push(value));
+    }
+    EXPECT_FALSE(queue.push(4));
+
+    // Space frees up once the consumer catches up
+    int value;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_TRUE(queue.push(4));
+}
+
+TEST(SpscQueueTest, ConcurrentProducerAndConsumer)
+{
+    constexpr uint32_t nValues = 100000;
+    SpscQueue<uint32_t, 64> queue;
+
+    std::thread producer(
+        [&queue]()
+        {
+            for (uint32_t value = 0; value < nValues; ++value)
+            {
+                while (!queue.push(value))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+    bool inOrder = true;
+    uint32_t expected = 0;
+    while (expected < nValues)
+    {
+        uint32_t value;
+        if (queue.pop(value))
+        {
+            inOrder = inOrder && (value == expected);
+            expected++;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,40 @@
+#include "engine/ThreadPool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+TEST(ThreadPoolTest, DefaultsToAtLeastOneThread)
+{
+    ThreadPool pool;
+    EXPECT_GE(pool.size(), 1u);
+}
+
+TEST(ThreadPoolTest, SubmitReturnsResult)
+{
+    ThreadPool pool(2);
+    auto result = pool.submit([]()
+        {
+            return 6 * 7;
+        });
+    EXPECT_EQ(result.get(), 42);
+}
+
+TEST(ThreadPoolTest, RunsEveryTask)
+{
+    std::atomic<int> count { 0 };
+    std::vector<std::future<void>> results;
+    {
+        ThreadPool pool(4);
+        for (int index = 0; index < 100; ++index)
+        {
+            results.push_back(pool.submit([&count]()
+                {
+                    count++;
+                }));
+        }
+        results.front().wait();
+    }
+
+    // The destructor finishes queued tasks before joining
+    EXPECT_EQ(count.load(), 100);
+}
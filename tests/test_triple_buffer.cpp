@@ -0,0 +1,99 @@
+#include "engine/TripleBuffer.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <thread>
+
+TEST(TripleBufferTest, NothingPublishedYet)
+{
+    TripleBuffer<int> buffer;
+    EXPECT_FALSE(buffer.update());
+    EXPECT_EQ(buffer.getReadBuffer(), 0);
+}
+
+TEST(TripleBufferTest, ReaderSeesPublishedValue)
+{
+    TripleBuffer<int> buffer;
+    buffer.getWriteBuffer() = 42;
+    buffer.publish();
+
+    EXPECT_TRUE(buffer.update());
+    EXPECT_EQ(buffer.getReadBuffer(), 42);
+
+    // Nothing new since then
+    EXPECT_FALSE(buffer.update());
+    EXPECT_EQ(buffer.getReadBuffer(), 42);
+}
+
+TEST(TripleBufferTest, ReaderGetsNewestValue)
+{
+    TripleBuffer<int> buffer;
+    for (int value = 1; value <= 5; ++value)
+    {
+        buffer.getWriteBuffer() = value;
+        buffer.publish();
+    }
+
+    EXPECT_TRUE(buffer.update());
+    EXPECT_EQ(buffer.getReadBuffer(), 5);
+}
+
+TEST(TripleBufferTest, UnpublishedWritesAreInvisible)
+{
+    TripleBuffer<int> buffer;
+    buffer.getWriteBuffer() = 1;
+    buffer.publish();
+    buffer.getWriteBuffer() = 2;
+
+    EXPECT_TRUE(buffer.update());
+    EXPECT_EQ(buffer.getReadBuffer(), 1);
+}
+
+TEST(TripleBufferTest, ConcurrentReaderNeverSeesTornOrOldValues)
+{
+    // Every element of a published value is the same sequence number
+    using Value = std::array<uint64_t, 32>;
+    constexpr uint64_t nValues = 200000;
+    TripleBuffer<Value> buffer;
+    std::atomic<bool> done { false };
+
+    std::thread writer(
+        [&]()
+        {
+            for (uint64_t sequence = 1; sequence <= nValues; ++sequence)
+            {
+                buffer.getWriteBuffer().fill(sequence);
+                buffer.publish();
+            }
+            done = true;
+        });
+
+    uint64_t lastSeen = 0;
+    bool consistent = true;
+    while (true)
+    {
+        bool writerFinished = done;
+        if (buffer.update())
+        {
+            const Value& value = buffer.getReadBuffer();
+            for (uint64_t element : value)
+            {
+                consistent = consistent && (element == value[0]);
+            }
+            consistent = consistent && (value[0] > lastSeen);
+            lastSeen = value[0];
+        }
+        else if (writerFinished)
+        {
+            break;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    writer.join();
+
+    EXPECT_TRUE(consistent);
+    EXPECT_EQ(buffer.getReadBuffer()[0], nValues);
+}